@@ -0,0 +1,279 @@
+/***************************************************************************//**
+ * @file
+ * @brief Answer Timestamps and Time Beacons
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <openthread/coap.h>
+#include <openthread/thread.h>
+#include <openthread/platform/time.h>
+
+#include "openthread-system.h"
+#include "sl_sleeptimer.h"
+
+#define LOG_MODULE  COAP
+#include "logging.h"
+
+#include "answer_time.h"
+#include "tally.h"
+
+static void timer_handler(sl_sleeptimer_timer_handle_t *handle, void *data);
+static void send_beacon(void);
+static bool remote_stamp(const otMessage *aMessage, bool *valid, uint64_t *stamp, uint64_t delivered_us);
+
+static  otInstance                    *sInstance;
+static  volatile bool                 beacon_due;
+static  sl_sleeptimer_timer_handle_t  beacon_timer;
+static  uint64_t                      question_start;
+static  uint8_t                       beacon_sequence;                    // of the next beacon
+static  uint64_t                      beacon_sent[ANSWER_TIME_BEACONS];   // by sequence number
+static  answer_time_stats_t           stats;
+
+void answer_time_init(otInstance *aInstance)
+{
+  sInstance       = aInstance;
+  question_start  = answer_time_now();
+  beacon_sequence = 0;
+  memset(&stats, 0, sizeof(stats));
+
+#if ANSWER_TIME_BEACON_MS
+  sl_sleeptimer_start_periodic_timer_ms(&beacon_timer, ANSWER_TIME_BEACON_MS, timer_handler, NULL, 0, 0);
+#else
+  (void)beacon_timer;
+  (void)timer_handler;
+#endif
+}
+
+void answer_time_new_question(void)
+{
+  question_start = answer_time_now();
+}
+
+uint64_t answer_time_now(void)
+{
+  return otPlatTimeGet();
+}
+
+uint32_t answer_time_stamp(const otMessage *aMessage, uint64_t delivered_us)
+{
+  uint64_t  at = delivered_us;
+  bool      valid;
+
+  stats.stamped++;
+
+  if(remote_stamp(aMessage, &valid, &at, delivered_us))
+  {
+      if(valid)
+      {
+          stats.corrected++;
+      }
+      else
+      {
+          stats.rejected++;
+          at = delivered_us;
+      }
+  }
+
+  if(at <= question_start)
+  {
+      return 0;
+  }
+
+  // 71 minutes into a question the answers stop being told apart
+  return (at - question_start < TALLY_NO_TIME) ? (uint32_t)(at - question_start) : TALLY_NO_TIME - 1u;
+}
+
+void answer_time_process(void)
+{
+  if(!beacon_due)
+  {
+      return;
+  }
+  beacon_due = false;
+
+  // only the leader runs the coap server
+  if(otThreadGetDeviceRole(sInstance) == OT_DEVICE_ROLE_LEADER)
+  {
+      send_beacon();
+  }
+}
+
+const answer_time_stats_t *answer_time_get_stats(void)
+{
+  return &stats;
+}
+
+static void timer_handler(sl_sleeptimer_timer_handle_t *handle, void *data)
+{
+  (void)handle;
+  (void)data;
+
+  beacon_due = true;
+  otSysEventSignalPending();
+}
+
+/*
+ * Non-confirmable POST of the sequence number and the base station clock,
+ * u8 and u64 little-endian, to the realm-local all nodes address. The remotes
+ * only need the sequence number, the clock is there for tools.
+ */
+static void send_beacon(void)
+{
+  otError       error     = OT_ERROR_NONE;
+  otMessage     *message  = NULL;
+  otMessageInfo info;
+  uint8_t       payload[9];
+  uint64_t      sent;
+
+  message = otCoapNewMessage(sInstance, NULL);
+  if(message == NULL)
+  {
+      error = OT_ERROR_NO_BUFS;
+      goto exit;
+  }
+
+  otCoapMessageInit(message, OT_COAP_TYPE_NON_CONFIRMABLE, OT_COAP_CODE_POST);
+
+  error = otCoapMessageAppendUriPathOptions(message, ANSWER_TIME_URI);
+  if(error)
+  {
+      goto exit;
+  }
+
+  error = otCoapMessageSetPayloadMarker(message);
+  if(error)
+  {
+      goto exit;
+  }
+
+  // as close to the send as it gets
+  sent       = answer_time_now();
+  payload[0] = beacon_sequence;
+  for(uint32_t i = 0; i < 8; i++)
+  {
+      payload[1 + i] = (uint8_t)(sent >> (8 * i));
+  }
+
+  error = otMessageAppend(message, payload, sizeof(payload));
+  if(error)
+  {
+      goto exit;
+  }
+
+  memset(&info, 0, sizeof(info));
+  info.mPeerPort = OT_DEFAULT_COAP_PORT;
+  otIp6AddressFromString("ff03::1", &info.mPeerAddr);
+
+  error = otCoapSendRequest(sInstance, message, &info, NULL, NULL);
+  if(error)
+  {
+      goto exit;
+  }
+
+  beacon_sent[beacon_sequence % ANSWER_TIME_BEACONS] = sent;
+  beacon_sequence++;
+  stats.beacons++;
+
+exit:
+  if(error)
+  {
+      LOG_DBG("time beacon: %s\r\n", otThreadErrorToString(error));
+
+      if(message != NULL)
+      {
+          otMessageFree(message);
+      }
+  }
+}
+
+// looks for Uri-Query t=<beacon>.<us>, returns false if there is none
+static bool remote_stamp(const otMessage *aMessage, bool *valid, uint64_t *stamp, uint64_t delivered_us)
+{
+  otCoapOptionIterator  iterator;
+  const otCoapOption    *option;
+  char                  query[24];
+  char                  *end;
+  unsigned long         beacon;
+  unsigned long long    elapsed;
+  uint8_t               age;
+
+  if(otCoapOptionIteratorInit(&iterator, aMessage) != OT_ERROR_NONE)
+  {
+      return false;
+  }
+
+  for(option = otCoapOptionIteratorGetFirstOptionMatching(&iterator, OT_COAP_OPTION_URI_QUERY);
+      option != NULL;
+      option = otCoapOptionIteratorGetNextOptionMatching(&iterator, OT_COAP_OPTION_URI_QUERY))
+  {
+      if(option->mLength >= sizeof(query) || otCoapOptionIteratorGetOptionValue(&iterator, query) != OT_ERROR_NONE)
+      {
+          continue;
+      }
+      query[option->mLength] = '\0';
+
+      if(strncmp(query, "t=", 2) != 0)
+      {
+          continue;
+      }
+
+      *valid  = false;
+      beacon  = strtoul(&query[2], &end, 10);
+      if(*end != '.' || beacon > UINT8_MAX)
+      {
+          return true;
+      }
+      elapsed = strtoull(end + 1, &end, 10);
+      if(*end != '\0')
+      {
+          return true;
+      }
+
+      // beacons sent since, the one stamped against must still be remembered
+      age = (uint8_t)(beacon_sequence - 1u - (uint8_t)beacon);
+      if(age >= ANSWER_TIME_BEACONS || age >= stats.beacons)
+      {
+          return true;
+      }
+
+      *stamp = beacon_sent[beacon % ANSWER_TIME_BEACONS] + elapsed;
+      *valid = *stamp <= delivered_us && delivered_us - *stamp <= (uint64_t)ANSWER_TIME_MAX_LEAD_MS * 1000u;
+
+      return true;
+  }
+
+  return false;
+}
@@ -0,0 +1,88 @@
+/***************************************************************************//**
+ * @file
+ * @brief Answer Timestamps and Time Beacons
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#ifndef ANSWER_TIME_H_
+#define ANSWER_TIME_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <openthread/instance.h>
+#include <openthread/message.h>
+
+#include "base_station_config.h"
+
+/*
+ * Answer times for timed questions, in microseconds since the question
+ * started. The answer handler takes the time when the request is delivered,
+ * before any queueing on the base station. Time spent in the mesh and on
+ * retransmissions is still in it, so a remote may stamp the press itself
+ * against the time beacons sent to all nodes every ANSWER_TIME_BEACON_MS:
+ * Uri-Query t=<beacon>.<us>, the beacon sequence number and the microseconds
+ * from its reception to the press. The base station adds that to the time it
+ * sent the beacon out, so the remote clock only has to keep the rate. The
+ * flight time of the beacon itself is not corrected. A stamp from a beacon no
+ * longer remembered, later than the delivery or more than
+ * ANSWER_TIME_MAX_LEAD_MS before it falls back to the delivery time.
+ */
+
+#define ANSWER_TIME_URI     "time"          // beacon resource on the remotes
+
+typedef struct {
+  uint32_t  beacons;      // sent
+  uint32_t  stamped;      // answers timed
+  uint32_t  corrected;    // of which with a valid remote stamp
+  uint32_t  rejected;     // remote stamps that fell back
+} answer_time_stats_t;
+
+void answer_time_init(otInstance *aInstance);
+
+// the question starts now, call with tally_reset
+void answer_time_new_question(void);
+
+// microsecond clock
+uint64_t answer_time_now(void);
+
+// time of an answer delivered at delivered_us, since the question started,
+// from the remote stamp if the request carries a valid one
+uint32_t answer_time_stamp(const otMessage *aMessage, uint64_t delivered_us);
+
+// sends the beacon when due, called from the main loop
+void answer_time_process(void);
+
+const answer_time_stats_t *answer_time_get_stats(void);
+
+#endif /* ANSWER_TIME_H_ */
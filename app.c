@@ -32,6 +32,10 @@
 
 #include "base_station.h"
 #include "gui.h"
+#include "power_stats.h"
+#include "prof.h"
+#include "dlog.h"
+#include "block_pool.h"
 
 
 #include "sl_component_catalog.h"
@@ -46,30 +50,75 @@
 #include "printf.h"
 
 #if OPENTHREAD_CONFIG_HEAP_EXTERNAL_ENABLE
+/*
+ * The stack and mbedTLS allocate from fixed-size blocks rather than the newlib
+ * heap, which fragments over long uptimes. With BLOCK_POOL_TRACE set every
+ * call is logged for host/pool_bench.c.
+ */
 void *otPlatCAlloc(size_t aNum, size_t aSize)
 {
-    return calloc(aNum, aSize);
+    void *ptr = NULL;
+
+    if(aSize == 0 || aNum <= SIZE_MAX / aSize)
+    {
+        ptr = block_pool_alloc(aNum * aSize, true);
+    }
+
+#if BLOCK_POOL_TRACE
+    DLOG("heap a %p %u\r\n", ptr, aNum * aSize);
+#endif
+
+    return ptr;
 }
 
 void otPlatFree(void *aPtr)
 {
-    free(aPtr);
+#if BLOCK_POOL_TRACE
+    DLOG("heap f %p\r\n", aPtr);
+#endif
+
+    block_pool_free(aPtr);
 }
 #endif
 
 static otInstance *    sInstance       = NULL;
 
+// run the loop at least once after boot
+static volatile bool   sPendingWork    = true;
+
 otInstance *otGetInstance(void)
 {
     return sInstance;
 }
 
 
+/*
+ * Called by the OpenThread platform, the GUI event queue and the display
+ * flush, possibly from interrupt context, whenever there is work for the
+ * main loop.
+ */
 void otSysEventSignalPending(void)
 {
+    power_stats_signal();
+    sPendingWork = true;
+}
 
+#ifdef SL_CATALOG_POWER_MANAGER_PRESENT
+/*
+ * Power Manager hooks, the core sleeps in the deepest energy mode the drivers
+ * allow until an interrupt signals work.
+ */
+bool app_is_ok_to_sleep(void)
+{
+    return !sPendingWork && !otTaskletsArePending(sInstance) && !dlog_pending();
 }
 
+sl_power_manager_on_isr_exit_t app_sleep_on_isr_exit(void)
+{
+    return sPendingWork ? SL_POWER_MANAGER_WAKEUP : SL_POWER_MANAGER_IGNORE;
+}
+#endif
+
 
 /*
  * Provide, if required an "otPlatLog()" function
@@ -79,18 +128,24 @@ void otPlatLog(otLogLevel aLogLevel, otLogRegion aLogRegion, const char *aFormat
 {
     OT_UNUSED_VARIABLE(aLogLevel);
     OT_UNUSED_VARIABLE(aLogRegion);
-    OT_UNUSED_VARIABLE(aFormat);
 
+    // stack logs carry transient strings, format now and write out later
     va_list ap;
     va_start(ap, aFormat);
-//    otCliPlatLogv(aLogLevel, aLogRegion, aFormat, ap);
-    printf(aFormat, ap);
+    dlog_vprintf(aFormat, ap);
     va_end(ap);
 }
 #endif
 
 void sl_ot_create_instance(void)
 {
+    // the stack may log while it comes up
+    dlog_init();
+
+#if OPENTHREAD_CONFIG_HEAP_EXTERNAL_ENABLE
+    block_pool_init();
+#endif
+
     sInstance = otInstanceInitSingle();
     assert(sInstance);
 }
@@ -100,6 +155,8 @@ void sl_ot_create_instance(void)
  *****************************************************************************/
 void app_init(void)
 {
+  prof_init();
+  power_stats_init();
   gui_init();
   base_station_init(otGetInstance());
 }
@@ -109,9 +166,28 @@ void app_init(void)
  *****************************************************************************/
 void app_process_action(void)
 {
+    // clear first, work signalled while processing keeps the loop awake
+    sPendingWork = false;
+    power_stats_serviced();
+
+    PROF_BEGIN(PROF_STAGE_TASKLETS);
     otTaskletsProcess(sInstance);
+    PROF_END(PROF_STAGE_TASKLETS);
+
+    PROF_BEGIN(PROF_STAGE_DRIVERS);
     otSysProcessDrivers(sInstance);
+    PROF_END(PROF_STAGE_DRIVERS);
+
+    PROF_BEGIN(PROF_STAGE_GUI);
     gui_update();
+    PROF_END(PROF_STAGE_GUI);
+
+    base_station_process();
+    power_stats_process();
+    prof_process();
+
+    // idle time, write out the deferred log
+    dlog_process();
 }
 
 /**************************************************************************//**
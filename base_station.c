@@ -34,10 +34,14 @@
  * Silicon Labs may update projects from time to time.
  ******************************************************************************/
 
+#include <string.h>
+
 // OpenThread Includes
 #include <openthread/dataset_ftd.h>
 #include <openthread/thread_ftd.h>
 
+#include "base_station.h"
+
 // Platform Drivers
 #include "sl_button.h"
 #include "sl_simple_button.h"
@@ -46,6 +50,9 @@
 // Utilities
 #include "printf.h"
 
+#define LOG_MODULE  BASE_STATION
+#include "logging.h"
+
 // Config
 #include "base_station_config.h"
 
@@ -55,16 +62,51 @@
 // GUI
 #include "gui.h"
 #include "gui_event_queue.h"
+#include "gui_trace.h"
+
+// Results
+#include "tally.h"
+
+// Network
+#include "channel_select.h"
+#include "roster.h"
+#include "join_stats.h"
+#include "topology.h"
+#include "buffer_pressure.h"
+#include "vote_journal.h"
+#include "results_stream.h"
+#include "answer_time.h"
+#include "remote_registry.h"
+#include "question_publish.h"
+#include "coap_secure.h"
 
+// Diagnostics
+#include "prof.h"
+#include "sl_sleeptimer.h"
 
 
+
+// joiners seen by the commissioner, a remote counts once it ended after finalize
+typedef struct {
+  otExtAddress  id;
+  bool          finalized;
+  bool          counted;
+} joiner_t;
+
 // declaring functions
 static void openthread_event_handler(otChangedFlags event, void *aContext);
+static otError form_network(uint8_t channel);
+static void channel_selected(uint8_t channel, int16_t score);
+static void start_thread(void);
+static joiner_t *find_joiner(const otExtAddress *aJoinerId);
 void joiner_callback(otCommissionerJoinerEvent aEvent, const otJoinerInfo *aJoinerInfo, const otExtAddress *aJoinerId, void *aContext);
 void commissioner_callback(otCommissionerState aState, void *aContext);
 
 static otOperationalDataset sDataset;
 static otInstance*          sInstance = NULL;
+static bool                 sResumed  = false;
+static joiner_t             sJoiners[TALLY_MAX_REMOTES];
+static uint16_t             sJoinerCount;
 
 /**************************************************************************//**
  * Base Station Init
@@ -74,35 +116,214 @@ static otInstance*          sInstance = NULL;
 void base_station_init(otInstance* instance)
 {
   otError error;
+  gui_event_t gui_event = {
+      .flag = 0,
+      .msg  = {0},
+  };
 
   // set openthread instance
   sInstance = instance;
 
-  printf("Hello from the base station app_init\r\n");
+  LOG_INF("Hello from the base station app_init\r\n");
+
+  roster_init(sInstance);
+  topology_init(sInstance);
+  buffer_pressure_init(sInstance);
+  answer_time_init(sInstance);
+  question_publish_init(sInstance);
+  // ids first, the journal replays answers by id
+  remote_registry_init();
+#if VOTE_JOURNAL_ENABLE
+  // answers from before the reset
+  vote_journal_init();
+#endif
+#if RESULTS_STREAM_ENABLE
+  if(results_stream_init() != SL_STATUS_OK)
+  {
+      LOG_ERR("results stream: no dma channel\r\n");
+  }
+#endif
 
   // register callback for Thread Stack Events
   error = otSetStateChangedCallback(sInstance, openthread_event_handler, (void *)sInstance);
-  printf("registering event callback: %s\r\n", otThreadErrorToString(error));
+  if(error)
+  {
+      LOG_ERR("registering event callback: %s\r\n", otThreadErrorToString(error));
+  }
+
+  // hold btn0 through reset to drop the stored network and form a new one
+  if(sl_button_get_state(&sl_button_btn0) == SL_SIMPLE_BUTTON_PRESSED)
+  {
+      base_station_new_network();
+  }
+
+  // enable interface
+  error = otIp6SetEnabled(sInstance, true);
+  if(error)
+  {
+      LOG_ERR("enabling interface: %s\r\n", otThreadErrorToString(error));
+  }
+
+  // the active dataset is kept in nvm by the stack, reattach with the same
+  // credentials so that the remotes don't need to be commissioned again
+  sResumed = otDatasetIsCommissioned(sInstance);
+  if(sResumed)
+  {
+      LOG_INF("resuming network %s\r\n", otThreadGetNetworkName(sInstance));
+
+      gui_event.flag = GUI_EVENT_FLAG_NTWK_NAME;
+      snprintf((char *) &gui_event.msg, GUI_EVENT_MSG_SIZE, "%s", otThreadGetNetworkName(sInstance));
+      gui_event_queue_add(&gui_event);
+
+      start_thread();
+      return;
+  }
+
+  // a new network goes on the quietest channel, Thread starts once the scans
+  // are done
+  error = channel_select_start(sInstance, channel_selected);
+  if(error)
+  {
+      channel_selected(0, 0);
+      return;
+  }
+
+  gui_event.flag = GUI_EVENT_FLAG_LOG;
+  snprintf((char *)gui_event.msg, GUI_EVENT_MSG_SIZE, "[scan] channels");
+  gui_event_queue_add(&gui_event);
+}
+
+/**************************************************************************//**
+ * Channel Selection Callback, forms the network on the chosen channel or on
+ * the one picked by the stack if the scans failed.
+ *****************************************************************************/
+static void channel_selected(uint8_t channel, int16_t score)
+{
+  otError error;
+  gui_event_t gui_event = {
+      .flag = 0,
+      .msg  = {0},
+  };
+
+  error = form_network(channel);
+  if(error)
+  {
+      LOG_ERR("forming network: %s\r\n", otThreadErrorToString(error));
+  }
+
+  if(channel != 0)
+  {
+      gui_event.flag = GUI_EVENT_FLAG_NTWK_CH;
+      snprintf((char *) &gui_event.msg, GUI_EVENT_MSG_SIZE, "%d", channel);
+      gui_event_queue_add(&gui_event);
+
+      gui_event.flag = GUI_EVENT_FLAG_LOG;
+      snprintf((char *)gui_event.msg, GUI_EVENT_MSG_SIZE, "[scan] ch %d %d dBm", channel, score);
+      gui_event_queue_add(&gui_event);
+  }
+
+  start_thread();
+}
+
+static void start_thread(void)
+{
+  otError error;
+
+  // start thread radio stack
+  error = otThreadSetEnabled(sInstance, true);
+  if(error)
+  {
+      LOG_ERR("starting thread: %s\r\n", otThreadErrorToString(error));
+  }
+}
+
+/**************************************************************************//**
+ * Base Station Process, called from the main loop
+ *****************************************************************************/
+void base_station_process(void)
+{
+  roster_process();
+  topology_process();
+  buffer_pressure_process();
+  answer_time_process();
+  question_publish_process();
+#if COAP_SECURE_ENABLE
+  coap_secure_process();
+#endif
+  // new ids reach flash no later than the answers that use them
+  remote_registry_process();
+#if VOTE_JOURNAL_ENABLE
+  vote_journal_process();
+#endif
+#if RESULTS_STREAM_ENABLE
+  results_stream_process();
+#endif
+}
+
+/**************************************************************************//**
+ * Base Station New Network
+ *
+ * Forgets the stored network, remotes have to be commissioned again. Only
+ * valid while the Thread stack is disabled, i.e. before base_station_init
+ * enables it.
+ *****************************************************************************/
+void base_station_new_network(void)
+{
+  otError error;
+
+  error = otInstanceErasePersistentInfo(sInstance);
+  if(error)
+  {
+      LOG_ERR("erasing network: %s\r\n", otThreadErrorToString(error));
+  }
+  else
+  {
+      LOG_INF("stored network erased\r\n");
+  }
+
+  // the remotes come back with new addresses, their ids and the answers
+  // counted by id go with the old network
+  remote_registry_clear();
+  tally_reset();
+#if VOTE_JOURNAL_ENABLE
+  vote_journal_new_question();
+#endif
+}
+
+/**************************************************************************//**
+ * Form a new network with OPENTHREAD_NETWORK_NAME on the given channel, 0
+ * keeps the random one, and commit it as the active dataset, which the stack
+ * persists.
+ *****************************************************************************/
+static otError form_network(uint8_t channel)
+{
+  otError error;
 
   // create a new dataset
   error = otDatasetCreateNewNetwork(sInstance, &sDataset);
-  printf("creating new dataset: %s\r\n", otThreadErrorToString(error));
+  if(error)
+  {
+      goto exit;
+  }
+
+  if(channel != 0)
+  {
+      sDataset.mChannel                       = channel;
+      sDataset.mComponents.mIsChannelPresent  = true;
+  }
 
   // change dataset network name to OPENTHREAD_NETWORK_NAME
   error = otNetworkNameFromString(&(sDataset.mNetworkName), OPENTHREAD_NETWORK_NAME);
-  printf("setting network name to OpenClicker: %s\r\n", otThreadErrorToString(error));
+  if(error)
+  {
+      goto exit;
+  }
 
   // set active dataset
   error = otDatasetSetActive(sInstance, &sDataset);
-  printf("setting active dataset: %s\r\n", otThreadErrorToString(error));
-
-  // enable interface
-  error = otIp6SetEnabled(sInstance, true);
-  printf("enabling interface: %s\r\n", otThreadErrorToString(error));
 
-  // start thread radio stack
-  error = otThreadSetEnabled(sInstance, true);
-  printf("starting thread: %s\r\n", otThreadErrorToString(error));
+exit:
+  return error;
 }
 
 /**************************************************************************//**
@@ -113,15 +334,17 @@ void base_station_init(otInstance* instance)
  *****************************************************************************/
 static void openthread_event_handler(otChangedFlags event, void *aContext)
 {
+  static bool ready_logged = false;
   otError error;
   gui_event_t gui_event = {
-      .flag = 0,
-      .msg  = {0},
+      .flag     = 0,
+      .created  = gui_trace_now(),
+      .msg      = {0},
   };
 
   if(event & OT_CHANGED_ACTIVE_DATASET)
   {
-      printf("Active Dataset Changed\r\n");
+      LOG_DBG("Active Dataset Changed\r\n");
   }
 
   if(event & OT_CHANGED_THREAD_NETDATA)
@@ -132,60 +355,79 @@ static void openthread_event_handler(otChangedFlags event, void *aContext)
       {
           gui_event.flag = GUI_EVENT_FLAG_NTWK_CH;
           snprintf((char *) &gui_event.msg, GUI_EVENT_MSG_SIZE, "%d", otDataset.mChannel);
-          ring_buffer_add(&gui_event_queue, &gui_event);
+          gui_event_queue_add(&gui_event);
 
       }
 
-      printf("Network Dataset Changed\r\n");
+      LOG_DBG("Network Dataset Changed\r\n");
   }
 
   if(event & OT_CHANGED_THREAD_NETWORK_NAME)
   {
-      printf("network name changed: %s\r\n", otThreadGetNetworkName(aContext));
+      LOG_INF("network name changed: %s\r\n", otThreadGetNetworkName(aContext));
 
       gui_event.flag = GUI_EVENT_FLAG_NTWK_NAME;
       snprintf((char *) &gui_event.msg, GUI_EVENT_MSG_SIZE, "%s", otThreadGetNetworkName(aContext));
-      ring_buffer_add(&gui_event_queue, &gui_event);
+      gui_event_queue_add(&gui_event);
 
   }
 
   if(event & OT_CHANGED_THREAD_NETIF_STATE)
   {
-      printf("Network Interface State Changed: %d\r\n", otIp6IsEnabled(aContext));
+      LOG_DBG("Network Interface State Changed: %d\r\n", otIp6IsEnabled(aContext));
   }
 
   if(event & OT_CHANGED_THREAD_ROLE)
   {
-      printf("Thread Device Role Changed: %s\r\n", otThreadDeviceRoleToString(otThreadGetDeviceRole(aContext)));
+      LOG_INF("Thread Device Role Changed: %s\r\n", otThreadDeviceRoleToString(otThreadGetDeviceRole(aContext)));
 
 
       gui_event.flag = GUI_EVENT_FLAG_NTWK_ROLE;
       snprintf((char *) &gui_event.msg, GUI_EVENT_MSG_SIZE, "%s", otThreadDeviceRoleToString(otThreadGetDeviceRole(aContext)));
-      ring_buffer_add(&gui_event_queue, &gui_event);
+      gui_event_queue_add(&gui_event);
 
       if(otThreadGetDeviceRole(aContext) == OT_DEVICE_ROLE_LEADER)
       {
           // start commissioner
           error = otCommissionerStart(aContext, commissioner_callback, joiner_callback, (void*)aContext);
-          printf("commissioner start: %s\r\n", otThreadErrorToString(error));
+          if(error)
+          {
+              LOG_ERR("commissioner start: %s\r\n", otThreadErrorToString(error));
+          }
 
           // start coap server
-          coap_server_init(aContext);
+          error = coap_server_init(aContext);
+          if(!error && !ready_logged)
+          {
+              // boot to answers, for comparing a resume with a cold form
+              ready_logged = true;
+              LOG_INF("coap ready %lu ms after reset (%s)\r\n",
+                      (unsigned long)sl_sleeptimer_tick_to_ms(sl_sleeptimer_get_tick_count()),
+                      sResumed ? "resumed" : "formed");
+          }
 
           gui_event.flag = GUI_EVENT_FLAG_LOG;
           snprintf((char *)gui_event.msg, GUI_EVENT_MSG_SIZE, "[coap] start");
-          ring_buffer_add(&gui_event_queue, &gui_event);
+          gui_event_queue_add(&gui_event);
 
           gui_event.flag = GUI_EVENT_FLAG_LOG;
           snprintf((char *)gui_event.msg, GUI_EVENT_MSG_SIZE, "press 'B' to start");
-          ring_buffer_add(&gui_event_queue, &gui_event);
+          gui_event_queue_add(&gui_event);
 
       }
   }
 
   if(event & OT_CHANGED_JOINER_STATE)
   {
-      printf("Thread Joiner State Changed: %d\r\n", otJoinerGetState(aContext));
+      LOG_DBG("Thread Joiner State Changed: %d\r\n", otJoinerGetState(aContext));
+  }
+
+  // the mesh reshaped, OpenThread has no flag for the router table itself, a
+  // router coming or going without any of these waits for TOPOLOGY_REFRESH_MS
+  if(event & (OT_CHANGED_THREAD_ROLE | OT_CHANGED_THREAD_PARTITION_ID
+              | OT_CHANGED_THREAD_CHILD_ADDED | OT_CHANGED_THREAD_CHILD_REMOVED))
+  {
+      topology_request_update();
   }
 
 }
@@ -196,13 +438,70 @@ static void openthread_event_handler(otChangedFlags event, void *aContext)
 void joiner_callback(otCommissionerJoinerEvent aEvent, const otJoinerInfo *aJoinerInfo, const otExtAddress *aJoinerId, void *aContext)
 {
   (void)aContext;
-  (void)aJoinerInfo;
-  (void)aJoinerId;
 
-  const char* state[5] = {"start", "connected", "finalize", "end", "removed"};
+  joiner_t *joiner;
+
+  LOG_INF("joiner_callback event: %s\r\n", join_stats_event_name(aEvent));
 
-  printf("joiner_callback event: %s\r\n", state[aEvent]);
+  // the session also ends on failed handshakes and restarts, only a joiner
+  // that got through finalize is on the network, and only once
+  joiner = find_joiner(aJoinerId);
+  if(joiner != NULL)
+  {
+      switch(aEvent) {
+        case OT_COMMISSIONER_JOINER_START:
+          joiner->finalized = false;
+          break;
+
+        case OT_COMMISSIONER_JOINER_FINALIZE:
+          joiner->finalized = true;
+          break;
+
+        case OT_COMMISSIONER_JOINER_END:
+          if(joiner->finalized && !joiner->counted)
+          {
+              joiner->counted = true;
+              tally_remote_joined();
+          }
+          break;
+
+        default:
+          break;
+      }
+  }
 
+  join_stats_event(aEvent, aJoinerId);
+  roster_joiner_event(aEvent, aJoinerInfo);
+}
+
+/*
+ * The entry for a joiner id, added if there is room, NULL for wildcard
+ * events and once TALLY_MAX_REMOTES joiners have been seen.
+ */
+static joiner_t *find_joiner(const otExtAddress *aJoinerId)
+{
+  if(aJoinerId == NULL)
+  {
+      return NULL;
+  }
+
+  for(uint32_t i = 0; i < sJoinerCount; i++)
+  {
+      if(memcmp(&sJoiners[i].id, aJoinerId, sizeof(otExtAddress)) == 0)
+      {
+          return &sJoiners[i];
+      }
+  }
+
+  if(sJoinerCount == TALLY_MAX_REMOTES)
+  {
+      return NULL;
+  }
+
+  memset(&sJoiners[sJoinerCount], 0, sizeof(joiner_t));
+  sJoiners[sJoinerCount].id = *aJoinerId;
+
+  return &sJoiners[sJoinerCount++];
 }
 
 /**************************************************************************//**
@@ -211,10 +510,9 @@ void joiner_callback(otCommissionerJoinerEvent aEvent, const otJoinerInfo *aJoin
 void commissioner_callback(otCommissionerState aState, void *aContext)
 {
   (void)aContext;
+  (void)aState;
 
-  const char* state[3] = {"disabled", "petition", "active"};
-
-  printf("commissioner_callback event: %s\r\n", state[aState]);
+  LOG_INF("commissioner_callback event: %s\r\n", join_stats_commissioner_state_name(aState));
 }
 
 /**************************************************************************//**
@@ -222,26 +520,31 @@ void commissioner_callback(otCommissionerState aState, void *aContext)
  *****************************************************************************/
 void sl_button_on_change(const sl_button_t *handle)
 {
-  gui_event_t gui_event = {
-      .flag = 0,
-      .msg  = {0},
-  };
-
   if(handle == &sl_button_btn0)
   {
       if (sl_button_get_state(handle) == SL_SIMPLE_BUTTON_PRESSED)
       {
-          otError error;
+          // commissioning runs from the main loop
+          roster_request_start();
+      }
+  }
 
-          // start joiner
-          error = otCommissionerAddJoiner(sInstance, NULL, COMMISSIONER_JOINER_PSKD, COMMISSIONER_JOINER_TIMEOUT);
-          printf("start_joiner: %s\r\n", otThreadErrorToString(error));
+#if PROF_ENABLE
+  if(handle == &sl_button_btn1)
+  {
+      static uint32_t pressed_at;
 
-          gui_event.flag = GUI_EVENT_FLAG_LOG;
-          snprintf((char *)gui_event.msg, GUI_EVENT_MSG_SIZE, "[joiner] start");
-          ring_buffer_add(&gui_event_queue, &gui_event);
+      // a long press dumps the profile to the console
+      if(sl_button_get_state(handle) == SL_SIMPLE_BUTTON_PRESSED)
+      {
+          pressed_at = sl_sleeptimer_get_tick_count();
+      }
+      else if(sl_sleeptimer_tick_to_ms(sl_sleeptimer_get_tick_count() - pressed_at) >= PROF_DUMP_HOLD_MS)
+      {
+          prof_request_dump();
       }
   }
+#endif
 
   gui_button_handler(handle);
 }
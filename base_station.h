@@ -39,4 +39,10 @@
 
 void base_station_init(otInstance* instance);
 
+// commissioning work, called from the main loop
+void base_station_process(void);
+
+// drop the stored network so that the next base_station_init forms a new one
+void base_station_new_network(void);
+
 #endif /* BASE_STATION_H_ */
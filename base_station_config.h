@@ -43,5 +43,144 @@
 #define COMMISSIONER_JOINER_TIMEOUT   1200u
 #define COMMISSIONER_JOINER_PSKD      "J01NME"
 
+// roster commissioning, see roster.h
+#define JOIN_STATS_MAX_SESSIONS       8u      // joiner sessions timed at once
+
+#define ROSTER_MAX_DEVICES            64u
+#define ROSTER_BATCH_SIZE             2u      // joiners in flight, at most the commissioner joiner table
+#define ROSTER_ADD_INTERVAL_MS        1000u   // between two joiners being added
+#define ROSTER_JOINER_TIMEOUT_S       120u    // per attempt
+#define ROSTER_MAX_ATTEMPTS           2u
+// X(EUI-64, PSKd) per remote, more can be posted to the roster resource
+#define ROSTER_LIST(X)
+// #define ROSTER_LIST(X)             X(0x0011223344556677ull, "J01NME01") X(0x0011223344556678ull, "J01NME02")
+
+#define DLOG_RING_SIZE                64u     // deferred log records, power of two
+#define DLOG_TEXT_SLOTS               4u      // preformatted lines (otPlatLog) in flight
+#define DLOG_TEXT_SIZE                96u
+#define DLOG_DRAIN_MAX                8u      // records written out per main loop pass
+#ifndef DLOG_OUTPUT_BINARY
+#define DLOG_OUTPUT_BINARY            0       // 1: raw records for host/dlog_decode.py
+#endif
+
+// framed binary results on the VCOM UART instead of console text, see
+// results_stream.h, console lines go out as log frames
+#ifndef RESULTS_STREAM_ENABLE
+#define RESULTS_STREAM_ENABLE         0       // 1: for host/results_decode.py, not with DLOG_OUTPUT_BINARY
+#endif
+#define RESULTS_STREAM_RING_SIZE      1024u   // encoded frames waiting for the UART, power of two
+#define RESULTS_STREAM_DELTA_MS       100u    // tally deltas at most this often
+#define RESULTS_STREAM_SNAPSHOT_MS    5000u   // whole tally, and on every new question
+
+// channel selection before forming a network, see channel_select.h
+#define CHANNEL_SELECT_ENERGY_SCAN_MS     64u     // per channel
+#define CHANNEL_SELECT_ACTIVE_SCAN_MS     50u     // per channel, 0 skips the scan for other networks
+#define CHANNEL_SELECT_NETWORK_PENALTY_DB 10      // added per network heard on a channel
+// per channel noise floor in dBm for channels 11 to 26, simulation only
+// #define CHANNEL_SELECT_NOISE           { -60, -95, -95, -95, -60, -95, -95, -95, -95, -70, -95, -95, -95, -95, -95, -95 }
+
+// mesh topology snapshot, see topology.h
+#define TOPOLOGY_MAX_ROUTERS          32u
+#define TOPOLOGY_MAX_CHILDREN         64u
+#define TOPOLOGY_REFRESH_MS           30000u  // besides stack topology changes, 0 disables
+
+// answer path degradation under message buffer pressure, see buffer_pressure.h,
+// thresholds are the used share of the pool
+#define BUFFER_PRESSURE_QUIET_PCT       50u     // no GUI log text
+#define BUFFER_PRESSURE_LEAN_PCT        70u     // empty acknowledgments
+#define BUFFER_PRESSURE_REJECT_PCT      85u     // 5.03 to confirmable answers
+#define BUFFER_PRESSURE_HYSTERESIS_PCT  10u
+#define BUFFER_PRESSURE_MAX_AGE_S       2u      // Max-Age of the 5.03, when remotes may ask again
+
+// compile-time log levels per module, see logging.h, calls above the level
+// are not built in: LOG_LEVEL_NONE, _ERR, _WRN, _INF or _DBG
+#ifndef LOG_LEVEL_DEFAULT
+#define LOG_LEVEL_DEFAULT             LOG_LEVEL_INF
+#endif
+#ifndef LOG_LEVEL_BASE_STATION
+#define LOG_LEVEL_BASE_STATION        LOG_LEVEL_DEFAULT
+#endif
+#ifndef LOG_LEVEL_COAP
+#define LOG_LEVEL_COAP                LOG_LEVEL_DEFAULT
+#endif
+#ifndef LOG_LEVEL_GUI
+#define LOG_LEVEL_GUI                 LOG_LEVEL_DEFAULT
+#endif
+#define LOG_RUNTIME_LEVEL             LOG_LEVEL_DBG   // initial runtime level, diag/log changes it
+
+#ifndef PROF_ENABLE
+#define PROF_ENABLE                   0       // main loop profiler, see prof.h
+#endif
+#define PROF_DUMP_HOLD_MS             1000u   // btn1 held this long dumps the profile
+
+// event to panel latency per event kind, see gui_trace.h
+#define GUI_TRACE_FRAME_EVENTS        32u     // timed per frame, more only count toward queue wait
+
+#define POWER_STATS_REPORT_MS         60000u  // 0 disables the periodic report
+
+// OpenThread external heap, see block_pool.h, X(block size, block count) in
+// ascending block size
+#define BLOCK_POOL_CLASSES(X)         X(32, 64) X(64, 32) X(128, 16) X(256, 12) X(512, 4) X(1280, 4)
+#ifndef BLOCK_POOL_TRACE
+#define BLOCK_POOL_TRACE              0       // 1: log every allocation for host/pool_bench.c
+#endif
+
+// acknowledgment of confirmable answers unless the remote asks otherwise, see
+// coap_server.h: COAP_ACK_EMPTY, COAP_ACK_STATUS or COAP_ACK_FULL
+#define COAP_ANSWER_ACK_POLICY        COAP_ACK_STATUS
+
+// answers sealed under sessions from a DTLS handshake, see coap_secure.h
+#ifndef COAP_SECURE_ENABLE
+#define COAP_SECURE_ENABLE            1
+#endif
+#define COAP_SECURE_REQUIRED          0         // 1: plain answers get 4.01
+#define COAP_SECURE_PSK               "OpenClickerPSK"  // per deployment, like the joiner PSKd
+#define COAP_SECURE_PSK_IDENTITY      "clicker"
+#ifndef COAP_SECURE_SESSIONS
+#define COAP_SECURE_SESSIONS          64u       // cached session keys, the others resume from their tickets
+#endif
+#define COAP_SECURE_HOLD_MS           2000u     // longest one remote keeps the DTLS endpoint
+#define COAP_SECURE_TICKET_LIFETIME_S 36000u    // a school day
+
+// answers journaled in NVM3 across resets, see vote_journal.h
+#ifndef VOTE_JOURNAL_ENABLE
+#define VOTE_JOURNAL_ENABLE           1
+#endif
+#define VOTE_JOURNAL_NVM3_KEY         0x0A000u  // in the application key range, clear of the stack
+// a question keeps at most VOTE_JOURNAL_MAX_BATCHES * VOTE_JOURNAL_BATCH_RECORDS
+// answers across a reset, 32 * 82 = 2624 in full batches and fewer when they
+// are flushed partly filled, 10k answers take 122 full batches
+#ifndef VOTE_JOURNAL_MAX_BATCHES
+#define VOTE_JOURNAL_MAX_BATCHES      32u       // NVM3 objects, shared with the stack settings
+#endif
+#define VOTE_JOURNAL_OBJECT_SIZE      254u      // default NVM3 max object size
+#define VOTE_JOURNAL_RAM_RECORDS      128u      // buffered answers, power of two, a batch or more
+#define VOTE_JOURNAL_FLUSH_MS         2000u     // longest an answer waits for a full batch
+
+#define TALLY_CHOICE_COUNT            4u      // answers 'A' to 'D'
+#define TALLY_TOP_K                   8u      // fastest remotes ranked per answer choice
+#define TALLY_CHANGE_LOG              64u     // versions remembered for results deltas, power of two
+
+// answer timestamps and the time beacon, see answer_time.h
+#define ANSWER_TIME_BEACON_MS         10000u  // to all nodes, 0 disables remote stamps
+#define ANSWER_TIME_BEACONS           4u      // remembered for remote stamps
+#define ANSWER_TIME_MAX_LEAD_MS       30000u  // longest a stamped press may precede its delivery
+// question start sent to the remotes, see question_publish.h
+#define QUESTION_PUBLISH_TEXT_MAX       40u     // keeps the multicast in one frame
+#define QUESTION_PUBLISH_ACK_SPREAD_MS  100u    // remotes spread their acks over this
+#define QUESTION_PUBLISH_ACK_WINDOW_MS  200u    // acks awaited before each repair round
+#define QUESTION_PUBLISH_REPAIR_MS      4u      // mean gap between unicast repairs
+#define QUESTION_PUBLISH_REPAIR_ROUNDS  3u
+#define QUESTION_PUBLISH_SLOT_WINDOW_MS 2000u   // answers spread over this by remote id, 0 leaves remotes free
+#define QUESTION_PUBLISH_SLOT_MIN_MS    5u      // narrowest slot, larger swarms get a longer window
+#ifndef TALLY_MAX_REMOTES
+#define TALLY_MAX_REMOTES             160u    // the simulation builds raise it for large swarms
+#endif
+
+// dense remote ids kept across resets, see remote_registry.h
+#define REMOTE_REGISTRY_NVM3_KEY      0x0A800u  // clear of the journal keys
+#define REMOTE_REGISTRY_HASH_SIZE     512u      // lookup slots, power of two, 1.5 times TALLY_MAX_REMOTES or more
+#define REMOTE_REGISTRY_CHUNK         24u       // ids per NVM3 object
+
 
 #endif /* BASE_STATION_CONFIG_H_ */
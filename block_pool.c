@@ -0,0 +1,203 @@
+/***************************************************************************//**
+ * @file
+ * @brief Fixed-Block Pool Allocator
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#include <string.h>
+
+#include "block_pool.h"
+
+#define ROUND_UP(size)  (((size) + BLOCK_POOL_ALIGN - 1u) & ~(BLOCK_POOL_ALIGN - 1u))
+
+#define ARENA_SIZE_(size, count)    + ROUND_UP(size) * (count)
+#define ARENA_SIZE                  (0 BLOCK_POOL_CLASSES(ARENA_SIZE_))
+#define BLOCK_COUNT_(size, count)   + (count)
+#define BLOCK_COUNT                 (0 BLOCK_POOL_CLASSES(BLOCK_COUNT_))
+
+#define CLASS_INIT_(size, count)    { ROUND_UP(size), (count) },
+
+typedef struct block {
+  struct block  *next;
+} block_t;
+
+typedef struct {
+  uint16_t  size;
+  uint16_t  blocks;
+} class_config_t;
+
+static  const class_config_t  class_config[BLOCK_POOL_CLASS_COUNT] = {
+  BLOCK_POOL_CLASSES(CLASS_INIT_)
+};
+
+// the arena is laid out class after class in ascending size, so the class of
+// a block follows from its address
+static  uint64_t              arena[ARENA_SIZE / sizeof(uint64_t)];
+static  uint8_t              *class_start[BLOCK_POOL_CLASS_COUNT + 1];
+static  block_t              *free_list[BLOCK_POOL_CLASS_COUNT];
+static  uint16_t              class_first[BLOCK_POOL_CLASS_COUNT];
+static  uint16_t              block_request[BLOCK_COUNT];
+static  block_pool_stats_t    stats;
+
+static uint32_t block_index(uint32_t c, const void *ptr)
+{
+  return class_first[c] + ((const uint8_t *)ptr - class_start[c]) / class_config[c].size;
+}
+
+void block_pool_init(void)
+{
+  uint8_t   *cursor = (uint8_t *)arena;
+  uint16_t  first   = 0;
+
+  memset(&stats, 0, sizeof(stats));
+
+  for(uint32_t c = 0; c < BLOCK_POOL_CLASS_COUNT; c++)
+  {
+      block_t **tail = &free_list[c];
+
+      class_start[c] = cursor;
+      class_first[c] = first;
+      first          += class_config[c].blocks;
+      for(uint32_t i = 0; i < class_config[c].blocks; i++)
+      {
+          *tail  = (block_t *)cursor;
+          tail   = &(*tail)->next;
+          cursor += class_config[c].size;
+      }
+      *tail = NULL;
+
+      stats.classes[c].size   = class_config[c].size;
+      stats.classes[c].blocks = class_config[c].blocks;
+  }
+  class_start[BLOCK_POOL_CLASS_COUNT] = cursor;
+}
+
+void *block_pool_alloc(size_t size, bool zero)
+{
+  block_t   *block;
+  uint32_t  c = 0;
+
+  // smallest class that fits
+  while(c < BLOCK_POOL_CLASS_COUNT && class_config[c].size < size)
+  {
+      c++;
+  }
+
+  if(size == 0 || c == BLOCK_POOL_CLASS_COUNT)
+  {
+      stats.failed++;
+      return NULL;
+  }
+
+  // spill upwards when it is exhausted
+  if(free_list[c] == NULL)
+  {
+      do
+      {
+          c++;
+      } while(c < BLOCK_POOL_CLASS_COUNT && free_list[c] == NULL);
+
+      if(c == BLOCK_POOL_CLASS_COUNT)
+      {
+          stats.failed++;
+          return NULL;
+      }
+      stats.classes[c].spills++;
+  }
+
+  block        = free_list[c];
+  free_list[c] = block->next;
+
+  // remember the requested size for the byte counters
+  block_request[block_index(c, block)] = (uint16_t)size;
+
+  stats.allocs++;
+  stats.bytes_in_use += size;
+  if(stats.bytes_in_use > stats.bytes_peak)
+  {
+      stats.bytes_peak = stats.bytes_in_use;
+  }
+  if(++stats.classes[c].in_use > stats.classes[c].peak)
+  {
+      stats.classes[c].peak = stats.classes[c].in_use;
+  }
+
+  if(zero)
+  {
+      memset(block, 0, size);
+  }
+
+  return block;
+}
+
+void block_pool_free(void *ptr)
+{
+  block_t   *block = ptr;
+  uint32_t  c      = 0;
+
+  if(ptr == NULL)
+  {
+      return;
+  }
+
+  while(c < BLOCK_POOL_CLASS_COUNT - 1 && (uint8_t *)ptr >= class_start[c + 1])
+  {
+      c++;
+  }
+
+  stats.frees++;
+  stats.bytes_in_use -= block_request[block_index(c, ptr)];
+  stats.classes[c].in_use--;
+
+  block->next  = free_list[c];
+  free_list[c] = block;
+}
+
+void block_pool_get_stats(block_pool_stats_t *out)
+{
+  *out = stats;
+}
+
+void block_pool_reset_stats(void)
+{
+  stats.allocs      = 0;
+  stats.frees       = 0;
+  stats.failed      = 0;
+  stats.bytes_peak  = stats.bytes_in_use;
+
+  for(uint32_t c = 0; c < BLOCK_POOL_CLASS_COUNT; c++)
+  {
+      stats.classes[c].peak   = stats.classes[c].in_use;
+      stats.classes[c].spills = 0;
+  }
+}
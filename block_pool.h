@@ -0,0 +1,92 @@
+/***************************************************************************//**
+ * @file
+ * @brief Fixed-Block Pool Allocator Header
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#ifndef BLOCK_POOL_H_
+#define BLOCK_POOL_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "base_station_config.h"
+
+/*
+ * Size-classed fixed-block allocator backing the OpenThread external heap.
+ * Each class is a static array of equal blocks with an intrusive free list,
+ * so alloc and free are O(1) and the arena cannot fragment. A request goes to
+ * the smallest class that fits and spills into larger classes when that one
+ * is exhausted. The classes are set by BLOCK_POOL_CLASSES.
+ *
+ * Not reentrant, main loop only.
+ */
+
+#define BLOCK_POOL_ALIGN        8u
+
+#define BLOCK_POOL_COUNT_(size, count)  + 1
+#define BLOCK_POOL_CLASS_COUNT          (0 BLOCK_POOL_CLASSES(BLOCK_POOL_COUNT_))
+
+typedef struct {
+  uint16_t  size;         // block size in bytes
+  uint16_t  blocks;       // blocks in the class
+  uint16_t  in_use;
+  uint16_t  peak;         // highest in_use since the last reset
+  uint32_t  spills;       // allocations that came here because a smaller class was full
+} block_pool_class_stats_t;
+
+typedef struct {
+  uint32_t  allocs;
+  uint32_t  frees;
+  uint32_t  failed;       // no class large enough with a free block
+  uint32_t  bytes_in_use; // requested bytes, not block sizes
+  uint32_t  bytes_peak;
+  block_pool_class_stats_t classes[BLOCK_POOL_CLASS_COUNT];
+} block_pool_stats_t;
+
+// build the free lists, drops every allocation
+void block_pool_init(void);
+
+// a block of at least size bytes, NULL if none left, zeroed only if asked to
+void *block_pool_alloc(size_t size, bool zero);
+
+// return a block, NULL is ignored
+void block_pool_free(void *ptr);
+
+void block_pool_get_stats(block_pool_stats_t *stats);
+
+// clear the counters and peaks, the current usage is kept
+void block_pool_reset_stats(void);
+
+#endif /* BLOCK_POOL_H_ */
@@ -0,0 +1,194 @@
+/***************************************************************************//**
+ * @file
+ * @brief Message Buffer Pressure Monitor
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#include <string.h>
+
+#include <openthread/message.h>
+
+#include "sl_sleeptimer.h"
+
+#define LOG_MODULE  COAP
+#include "logging.h"
+
+#include "buffer_pressure.h"
+#include "gui_event_queue.h"
+#include "coap_diag.h"
+
+#define BUFFER_PRESSURE_EXPORT_VERSION  1u
+
+static void enter_level(buffer_pressure_level_t level, uint32_t now);
+static void account_time(uint32_t now);
+
+static const uint8_t thresholds[BUFFER_PRESSURE_LEVEL_COUNT] = {
+  [BUFFER_PRESSURE_NORMAL]  = 0,
+  [BUFFER_PRESSURE_QUIET]   = BUFFER_PRESSURE_QUIET_PCT,
+  [BUFFER_PRESSURE_LEAN]    = BUFFER_PRESSURE_LEAN_PCT,
+  [BUFFER_PRESSURE_REJECT]  = BUFFER_PRESSURE_REJECT_PCT,
+};
+
+static  otInstance                *sInstance;
+static  buffer_pressure_level_t   level;
+static  uint32_t                  level_since;      // ticks
+static  uint64_t                  level_ticks[BUFFER_PRESSURE_LEVEL_COUNT];
+static  buffer_pressure_stats_t   stats;
+
+void buffer_pressure_init(otInstance *aInstance)
+{
+  sInstance = aInstance;
+  level     = BUFFER_PRESSURE_NORMAL;
+
+  buffer_pressure_reset_stats();
+}
+
+buffer_pressure_level_t buffer_pressure_sample(void)
+{
+  otBufferInfo            info;
+  uint32_t                used_pct;
+  buffer_pressure_level_t target = level;
+
+  otMessageGetBufferInfo(sInstance, &info);
+  if(info.mTotalBuffers == 0)
+  {
+      return level;
+  }
+
+  stats.buffers_total = info.mTotalBuffers;
+  if(info.mFreeBuffers < stats.buffers_free_min)
+  {
+      stats.buffers_free_min = info.mFreeBuffers;
+  }
+
+  used_pct = (uint32_t)(info.mTotalBuffers - info.mFreeBuffers) * 100u / info.mTotalBuffers;
+
+  // up as soon as a threshold is reached, down only with some margin
+  while(target + 1 < BUFFER_PRESSURE_LEVEL_COUNT && used_pct >= thresholds[target + 1])
+  {
+      target++;
+  }
+  while(target > BUFFER_PRESSURE_NORMAL && used_pct + BUFFER_PRESSURE_HYSTERESIS_PCT < thresholds[target])
+  {
+      target--;
+  }
+
+  if(target != level)
+  {
+      enter_level(target, sl_sleeptimer_get_tick_count());
+      LOG_WRN("buffer pressure: level %u, %u of %u buffers free\r\n", level, info.mFreeBuffers, info.mTotalBuffers);
+  }
+
+  return level;
+}
+
+buffer_pressure_level_t buffer_pressure_level(void)
+{
+  return level;
+}
+
+void buffer_pressure_process(void)
+{
+  // the answer path samples too, this catches the pool draining by itself
+  buffer_pressure_sample();
+}
+
+void buffer_pressure_count_rejected(void)
+{
+  stats.rejected++;
+}
+
+void buffer_pressure_get_stats(buffer_pressure_stats_t *out)
+{
+  account_time(sl_sleeptimer_get_tick_count());
+
+  *out = stats;
+  for(uint32_t i = 0; i < BUFFER_PRESSURE_LEVEL_COUNT; i++)
+  {
+      out->time_ms[i] = (uint32_t)(level_ticks[i] * 1000u / sl_sleeptimer_get_timer_frequency());
+  }
+}
+
+void buffer_pressure_reset_stats(void)
+{
+  memset(&stats, 0, sizeof(stats));
+  memset(level_ticks, 0, sizeof(level_ticks));
+
+  stats.buffers_free_min  = UINT16_MAX;
+  stats.entered[level]    = 1;
+  level_since             = sl_sleeptimer_get_tick_count();
+}
+
+size_t buffer_pressure_export(uint8_t *buffer, size_t size)
+{
+  buffer_pressure_stats_t snapshot;
+  uint8_t                 *p = buffer;
+
+  if(size < BUFFER_PRESSURE_EXPORT_SIZE)
+  {
+      return 0;
+  }
+
+  buffer_pressure_get_stats(&snapshot);
+
+  *p++ = BUFFER_PRESSURE_EXPORT_VERSION;
+  *p++ = (uint8_t)level;
+  p    = coap_diag_put_u16(p, snapshot.buffers_total);
+  p    = coap_diag_put_u16(p, (snapshot.buffers_free_min == UINT16_MAX) ? snapshot.buffers_total : snapshot.buffers_free_min);
+  p    = coap_diag_put_u32(p, snapshot.rejected);
+
+  for(uint32_t i = 0; i < BUFFER_PRESSURE_LEVEL_COUNT; i++)
+  {
+      p = coap_diag_put_u32(p, snapshot.entered[i]);
+      p = coap_diag_put_u32(p, snapshot.time_ms[i]);
+  }
+
+  return (size_t)(p - buffer);
+}
+
+static void enter_level(buffer_pressure_level_t next, uint32_t now)
+{
+  account_time(now);
+
+  level = next;
+  stats.entered[level]++;
+
+  // log text is the first thing to go, it only costs draw time
+  gui_event_queue_set_log_muted(level >= BUFFER_PRESSURE_QUIET);
+}
+
+static void account_time(uint32_t now)
+{
+  level_ticks[level] += (uint32_t)(now - level_since);
+  level_since         = now;
+}
@@ -0,0 +1,95 @@
+/***************************************************************************//**
+ * @file
+ * @brief Message Buffer Pressure Monitor Header
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#ifndef BUFFER_PRESSURE_H_
+#define BUFFER_PRESSURE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <openthread/instance.h>
+
+#include "base_station_config.h"
+
+/*
+ * Watches the occupancy of the OpenThread message pool and maps it to a
+ * degradation level for the answer path. Each level keeps the ones below it:
+ * the server stops queueing GUI log text, then acknowledges answers without
+ * a payload, then turns confirmable answers away with 5.03 and a Max-Age so
+ * the remotes back off. A level is entered when the used share of the pool
+ * reaches its threshold and left once it drops BUFFER_PRESSURE_HYSTERESIS_PCT
+ * below it.
+ */
+
+typedef enum {
+  BUFFER_PRESSURE_NORMAL,
+  BUFFER_PRESSURE_QUIET,      // no GUI log text
+  BUFFER_PRESSURE_LEAN,       // empty acknowledgments
+  BUFFER_PRESSURE_REJECT,     // 5.03 with Max-Age
+  BUFFER_PRESSURE_LEVEL_COUNT
+} buffer_pressure_level_t;
+
+typedef struct {
+  uint16_t  buffers_total;
+  uint16_t  buffers_free_min;
+  uint32_t  rejected;                                   // answers turned away
+  uint32_t  entered[BUFFER_PRESSURE_LEVEL_COUNT];
+  uint32_t  time_ms[BUFFER_PRESSURE_LEVEL_COUNT];       // including the current stay
+} buffer_pressure_stats_t;
+
+void buffer_pressure_init(otInstance *aInstance);
+
+// sample the pool and return the level, main loop context
+buffer_pressure_level_t buffer_pressure_sample(void);
+
+// level as of the last sample
+buffer_pressure_level_t buffer_pressure_level(void);
+
+// called from the main loop
+void buffer_pressure_process(void);
+
+// an answer was turned away with 5.03
+void buffer_pressure_count_rejected(void);
+
+void buffer_pressure_get_stats(buffer_pressure_stats_t *stats);
+void buffer_pressure_reset_stats(void);
+
+// little-endian dump for diag/buffers, returns the length or 0 if size is short
+size_t buffer_pressure_export(uint8_t *buffer, size_t size);
+
+#define BUFFER_PRESSURE_EXPORT_SIZE   (10 + 8 * BUFFER_PRESSURE_LEVEL_COUNT)
+
+#endif /* BUFFER_PRESSURE_H_ */
@@ -0,0 +1,180 @@
+/***************************************************************************//**
+ * @file
+ * @brief Channel Selection
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#include <openthread/link.h>
+
+#define LOG_MODULE  BASE_STATION
+#include "logging.h"
+
+#include "channel_select.h"
+
+#define CHANNEL_MASK(channel)   (1ul << (channel))
+#define CHANNEL_MASK_ALL        (((1ul << CHANNEL_SELECT_COUNT) - 1u) << CHANNEL_SELECT_FIRST)
+
+static void energy_scan_handler(otEnergyScanResult *aResult, void *aContext);
+static void active_scan_handler(otActiveScanResult *aResult, void *aContext);
+static void finish(void);
+
+static  channel_select_callback_t   done_callback   = NULL;
+static  uint32_t                    scan_mask;
+static  int8_t                      energy[CHANNEL_SELECT_COUNT];
+static  uint8_t                     networks[CHANNEL_SELECT_COUNT];
+
+#ifdef CHANNEL_SELECT_NOISE
+static  const int8_t                injected_noise[CHANNEL_SELECT_COUNT] = CHANNEL_SELECT_NOISE;
+#endif
+
+otError channel_select_start(otInstance *aInstance, channel_select_callback_t callback)
+{
+  otError error;
+
+  done_callback = callback;
+  scan_mask     = otLinkGetSupportedChannelMask(aInstance) & CHANNEL_MASK_ALL;
+
+  for(uint32_t i = 0; i < CHANNEL_SELECT_COUNT; i++)
+  {
+      energy[i]   = INT8_MIN;
+      networks[i] = 0;
+  }
+
+  error = otLinkEnergyScan(aInstance, scan_mask, CHANNEL_SELECT_ENERGY_SCAN_MS, energy_scan_handler, aInstance);
+  if(error)
+  {
+      LOG_WRN("energy scan: %s\r\n", otThreadErrorToString(error));
+  }
+
+  return error;
+}
+
+int16_t channel_select_score(uint8_t channel)
+{
+  int16_t score;
+
+  if(channel < CHANNEL_SELECT_FIRST || channel > CHANNEL_SELECT_LAST || !(scan_mask & CHANNEL_MASK(channel)))
+  {
+      return INT16_MAX;
+  }
+
+  score = energy[channel - CHANNEL_SELECT_FIRST];
+
+#ifdef CHANNEL_SELECT_NOISE
+  if(injected_noise[channel - CHANNEL_SELECT_FIRST] > score)
+  {
+      score = injected_noise[channel - CHANNEL_SELECT_FIRST];
+  }
+#endif
+
+  return score + networks[channel - CHANNEL_SELECT_FIRST] * CHANNEL_SELECT_NETWORK_PENALTY_DB;
+}
+
+/**************************************************************************//**
+ * Energy scan results, one per channel, NULL when the scan is done.
+ *****************************************************************************/
+static void energy_scan_handler(otEnergyScanResult *aResult, void *aContext)
+{
+  otError error;
+
+  if(aResult != NULL)
+  {
+      if(aResult->mChannel >= CHANNEL_SELECT_FIRST && aResult->mChannel <= CHANNEL_SELECT_LAST
+         && aResult->mMaxRssi > energy[aResult->mChannel - CHANNEL_SELECT_FIRST])
+      {
+          energy[aResult->mChannel - CHANNEL_SELECT_FIRST] = aResult->mMaxRssi;
+      }
+      LOG_DBG("energy ch %u: %d dBm\r\n", aResult->mChannel, aResult->mMaxRssi);
+      return;
+  }
+
+#if CHANNEL_SELECT_ACTIVE_SCAN_MS
+  error = otLinkActiveScan(aContext, scan_mask, CHANNEL_SELECT_ACTIVE_SCAN_MS, active_scan_handler, aContext);
+  if(!error)
+  {
+      return;
+  }
+  LOG_WRN("active scan: %s\r\n", otThreadErrorToString(error));
+#else
+  (void)error;
+  (void)active_scan_handler;
+#endif
+
+  finish();
+}
+
+/**************************************************************************//**
+ * Active scan results, one per beacon heard, NULL when the scan is done.
+ *****************************************************************************/
+static void active_scan_handler(otActiveScanResult *aResult, void *aContext)
+{
+  (void)aContext;
+
+  if(aResult != NULL)
+  {
+      if(aResult->mChannel >= CHANNEL_SELECT_FIRST && aResult->mChannel <= CHANNEL_SELECT_LAST
+         && networks[aResult->mChannel - CHANNEL_SELECT_FIRST] < UINT8_MAX)
+      {
+          networks[aResult->mChannel - CHANNEL_SELECT_FIRST]++;
+      }
+      LOG_DBG("network on ch %u: pan 0x%04x\r\n", aResult->mChannel, aResult->mPanId);
+      return;
+  }
+
+  finish();
+}
+
+static void finish(void)
+{
+  uint8_t best        = 0;
+  int16_t best_score  = INT16_MAX;
+
+  for(uint8_t channel = CHANNEL_SELECT_FIRST; channel <= CHANNEL_SELECT_LAST; channel++)
+  {
+      int16_t score = channel_select_score(channel);
+
+      // a channel the energy scan never reported stays at INT8_MIN, skip it
+      if(score < best_score && energy[channel - CHANNEL_SELECT_FIRST] != INT8_MIN)
+      {
+          best       = channel;
+          best_score = score;
+      }
+  }
+
+  LOG_INF("channel %u selected, score %d\r\n", best, best_score);
+
+  if(done_callback != NULL)
+  {
+      done_callback(best, best_score);
+  }
+}
@@ -0,0 +1,70 @@
+/***************************************************************************//**
+ * @file
+ * @brief Channel Selection Header
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#ifndef CHANNEL_SELECT_H_
+#define CHANNEL_SELECT_H_
+
+#include <stdint.h>
+
+#include <openthread/instance.h>
+
+#include "base_station_config.h"
+
+/*
+ * Picks the quietest channel before a new network is formed. An energy scan
+ * gives the peak rssi per channel, an optional active scan adds a penalty for
+ * every Thread/802.15.4 network already on a channel, and the channel with the
+ * lowest score wins, ties going to the lower channel.
+ *
+ * CHANNEL_SELECT_NOISE injects a noise floor per channel for runs on the
+ * simulation platform, where every channel measures the same.
+ */
+
+#define CHANNEL_SELECT_FIRST      11u
+#define CHANNEL_SELECT_LAST       26u
+#define CHANNEL_SELECT_COUNT      (CHANNEL_SELECT_LAST - CHANNEL_SELECT_FIRST + 1u)
+
+// channel 0 when the scans could not be run, score in dBm plus penalties
+typedef void (*channel_select_callback_t)(uint8_t channel, int16_t score);
+
+// start the scans, the interface has to be up and Thread stopped, the
+// callback runs from the OpenThread tasklet once the channel is chosen
+otError channel_select_start(otInstance *aInstance, channel_select_callback_t callback);
+
+// score of a channel from the last run, INT16_MAX if it was not scanned
+int16_t channel_select_score(uint8_t channel);
+
+#endif /* CHANNEL_SELECT_H_ */
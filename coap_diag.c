@@ -0,0 +1,491 @@
+/***************************************************************************//**
+ * @file
+ * @brief Diagnostics CoAP Resources
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#include <openthread-core-config.h>
+#include <openthread/coap.h>
+#include <openthread/ip6.h>
+
+#define LOG_MODULE  COAP
+#include "logging.h"
+
+#include "coap_diag.h"
+#include "prof.h"
+#include "block_pool.h"
+#include "join_stats.h"
+#include "topology.h"
+#include "buffer_pressure.h"
+#include "coap_secure.h"
+#include "gui_trace.h"
+
+static void log_handler(void *aContext, otMessage *aMessage, const otMessageInfo *aMessageInfo);
+static void join_handler(void *aContext, otMessage *aMessage, const otMessageInfo *aMessageInfo);
+static void topo_handler(void *aContext, otMessage *aMessage, const otMessageInfo *aMessageInfo);
+static void buffers_handler(void *aContext, otMessage *aMessage, const otMessageInfo *aMessageInfo);
+static void gui_handler(void *aContext, otMessage *aMessage, const otMessageInfo *aMessageInfo);
+
+static otCoapResource   log_resource;
+static char*            log_uri_path    = "diag/log";
+static otCoapResource   join_resource;
+static char*            join_uri_path   = "diag/join";
+static otCoapResource   topo_resource;
+static char*            topo_uri_path   = "diag/topo";
+static otCoapResource   buffers_resource;
+static char*            buffers_uri_path = "diag/buffers";
+static otCoapResource   gui_resource;
+static char*            gui_uri_path    = "diag/gui";
+
+#if COAP_SECURE_ENABLE
+static void secure_handler(void *aContext, otMessage *aMessage, const otMessageInfo *aMessageInfo);
+
+static otCoapResource   secure_resource;
+static char*            secure_uri_path = "diag/secure";
+#endif
+
+#if OPENTHREAD_CONFIG_HEAP_EXTERNAL_ENABLE
+static void heap_handler(void *aContext, otMessage *aMessage, const otMessageInfo *aMessageInfo);
+
+static otCoapResource   heap_resource;
+static char*            heap_uri_path   = "diag/heap";
+#endif
+
+#if PROF_ENABLE
+static void prof_handler(void *aContext, otMessage *aMessage, const otMessageInfo *aMessageInfo);
+
+static otCoapResource   prof_resource;
+static char*            prof_uri_path   = "diag/prof";
+#endif
+
+otError coap_diag_init(otInstance *aInstance)
+{
+  log_resource.mUriPath = log_uri_path;
+  log_resource.mHandler = &log_handler;
+  log_resource.mContext = aInstance;
+
+  otCoapAddResource(aInstance, &log_resource);
+
+  join_resource.mUriPath = join_uri_path;
+  join_resource.mHandler = &join_handler;
+  join_resource.mContext = aInstance;
+
+  otCoapAddResource(aInstance, &join_resource);
+
+  topo_resource.mUriPath = topo_uri_path;
+  topo_resource.mHandler = &topo_handler;
+  topo_resource.mContext = aInstance;
+
+  otCoapAddResource(aInstance, &topo_resource);
+
+  buffers_resource.mUriPath = buffers_uri_path;
+  buffers_resource.mHandler = &buffers_handler;
+  buffers_resource.mContext = aInstance;
+
+  otCoapAddResource(aInstance, &buffers_resource);
+
+  gui_resource.mUriPath = gui_uri_path;
+  gui_resource.mHandler = &gui_handler;
+  gui_resource.mContext = aInstance;
+
+  otCoapAddResource(aInstance, &gui_resource);
+
+#if COAP_SECURE_ENABLE
+  secure_resource.mUriPath = secure_uri_path;
+  secure_resource.mHandler = &secure_handler;
+  secure_resource.mContext = aInstance;
+
+  otCoapAddResource(aInstance, &secure_resource);
+#endif
+
+#if OPENTHREAD_CONFIG_HEAP_EXTERNAL_ENABLE
+  heap_resource.mUriPath = heap_uri_path;
+  heap_resource.mHandler = &heap_handler;
+  heap_resource.mContext = aInstance;
+
+  otCoapAddResource(aInstance, &heap_resource);
+#endif
+
+#if PROF_ENABLE
+  prof_resource.mUriPath = prof_uri_path;
+  prof_resource.mHandler = &prof_handler;
+  prof_resource.mContext = aInstance;
+
+  otCoapAddResource(aInstance, &prof_resource);
+#endif
+
+  return OT_ERROR_NONE;
+}
+
+otError coap_diag_respond(otInstance *aInstance, otMessage *aRequest, const otMessageInfo *aMessageInfo,
+                          otCoapCode aCode, const uint8_t *aPayload, uint16_t aLength)
+{
+  otError   error = OT_ERROR_NONE;
+  otMessage *response_message;
+
+  // only confirmable requests get a piggybacked response
+  if(otCoapMessageGetType(aRequest) != OT_COAP_TYPE_CONFIRMABLE)
+  {
+      return OT_ERROR_NONE;
+  }
+
+  response_message = otCoapNewMessage(aInstance, NULL);
+  if(response_message == NULL)
+  {
+      return OT_ERROR_NO_BUFS;
+  }
+
+  error = otCoapMessageInitResponse(response_message, aRequest, OT_COAP_TYPE_ACKNOWLEDGMENT, aCode);
+  if(error)
+  {
+      goto exit;
+  }
+
+  if(aPayload != NULL && aLength > 0)
+  {
+      error = otCoapMessageSetPayloadMarker(response_message);
+      if(error)
+      {
+          goto exit;
+      }
+
+      error = otMessageAppend(response_message, aPayload, aLength);
+      if(error)
+      {
+          goto exit;
+      }
+  }
+
+  error = otCoapSendResponse(aInstance, response_message, aMessageInfo);
+
+exit:
+  if(error != OT_ERROR_NONE)
+  {
+      LOG_WRN("coap diag response: %s\r\n", otThreadErrorToString(error));
+      otMessageFree(response_message);
+  }
+
+  return error;
+}
+
+bool coap_diag_peer_is_local(otInstance *aInstance, const otMessageInfo *aMessageInfo)
+{
+  const otIp6Address *peer = &aMessageInfo->mPeerAddr;
+
+  // fe80::/10
+  if(peer->mFields.m8[0] == 0xfe && (peer->mFields.m8[1] & 0xc0) == 0x80)
+  {
+      return true;
+  }
+
+  return otIp6HasUnicastAddress(aInstance, peer);
+}
+
+/**************************************************************************//**
+ * diag/log
+ *
+ * GET returns the compile-time and runtime level of each module as byte
+ * pairs, in log_module_t order. PUT sets the runtime levels, from a single
+ * byte for all modules or one byte per module. Levels above the compile-time
+ * level have no effect.
+ *****************************************************************************/
+static void log_handler(void *aContext, otMessage *aMessage, const otMessageInfo *aMessageInfo)
+{
+  uint8_t   payload[2 * LOG_MODULE_COUNT];
+  uint16_t  length;
+
+  switch(otCoapMessageGetCode(aMessage)) {
+    case OT_COAP_CODE_GET:
+      for(uint32_t i = 0; i < LOG_MODULE_COUNT; i++)
+      {
+          payload[2 * i]     = log_compile_level[i];
+          payload[2 * i + 1] = log_runtime_level[i];
+      }
+      coap_diag_respond(aContext, aMessage, aMessageInfo, OT_COAP_CODE_CONTENT, payload, sizeof(payload));
+      break;
+
+    case OT_COAP_CODE_PUT:
+      length = otMessageRead(aMessage, otMessageGetOffset(aMessage), payload, sizeof(payload));
+      if(length == 1)
+      {
+          log_set_level(LOG_MODULE_COUNT, payload[0]);
+      }
+      else if(length == LOG_MODULE_COUNT)
+      {
+          for(uint32_t i = 0; i < LOG_MODULE_COUNT; i++)
+          {
+              log_set_level((log_module_t)i, payload[i]);
+          }
+      }
+      else
+      {
+          coap_diag_respond(aContext, aMessage, aMessageInfo, OT_COAP_CODE_BAD_REQUEST, NULL, 0);
+          break;
+      }
+      LOG_INF("log levels set over coap\r\n");
+      coap_diag_respond(aContext, aMessage, aMessageInfo, OT_COAP_CODE_CHANGED, NULL, 0);
+      break;
+
+    default:
+      coap_diag_respond(aContext, aMessage, aMessageInfo, OT_COAP_CODE_METHOD_NOT_ALLOWED, NULL, 0);
+      break;
+  }
+}
+
+/**************************************************************************//**
+ * diag/join
+ *
+ * GET returns the join_stats_export() record: version, bucket count, joined
+ * and restarted, then per phase (handshake, commission, finalize, total) the
+ * failures, the max time in ms and the histogram. DELETE clears it.
+ *****************************************************************************/
+static void join_handler(void *aContext, otMessage *aMessage, const otMessageInfo *aMessageInfo)
+{
+  static uint8_t  payload[JOIN_STATS_EXPORT_SIZE];
+  size_t          length;
+
+  switch(otCoapMessageGetCode(aMessage)) {
+    case OT_COAP_CODE_GET:
+      length = join_stats_export(payload, sizeof(payload));
+      coap_diag_respond(aContext, aMessage, aMessageInfo, OT_COAP_CODE_CONTENT, payload, (uint16_t)length);
+      break;
+
+    case OT_COAP_CODE_DELETE:
+      join_stats_reset();
+      coap_diag_respond(aContext, aMessage, aMessageInfo, OT_COAP_CODE_DELETED, NULL, 0);
+      break;
+
+    default:
+      coap_diag_respond(aContext, aMessage, aMessageInfo, OT_COAP_CODE_METHOD_NOT_ALLOWED, NULL, 0);
+      break;
+  }
+}
+
+/**************************************************************************//**
+ * diag/topo
+ *
+ * GET returns the topology_export() record: version, router count, child
+ * count, slowest remote hop estimate and snapshot age in seconds, then per
+ * router rloc16, next hop, path cost, lq in, lq out, link margin and frame
+ * error rate, then per child rloc16, link margin, lq in, frame and message
+ * error rate and rx-on-when-idle. POST takes a fresh snapshot first.
+ *****************************************************************************/
+static void topo_handler(void *aContext, otMessage *aMessage, const otMessageInfo *aMessageInfo)
+{
+  static uint8_t  payload[TOPOLOGY_EXPORT_SIZE];
+  size_t          length;
+
+  switch(otCoapMessageGetCode(aMessage)) {
+    case OT_COAP_CODE_POST:
+      topology_request_update();
+      topology_process();
+      // fall through
+    case OT_COAP_CODE_GET:
+      length = topology_export(payload, sizeof(payload));
+      coap_diag_respond(aContext, aMessage, aMessageInfo, OT_COAP_CODE_CONTENT, payload, (uint16_t)length);
+      break;
+
+    default:
+      coap_diag_respond(aContext, aMessage, aMessageInfo, OT_COAP_CODE_METHOD_NOT_ALLOWED, NULL, 0);
+      break;
+  }
+}
+
+/**************************************************************************//**
+ * diag/buffers
+ *
+ * GET returns the buffer_pressure_export() record: version, current level,
+ * total and lowest free message buffers and answers rejected, then per level
+ * (normal, quiet, lean, reject) the times entered and the ms spent in it.
+ * DELETE clears it.
+ *****************************************************************************/
+static void buffers_handler(void *aContext, otMessage *aMessage, const otMessageInfo *aMessageInfo)
+{
+  static uint8_t  payload[BUFFER_PRESSURE_EXPORT_SIZE];
+  size_t          length;
+
+  switch(otCoapMessageGetCode(aMessage)) {
+    case OT_COAP_CODE_GET:
+      length = buffer_pressure_export(payload, sizeof(payload));
+      coap_diag_respond(aContext, aMessage, aMessageInfo, OT_COAP_CODE_CONTENT, payload, (uint16_t)length);
+      break;
+
+    case OT_COAP_CODE_DELETE:
+      buffer_pressure_reset_stats();
+      coap_diag_respond(aContext, aMessage, aMessageInfo, OT_COAP_CODE_DELETED, NULL, 0);
+      break;
+
+    default:
+      coap_diag_respond(aContext, aMessage, aMessageInfo, OT_COAP_CODE_METHOD_NOT_ALLOWED, NULL, 0);
+      break;
+  }
+}
+
+/**************************************************************************//**
+ * diag/gui
+ *
+ * GET returns the gui_trace_export() record: version, kind, stage and bucket
+ * counts and events drawn untraced, then per event kind (button, network,
+ * log, join, vote) and stage (wait, render, flush, total) the count, mean and
+ * max in us and the histogram. DELETE clears it.
+ *****************************************************************************/
+static void gui_handler(void *aContext, otMessage *aMessage, const otMessageInfo *aMessageInfo)
+{
+  static uint8_t  payload[GUI_TRACE_EXPORT_SIZE];
+  size_t          length;
+
+  switch(otCoapMessageGetCode(aMessage)) {
+    case OT_COAP_CODE_GET:
+      length = gui_trace_export(payload, sizeof(payload));
+      coap_diag_respond(aContext, aMessage, aMessageInfo, OT_COAP_CODE_CONTENT, payload, (uint16_t)length);
+      break;
+
+    case OT_COAP_CODE_DELETE:
+      gui_trace_reset();
+      coap_diag_respond(aContext, aMessage, aMessageInfo, OT_COAP_CODE_DELETED, NULL, 0);
+      break;
+
+    default:
+      coap_diag_respond(aContext, aMessage, aMessageInfo, OT_COAP_CODE_METHOD_NOT_ALLOWED, NULL, 0);
+      break;
+  }
+}
+
+#if COAP_SECURE_ENABLE
+/**************************************************************************//**
+ * diag/secure
+ *
+ * GET returns the coap_secure_export() record: version, cache size, sessions
+ * cached and bytes per session as u16, then handshakes, ms and longest ms the
+ * DTLS endpoint was held, aborted connections, resumes, failed resumes, cache
+ * hits and misses, evictions, forged and replayed requests as u32. DELETE
+ * clears the counters.
+ *****************************************************************************/
+static void secure_handler(void *aContext, otMessage *aMessage, const otMessageInfo *aMessageInfo)
+{
+  static uint8_t  payload[COAP_SECURE_EXPORT_SIZE];
+  size_t          length;
+
+  switch(otCoapMessageGetCode(aMessage)) {
+    case OT_COAP_CODE_GET:
+      length = coap_secure_export(payload, sizeof(payload));
+      coap_diag_respond(aContext, aMessage, aMessageInfo, OT_COAP_CODE_CONTENT, payload, (uint16_t)length);
+      break;
+
+    case OT_COAP_CODE_DELETE:
+      coap_secure_reset_stats();
+      coap_diag_respond(aContext, aMessage, aMessageInfo, OT_COAP_CODE_DELETED, NULL, 0);
+      break;
+
+    default:
+      coap_diag_respond(aContext, aMessage, aMessageInfo, OT_COAP_CODE_METHOD_NOT_ALLOWED, NULL, 0);
+      break;
+  }
+}
+#endif
+
+#if OPENTHREAD_CONFIG_HEAP_EXTERNAL_ENABLE
+/**************************************************************************//**
+ * diag/heap
+ *
+ * GET returns the block pool statistics, little-endian: allocs, frees,
+ * failed, bytes in use and peak bytes as u32, the class count as u8, then
+ * per class size, blocks, in use and peak as u16 and spills as u32.
+ * DELETE clears the counters and peaks.
+ *****************************************************************************/
+static void heap_handler(void *aContext, otMessage *aMessage, const otMessageInfo *aMessageInfo)
+{
+  static uint8_t      payload[21 + 12 * BLOCK_POOL_CLASS_COUNT];
+  block_pool_stats_t  stats;
+  uint8_t             *p = payload;
+
+  switch(otCoapMessageGetCode(aMessage)) {
+    case OT_COAP_CODE_GET:
+      block_pool_get_stats(&stats);
+      p = coap_diag_put_u32(p, stats.allocs);
+      p = coap_diag_put_u32(p, stats.frees);
+      p = coap_diag_put_u32(p, stats.failed);
+      p = coap_diag_put_u32(p, stats.bytes_in_use);
+      p = coap_diag_put_u32(p, stats.bytes_peak);
+      *p++ = BLOCK_POOL_CLASS_COUNT;
+      for(uint32_t c = 0; c < BLOCK_POOL_CLASS_COUNT; c++)
+      {
+          p = coap_diag_put_u16(p, stats.classes[c].size);
+          p = coap_diag_put_u16(p, stats.classes[c].blocks);
+          p = coap_diag_put_u16(p, stats.classes[c].in_use);
+          p = coap_diag_put_u16(p, stats.classes[c].peak);
+          p = coap_diag_put_u32(p, stats.classes[c].spills);
+      }
+      coap_diag_respond(aContext, aMessage, aMessageInfo, OT_COAP_CODE_CONTENT, payload, (uint16_t)(p - payload));
+      break;
+
+    case OT_COAP_CODE_DELETE:
+      block_pool_reset_stats();
+      coap_diag_respond(aContext, aMessage, aMessageInfo, OT_COAP_CODE_DELETED, NULL, 0);
+      break;
+
+    default:
+      coap_diag_respond(aContext, aMessage, aMessageInfo, OT_COAP_CODE_METHOD_NOT_ALLOWED, NULL, 0);
+      break;
+  }
+}
+#endif
+
+#if PROF_ENABLE
+/**************************************************************************//**
+ * diag/prof
+ *
+ * GET returns the prof_export() record, DELETE clears the statistics.
+ *****************************************************************************/
+static void prof_handler(void *aContext, otMessage *aMessage, const otMessageInfo *aMessageInfo)
+{
+  static uint8_t  payload[7 + PROF_STAGE_COUNT * (16 + 2 * PROF_BUCKETS)];
+  size_t          length;
+
+  switch(otCoapMessageGetCode(aMessage)) {
+    case OT_COAP_CODE_GET:
+      length = prof_export(payload, sizeof(payload));
+      coap_diag_respond(aContext, aMessage, aMessageInfo, OT_COAP_CODE_CONTENT, payload, (uint16_t)length);
+      break;
+
+    case OT_COAP_CODE_DELETE:
+      prof_reset();
+      coap_diag_respond(aContext, aMessage, aMessageInfo, OT_COAP_CODE_DELETED, NULL, 0);
+      break;
+
+    default:
+      coap_diag_respond(aContext, aMessage, aMessageInfo, OT_COAP_CODE_METHOD_NOT_ALLOWED, NULL, 0);
+      break;
+  }
+}
+#endif
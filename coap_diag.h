@@ -0,0 +1,57 @@
+/***************************************************************************//**
+ * @file
+ * @brief Diagnostics CoAP Resources Header
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#ifndef COAP_DIAG_H_
+#define COAP_DIAG_H_
+
+#include <stdbool.h>
+
+#include <openthread/coap.h>
+
+#include "coap_diag_codec.h"
+
+// registers the diag/* resources on the running coap server
+otError coap_diag_init(otInstance *aInstance);
+
+// reply to a request with a piggybacked response, payload may be NULL
+otError coap_diag_respond(otInstance *aInstance, otMessage *aRequest, const otMessageInfo *aMessageInfo,
+                          otCoapCode aCode, const uint8_t *aPayload, uint16_t aLength);
+
+// requests that change the base station are only taken from link-local
+// peers, one radio hop away, or from the base station's own addresses
+bool coap_diag_peer_is_local(otInstance *aInstance, const otMessageInfo *aMessageInfo);
+
+#endif /* COAP_DIAG_H_ */
@@ -0,0 +1,64 @@
+/***************************************************************************//**
+ * @file
+ * @brief Payload Encoding Helpers for the Base Station Diagnostics
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#include "coap_diag_codec.h"
+
+uint8_t *coap_diag_put_u16(uint8_t *p, uint16_t value)
+{
+  p[0] = (uint8_t)value;
+  p[1] = (uint8_t)(value >> 8);
+  return p + 2;
+}
+
+uint8_t *coap_diag_put_u32(uint8_t *p, uint32_t value)
+{
+  p = coap_diag_put_u16(p, (uint16_t)value);
+  return coap_diag_put_u16(p, (uint16_t)(value >> 16));
+}
+
+uint16_t coap_diag_crc16(uint16_t crc, const uint8_t *data, size_t length)
+{
+  while(length--)
+  {
+      crc ^= (uint16_t)(*data++) << 8;
+      for(uint32_t bit = 0; bit < 8; bit++)
+      {
+          crc = (crc & 0x8000u) ? (uint16_t)((crc << 1) ^ 0x1021u) : (uint16_t)(crc << 1);
+      }
+  }
+
+  return crc;
+}
@@ -0,0 +1,56 @@
+/***************************************************************************//**
+ * @file
+ * @brief Payload Encoding Helpers for the Base Station Diagnostics
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#ifndef COAP_DIAG_CODEC_H_
+#define COAP_DIAG_CODEC_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Byte-level encoding shared by the diag resource exports and other binary
+ * records. Kept apart from coap_diag.c so modules that are also built on the
+ * host without OpenThread can use it.
+ */
+
+// little-endian payload helpers, return the position after the value
+uint8_t *coap_diag_put_u16(uint8_t *p, uint16_t value);
+uint8_t *coap_diag_put_u32(uint8_t *p, uint32_t value);
+
+// CRC-16/CCITT-FALSE, start from 0xFFFF or chain from the last value
+uint16_t coap_diag_crc16(uint16_t crc, const uint8_t *data, size_t length);
+
+#endif /* COAP_DIAG_CODEC_H_ */
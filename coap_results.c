@@ -0,0 +1,247 @@
+/***************************************************************************//**
+ * @file
+ * @brief CBOR Results Resource
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#include <openthread/coap.h>
+#include <openthread/random_noncrypto.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#define LOG_MODULE  COAP
+#include "logging.h"
+
+#include "coap_results.h"
+#include "tally.h"
+
+// CBOR major types
+#define CBOR_UINT   0u
+#define CBOR_ARRAY  4u
+#define CBOR_MAP    5u
+
+static void results_handler(void *aContext, otMessage *aMessage, const otMessageInfo *aMessageInfo);
+static bool since_query(const otMessage *aMessage, uint32_t *since);
+static uint8_t *cbor_head(uint8_t *p, uint8_t major, uint32_t value);
+static otError send_cbor(otInstance *aInstance, otMessage *aRequest, const otMessageInfo *aMessageInfo,
+                         otCoapCode aCode, const uint8_t *aPayload, uint16_t aLength);
+
+static  otCoapResource  results_resource;
+static  uint32_t        epoch;          // added to the tally version on the wire
+static  bool            epoch_drawn;
+
+otError coap_results_init(otInstance *aInstance)
+{
+  // once per boot, the server is started again on every return to leader
+  if(!epoch_drawn)
+  {
+      epoch       = otRandomNonCryptoGetUint32();
+      epoch_drawn = true;
+  }
+
+  results_resource.mUriPath = COAP_RESULTS_URI;
+  results_resource.mHandler = &results_handler;
+  results_resource.mContext = aInstance;
+
+  otCoapAddResource(aInstance, &results_resource);
+
+  return OT_ERROR_NONE;
+}
+
+static void results_handler(void *aContext, otMessage *aMessage, const otMessageInfo *aMessageInfo)
+{
+  // array and map heads, version, question, then a key and a value per counter
+  static uint8_t  payload[1 + 5 + 2 + 1 + TALLY_COUNTERS * (1 + 3)];
+  uint8_t         *p        = payload;
+  uint32_t        counters  = TALLY_CHANGED_ALL;
+  uint32_t        since;
+  otError         error;
+
+  if(otCoapMessageGetCode(aMessage) != OT_COAP_CODE_GET)
+  {
+      send_cbor(aContext, aMessage, aMessageInfo, OT_COAP_CODE_METHOD_NOT_ALLOWED, NULL, 0);
+      return;
+  }
+
+  if(since_query(aMessage, &since))
+  {
+      counters = tally_changed_since(since - epoch);
+  }
+
+  p = cbor_head(p, CBOR_ARRAY, 3);
+  p = cbor_head(p, CBOR_UINT, tally_version() + epoch);
+  p = cbor_head(p, CBOR_UINT, tally_question());
+  p = cbor_head(p, CBOR_MAP, (uint32_t)__builtin_popcount(counters));
+
+  for(uint8_t c = 0; c < TALLY_COUNTERS; c++)
+  {
+      if(counters & (1ul << c))
+      {
+          p = cbor_head(p, CBOR_UINT, c);
+          p = cbor_head(p, CBOR_UINT, tally_counter(c));
+      }
+  }
+
+  error = send_cbor(aContext, aMessage, aMessageInfo, OT_COAP_CODE_CONTENT, payload, (uint16_t)(p - payload));
+  if(error)
+  {
+      LOG_WRN("results response: %s\r\n", otThreadErrorToString(error));
+  }
+}
+
+// looks for Uri-Query since=<version>, returns false if there is none
+static bool since_query(const otMessage *aMessage, uint32_t *since)
+{
+  otCoapOptionIterator  iterator;
+  const otCoapOption    *option;
+  char                  query[20];
+  char                  *end;
+
+  if(otCoapOptionIteratorInit(&iterator, aMessage) != OT_ERROR_NONE)
+  {
+      return false;
+  }
+
+  for(option = otCoapOptionIteratorGetFirstOptionMatching(&iterator, OT_COAP_OPTION_URI_QUERY);
+      option != NULL;
+      option = otCoapOptionIteratorGetNextOptionMatching(&iterator, OT_COAP_OPTION_URI_QUERY))
+  {
+      if(option->mLength >= sizeof(query) || otCoapOptionIteratorGetOptionValue(&iterator, query) != OT_ERROR_NONE)
+      {
+          continue;
+      }
+      query[option->mLength] = '\0';
+
+      if(strncmp(query, "since=", 6) != 0)
+      {
+          continue;
+      }
+
+      *since = (uint32_t)strtoul(&query[6], &end, 10);
+      return (end != &query[6] && *end == '\0');
+  }
+
+  return false;
+}
+
+// initial byte and the shortest argument that holds the value, RFC 8949 3.
+static uint8_t *cbor_head(uint8_t *p, uint8_t major, uint32_t value)
+{
+  major = (uint8_t)(major << 5);
+
+  if(value < 24u)
+  {
+      *p++ = (uint8_t)(major | value);
+  }
+  else if(value <= 0xFFu)
+  {
+      *p++ = (uint8_t)(major | 24u);
+      *p++ = (uint8_t)value;
+  }
+  else if(value <= 0xFFFFu)
+  {
+      *p++ = (uint8_t)(major | 25u);
+      *p++ = (uint8_t)(value >> 8);
+      *p++ = (uint8_t)value;
+  }
+  else
+  {
+      *p++ = (uint8_t)(major | 26u);
+      *p++ = (uint8_t)(value >> 24);
+      *p++ = (uint8_t)(value >> 16);
+      *p++ = (uint8_t)(value >> 8);
+      *p++ = (uint8_t)value;
+  }
+
+  return p;
+}
+
+/*
+ * Piggybacked response with Content-Format application/cbor, only confirmable
+ * requests get one like on the diag resources.
+ */
+static otError send_cbor(otInstance *aInstance, otMessage *aRequest, const otMessageInfo *aMessageInfo,
+                         otCoapCode aCode, const uint8_t *aPayload, uint16_t aLength)
+{
+  otError   error = OT_ERROR_NONE;
+  otMessage *response_message;
+
+  if(otCoapMessageGetType(aRequest) != OT_COAP_TYPE_CONFIRMABLE)
+  {
+      return OT_ERROR_NONE;
+  }
+
+  response_message = otCoapNewMessage(aInstance, NULL);
+  if(response_message == NULL)
+  {
+      return OT_ERROR_NO_BUFS;
+  }
+
+  error = otCoapMessageInitResponse(response_message, aRequest, OT_COAP_TYPE_ACKNOWLEDGMENT, aCode);
+  if(error)
+  {
+      goto exit;
+  }
+
+  if(aPayload != NULL && aLength > 0)
+  {
+      error = otCoapMessageAppendContentFormatOption(response_message, OT_COAP_OPTION_CONTENT_FORMAT_CBOR);
+      if(error)
+      {
+          goto exit;
+      }
+
+      error = otCoapMessageSetPayloadMarker(response_message);
+      if(error)
+      {
+          goto exit;
+      }
+
+      error = otMessageAppend(response_message, aPayload, aLength);
+      if(error)
+      {
+          goto exit;
+      }
+  }
+
+  error = otCoapSendResponse(aInstance, response_message, aMessageInfo);
+
+exit:
+  if(error)
+  {
+      otMessageFree(response_message);
+  }
+
+  return error;
+}
@@ -0,0 +1,65 @@
+/***************************************************************************//**
+ * @file
+ * @brief CBOR Results Resource
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#ifndef COAP_RESULTS_H_
+#define COAP_RESULTS_H_
+
+#include <openthread/coap.h>
+
+/*
+ * GET results returns the tally as CBOR (Content-Format 60) for dashboards
+ * and gateways polling over the mesh:
+ *
+ *   [version, question, {counter: value, ...}]
+ *
+ * Counters are the answer choices 0 to TALLY_CHOICE_COUNT - 1, then
+ * responded and remotes, see TALLY_COUNTER_* in tally.h. A plain GET has all
+ * of them. With Uri-Query since=<version>, from an earlier response, only the
+ * counters that changed after that version are in the map, so an idle poll is
+ * a handful of bytes. When the tally's change log doesn't reach back that far,
+ * the version is from before a reboot, or the question changed, all counters
+ * are sent and the reader simply overwrites its table.
+ *
+ * Versions are offset by a random number picked at boot, so a version held
+ * over a reboot doesn't pass for a recent one.
+ */
+
+#define COAP_RESULTS_URI    "results"
+
+// registers the resource, may be called again, the epoch is drawn once
+otError coap_results_init(otInstance *aInstance);
+
+#endif /* COAP_RESULTS_H_ */
@@ -0,0 +1,703 @@
+/***************************************************************************//**
+ * @file
+ * @brief Secure Answers over Cached CoAPS Sessions
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#include "base_station_config.h"
+
+#if COAP_SECURE_ENABLE
+
+#include <string.h>
+
+#include <openthread/coap.h>
+#include <openthread/coap_secure.h>
+#include <openthread/random_crypto.h>
+
+#include "mbedtls/ccm.h"
+
+#include "sl_sleeptimer.h"
+
+#define LOG_MODULE  COAP
+#include "logging.h"
+
+#include "coap_secure.h"
+#include "coap_diag.h"
+#include "tally.h"
+#include "answer_time.h"
+#include "remote_registry.h"
+#include "prof.h"
+
+#define COAP_SECURE_EXPORT_VERSION  1u
+
+#define NONCE_SIZE        13u     // CCM with a 2 byte length field
+#define AAD_MAX           (COAP_SECURE_TICKET_SIZE + 4u)
+#define TICKET_PLAIN_SIZE 32u     // session id, interface identifier, key, issued
+#define NO_SESSION        0u
+
+typedef struct {
+  uint32_t  session;        // NO_SESSION if free
+  uint32_t  highest;        // sequence number
+  uint32_t  window;         // bit n: highest - n seen
+  uint32_t  used;           // least recently used goes first
+  uint16_t  remote;         // registry id when issued, for the replay floor
+  uint8_t   iid[REMOTE_REGISTRY_IID_SIZE];  // the registry may give the id to another remote
+  uint8_t   key[COAP_SECURE_KEY_SIZE];
+} session_t;
+
+// what outlives the cache entry, per remote id
+typedef struct {
+  uint32_t  session;        // latest issued, only that one resumes
+  uint32_t  floor;          // highest sequence when it left the cache
+} remote_session_t;
+
+static void connected_handler(bool aConnected, void *aContext);
+static void session_handler(void *aContext, otMessage *aMessage, const otMessageInfo *aMessageInfo);
+static void resume_handler(void *aContext, otMessage *aMessage, const otMessageInfo *aMessageInfo);
+static session_t *find(uint32_t session);
+static session_t *take_entry(void);
+static void evict(session_t *entry);
+static bool fresh(session_t *entry, uint32_t sequence);
+static bool ccm(const uint8_t *key, bool seal, const uint8_t *nonce, const uint8_t *aad, size_t aad_length,
+                uint8_t *data, size_t length, uint8_t *tag);
+static void make_nonce(uint8_t *nonce, uint32_t a, uint32_t b);
+static uint32_t get_u32(const uint8_t *p);
+static uint32_t now_s(void);
+
+static  otInstance              *sInstance;
+static  otCoapResource          session_resource;
+static  otCoapResource          resume_resource;
+static  mbedtls_ccm_context     ccm_context;
+static  session_t               sessions[COAP_SECURE_SESSIONS];
+static  remote_session_t        remotes[TALLY_MAX_REMOTES];
+static  uint32_t                use_count;
+static  uint8_t                 ticket_key[COAP_SECURE_KEY_SIZE];
+static  uint32_t                tickets_issued;
+static  bool                    started;            // endpoint up, sessions and ticket key set
+static  bool                    connected;
+static  bool                    issued;             // on the current DTLS connection
+static  uint32_t                connected_at;       // tick
+static  coap_secure_stats_t     stats;
+
+otError coap_secure_init(otInstance *aInstance)
+{
+  otError error = OT_ERROR_NONE;
+
+  sInstance = aInstance;
+
+  if(started)
+  {
+      goto resources;
+  }
+
+  memset(sessions, 0, sizeof(sessions));
+  memset(remotes, 0, sizeof(remotes));
+  coap_secure_reset_stats();
+  mbedtls_ccm_init(&ccm_context);
+
+  // tickets only live as long as the key, i.e. until the next reset, which
+  // also forgets the replay floors they would need
+  error = otRandomCryptoFillBuffer(ticket_key, sizeof(ticket_key));
+  if(error)
+  {
+      goto exit;
+  }
+
+  otCoapSecureSetPsk(aInstance, (const uint8_t *)COAP_SECURE_PSK, sizeof(COAP_SECURE_PSK) - 1,
+                     (const uint8_t *)COAP_SECURE_PSK_IDENTITY, sizeof(COAP_SECURE_PSK_IDENTITY) - 1);
+  otCoapSecureSetClientConnectedCallback(aInstance, connected_handler, aInstance);
+
+  error = otCoapSecureStart(aInstance, OT_DEFAULT_COAP_SECURE_PORT);
+  if(error)
+  {
+      goto exit;
+  }
+  started = true;
+
+resources:
+  session_resource.mUriPath = COAP_SECURE_SESSION_URI;
+  session_resource.mHandler = &session_handler;
+  session_resource.mContext = aInstance;
+  otCoapSecureAddResource(aInstance, &session_resource);
+
+  resume_resource.mUriPath  = COAP_SECURE_RESUME_URI;
+  resume_resource.mHandler  = &resume_handler;
+  resume_resource.mContext  = aInstance;
+  otCoapAddResource(aInstance, &resume_resource);
+
+exit:
+  if(error)
+  {
+      LOG_ERR("coap secure start: %s\r\n", otThreadErrorToString(error));
+  }
+  return error;
+}
+
+void coap_secure_process(void)
+{
+  uint32_t held;
+
+  if(!connected)
+  {
+      return;
+  }
+
+  // the endpoint takes one remote at a time, don't let one keep it
+  held = sl_sleeptimer_tick_to_ms(sl_sleeptimer_get_tick_count() - connected_at);
+  if(held >= COAP_SECURE_HOLD_MS)
+  {
+      LOG_WRN("coap secure: closing a session held %lu ms\r\n", (unsigned long)held);
+      otCoapSecureDisconnect(sInstance);
+  }
+}
+
+coap_secure_result_t coap_secure_open(const otMessage *aMessage, uint8_t *aPayload, uint16_t *aLength,
+                                      const uint8_t **aIid)
+{
+  coap_secure_result_t  result = COAP_SECURE_REJECTED;
+  otCoapOptionIterator  iterator;
+  const otCoapOption    *option;
+  uint8_t               aad[COAP_SECURE_HEADER_SIZE + AAD_MAX];
+  size_t                aad_length = COAP_SECURE_HEADER_SIZE;
+  uint8_t               nonce[NONCE_SIZE];
+  uint32_t              session;
+  uint32_t              sequence;
+  uint16_t              length;
+  session_t             *entry;
+
+  PROF_BEGIN(PROF_STAGE_SECURE);
+
+  if(*aLength < COAP_SECURE_HEADER_SIZE + COAP_SECURE_TAG_SIZE)
+  {
+      goto exit;
+  }
+  length   = (uint16_t)(*aLength - COAP_SECURE_HEADER_SIZE - COAP_SECURE_TAG_SIZE);
+  session  = get_u32(&aPayload[0]);
+  sequence = get_u32(&aPayload[4]);
+
+  entry = find(session);
+  if(entry == NULL)
+  {
+      stats.misses++;
+      result = COAP_SECURE_UNKNOWN;
+      goto exit;
+  }
+  stats.hits++;
+
+  // the header, then every Uri-Query with its length in front
+  memcpy(aad, aPayload, COAP_SECURE_HEADER_SIZE);
+  if(otCoapOptionIteratorInit(&iterator, aMessage) != OT_ERROR_NONE)
+  {
+      goto exit;
+  }
+  for(option = otCoapOptionIteratorGetFirstOptionMatching(&iterator, OT_COAP_OPTION_URI_QUERY);
+      option != NULL;
+      option = otCoapOptionIteratorGetNextOptionMatching(&iterator, OT_COAP_OPTION_URI_QUERY))
+  {
+      if(aad_length + 1 + option->mLength > sizeof(aad)
+         || otCoapOptionIteratorGetOptionValue(&iterator, &aad[aad_length + 1]) != OT_ERROR_NONE)
+      {
+          goto exit;
+      }
+      aad[aad_length] = (uint8_t)option->mLength;
+      aad_length     += 1u + option->mLength;
+  }
+
+  make_nonce(nonce, session, sequence);
+  if(!ccm(entry->key, false, nonce, aad, aad_length, &aPayload[COAP_SECURE_HEADER_SIZE], length,
+          &aPayload[COAP_SECURE_HEADER_SIZE + length]))
+  {
+      stats.rejected++;
+      goto exit;
+  }
+
+  // only once it is authentic, or anyone could move the window
+  if(!fresh(entry, sequence))
+  {
+      stats.replayed++;
+      goto exit;
+  }
+
+  entry->used = ++use_count;
+
+  memmove(aPayload, &aPayload[COAP_SECURE_HEADER_SIZE], length);
+  *aLength = length;
+  *aIid    = entry->iid;
+  result   = COAP_SECURE_OPENED;
+
+exit:
+  PROF_END(PROF_STAGE_SECURE);
+  return result;
+}
+
+void coap_secure_flush(void)
+{
+  for(uint32_t i = 0; i < COAP_SECURE_SESSIONS; i++)
+  {
+      if(sessions[i].session != NO_SESSION)
+      {
+          evict(&sessions[i]);
+      }
+  }
+}
+
+const coap_secure_stats_t *coap_secure_get_stats(void)
+{
+  stats.cached = 0;
+  for(uint32_t i = 0; i < COAP_SECURE_SESSIONS; i++)
+  {
+      stats.cached += (sessions[i].session != NO_SESSION) ? 1u : 0u;
+  }
+
+  return &stats;
+}
+
+void coap_secure_reset_stats(void)
+{
+  memset(&stats, 0, sizeof(stats));
+  stats.session_bytes = (uint16_t)sizeof(session_t);
+}
+
+size_t coap_secure_export(uint8_t *buffer, size_t size)
+{
+  const coap_secure_stats_t *snapshot = coap_secure_get_stats();
+  uint8_t                   *p        = buffer;
+
+  if(size < COAP_SECURE_EXPORT_SIZE)
+  {
+      return 0;
+  }
+
+  *p++ = COAP_SECURE_EXPORT_VERSION;
+  p    = coap_diag_put_u16(p, COAP_SECURE_SESSIONS);
+  p    = coap_diag_put_u16(p, snapshot->cached);
+  p    = coap_diag_put_u16(p, snapshot->session_bytes);
+  p    = coap_diag_put_u32(p, snapshot->handshakes);
+  p    = coap_diag_put_u32(p, snapshot->held_ms);
+  p    = coap_diag_put_u32(p, snapshot->held_max_ms);
+  p    = coap_diag_put_u32(p, snapshot->aborted);
+  p    = coap_diag_put_u32(p, snapshot->resumed);
+  p    = coap_diag_put_u32(p, snapshot->resume_failed);
+  p    = coap_diag_put_u32(p, snapshot->hits);
+  p    = coap_diag_put_u32(p, snapshot->misses);
+  p    = coap_diag_put_u32(p, snapshot->evicted);
+  p    = coap_diag_put_u32(p, snapshot->rejected);
+  p    = coap_diag_put_u32(p, snapshot->replayed);
+
+  return (size_t)(p - buffer);
+}
+
+/*
+ * DTLS connection events. The stack only reports the connection once the
+ * handshake is through, so the time held counts from there.
+ */
+static void connected_handler(bool aConnected, void *aContext)
+{
+  uint32_t held;
+
+  OT_UNUSED_VARIABLE(aContext);
+
+  if(aConnected)
+  {
+      connected    = true;
+      issued       = false;
+      connected_at = sl_sleeptimer_get_tick_count();
+      return;
+  }
+
+  if(!connected)
+  {
+      return;
+  }
+  connected = false;
+
+  held = sl_sleeptimer_tick_to_ms(sl_sleeptimer_get_tick_count() - connected_at);
+  stats.held_ms     += held;
+  stats.held_max_ms  = (held > stats.held_max_ms) ? held : stats.held_max_ms;
+  if(!issued)
+  {
+      stats.aborted++;
+  }
+}
+
+/*
+ * session, on the CoAPS endpoint
+ *
+ * POST issues a session to the remote at the other end of the DTLS
+ * connection: 2.01 with the session id u32, the key and the ticket. A remote
+ * the registry has no room for gets 5.03.
+ */
+static void session_handler(void *aContext, otMessage *aMessage, const otMessageInfo *aMessageInfo)
+{
+  const uint8_t *iid = &aMessageInfo->mPeerAddr.mFields.m8[8];
+  uint8_t       payload[4 + COAP_SECURE_KEY_SIZE + COAP_SECURE_TICKET_SIZE];
+  uint8_t       *ticket = &payload[4 + COAP_SECURE_KEY_SIZE];
+  uint8_t       nonce[NONCE_SIZE];
+  uint8_t       key[COAP_SECURE_KEY_SIZE];
+  otMessage     *response = NULL;
+  otError       error     = OT_ERROR_NONE;
+  otCoapCode    code      = OT_COAP_CODE_CREATED;
+  uint16_t      length    = sizeof(payload);
+  uint16_t      id;
+  uint32_t      session;
+  session_t     *entry;
+
+  if(otCoapMessageGetCode(aMessage) != OT_COAP_CODE_POST)
+  {
+      code   = OT_COAP_CODE_METHOD_NOT_ALLOWED;
+      length = 0;
+      goto respond;
+  }
+
+  if(remote_registry_add(iid, tally_answered(), &id) != SL_STATUS_OK)
+  {
+      code   = OT_COAP_CODE_SERVICE_UNAVAILABLE;
+      length = 0;
+      goto respond;
+  }
+
+  // session id and key first, the cache is left alone if there are none
+  do
+  {
+      error = otRandomCryptoFillBuffer((uint8_t *)&session, sizeof(session));
+  } while(error == OT_ERROR_NONE && (session == NO_SESSION || find(session) != NULL));
+
+  if(error == OT_ERROR_NONE)
+  {
+      error = otRandomCryptoFillBuffer(key, sizeof(key));
+  }
+  if(error)
+  {
+      LOG_ERR("coap secure session: %s\r\n", otThreadErrorToString(error));
+      error  = OT_ERROR_NONE;
+      code   = OT_COAP_CODE_INTERNAL_ERROR;
+      length = 0;
+      goto respond;
+  }
+
+  // ticket: counter u32, then sealed under the ticket key the session id,
+  // interface identifier, session key and time issued
+  coap_diag_put_u32(&payload[0], session);
+  memcpy(&payload[4], key, COAP_SECURE_KEY_SIZE);
+
+  coap_diag_put_u32(&ticket[0], tickets_issued + 1);
+  coap_diag_put_u32(&ticket[4], session);
+  memcpy(&ticket[8], iid, REMOTE_REGISTRY_IID_SIZE);
+  memcpy(&ticket[16], key, COAP_SECURE_KEY_SIZE);
+  coap_diag_put_u32(&ticket[32], now_s());
+
+  make_nonce(nonce, 0, tickets_issued + 1);
+  if(!ccm(ticket_key, true, nonce, ticket, 4, &ticket[4], TICKET_PLAIN_SIZE, &ticket[4 + TICKET_PLAIN_SIZE]))
+  {
+      LOG_ERR("coap secure session: ticket not sealed\r\n");
+      code   = OT_COAP_CODE_INTERNAL_ERROR;
+      length = 0;
+      goto respond;
+  }
+  tickets_issued++;
+
+  // any earlier session of the remote, cached or in a ticket, is done for
+  entry = find(remotes[id].session);
+  if(entry != NULL)
+  {
+      memset(entry, 0, sizeof(*entry));
+  }
+
+  entry           = take_entry();
+  entry->session  = session;
+  entry->highest  = 0;
+  entry->window   = 0;
+  entry->used     = ++use_count;
+  entry->remote   = id;
+  memcpy(entry->iid, iid, sizeof(entry->iid));
+  memcpy(entry->key, key, sizeof(entry->key));
+
+  remotes[id].session = session;
+  remotes[id].floor   = 0;
+
+  issued = true;
+  stats.handshakes++;
+
+respond:
+  response = otCoapNewMessage((otInstance *)aContext, NULL);
+  if(response == NULL)
+  {
+      error = OT_ERROR_NO_BUFS;
+      goto exit;
+  }
+
+  error = otCoapMessageInitResponse(response, aMessage, OT_COAP_TYPE_ACKNOWLEDGMENT, code);
+  if(error == OT_ERROR_NONE && length > 0)
+  {
+      error = otCoapMessageSetPayloadMarker(response);
+      if(error == OT_ERROR_NONE)
+      {
+          error = otMessageAppend(response, payload, length);
+      }
+  }
+  if(error == OT_ERROR_NONE)
+  {
+      error = otCoapSecureSendResponse((otInstance *)aContext, response, aMessageInfo);
+  }
+
+exit:
+  if(error)
+  {
+      if(response != NULL)
+      {
+          otMessageFree(response);
+      }
+      LOG_WRN("coap secure session: %s\r\n", otThreadErrorToString(error));
+  }
+
+  // the key is out of the stack's hands now
+  memset(payload, 0, sizeof(payload));
+  memset(key, 0, sizeof(key));
+}
+
+/*
+ * session/resume
+ *
+ * POST the ticket, a sequence number u32 and the tag under the session key
+ * over both. 2.04 puts the session back in the cache, 4.01 sends the remote
+ * to the handshake.
+ */
+static void resume_handler(void *aContext, otMessage *aMessage, const otMessageInfo *aMessageInfo)
+{
+  uint8_t     request[COAP_SECURE_TICKET_SIZE + 4 + COAP_SECURE_TAG_SIZE];
+  uint8_t     plain[TICKET_PLAIN_SIZE];
+  uint8_t     nonce[NONCE_SIZE];
+  otCoapCode  code = OT_COAP_CODE_UNAUTHORIZED;
+  uint32_t    session;
+  uint32_t    sequence;
+  uint16_t    id;
+  session_t   *entry;
+
+  if(otCoapMessageGetCode(aMessage) != OT_COAP_CODE_POST)
+  {
+      coap_diag_respond(aContext, aMessage, aMessageInfo, OT_COAP_CODE_METHOD_NOT_ALLOWED, NULL, 0);
+      return;
+  }
+
+  PROF_BEGIN(PROF_STAGE_SECURE);
+
+  if(otMessageRead(aMessage, otMessageGetOffset(aMessage), request, sizeof(request)) != sizeof(request))
+  {
+      goto exit;
+  }
+
+  // the ticket is ours and current
+  memcpy(plain, &request[4], sizeof(plain));
+  make_nonce(nonce, 0, get_u32(&request[0]));
+  if(!ccm(ticket_key, false, nonce, request, 4, plain, sizeof(plain), &request[4 + TICKET_PLAIN_SIZE])
+     || now_s() - get_u32(&plain[28]) > COAP_SECURE_TICKET_LIFETIME_S)
+  {
+      goto exit;
+  }
+
+  // of the latest session of a remote still in the registry
+  session = get_u32(&plain[0]);
+  id      = remote_registry_find(&plain[4]);
+  if(id == REMOTE_ID_NONE || remotes[id].session != session)
+  {
+      goto exit;
+  }
+
+  // and the remote holds the key, with a sequence number it hasn't used
+  sequence = get_u32(&request[COAP_SECURE_TICKET_SIZE]);
+  make_nonce(nonce, session, sequence);
+  if(!ccm(&plain[12], false, nonce, request, COAP_SECURE_TICKET_SIZE + 4, NULL, 0,
+          &request[COAP_SECURE_TICKET_SIZE + 4]))
+  {
+      stats.rejected++;
+      goto exit;
+  }
+
+  entry = find(session);
+  if(entry == NULL)
+  {
+      if(sequence <= remotes[id].floor)
+      {
+          stats.replayed++;
+          goto exit;
+      }
+
+      entry           = take_entry();
+      entry->session  = session;
+      entry->highest  = sequence;
+      entry->window   = 1;
+      entry->remote   = id;
+      memcpy(entry->iid, &plain[4], sizeof(entry->iid));
+      memcpy(entry->key, &plain[12], COAP_SECURE_KEY_SIZE);
+  }
+  else if(!fresh(entry, sequence))
+  {
+      stats.replayed++;
+      goto exit;
+  }
+  entry->used = ++use_count;
+
+  code = OT_COAP_CODE_CHANGED;
+  stats.resumed++;
+
+exit:
+  PROF_END(PROF_STAGE_SECURE);
+
+  memset(plain, 0, sizeof(plain));
+  if(code != OT_COAP_CODE_CHANGED)
+  {
+      stats.resume_failed++;
+  }
+  coap_diag_respond(aContext, aMessage, aMessageInfo, code, NULL, 0);
+}
+
+static session_t *find(uint32_t session)
+{
+  if(session == NO_SESSION)
+  {
+      return NULL;
+  }
+
+  for(uint32_t i = 0; i < COAP_SECURE_SESSIONS; i++)
+  {
+      if(sessions[i].session == session)
+      {
+          return &sessions[i];
+      }
+  }
+
+  return NULL;
+}
+
+// a free entry, or the least recently used one
+static session_t *take_entry(void)
+{
+  session_t *oldest = &sessions[0];
+
+  for(uint32_t i = 0; i < COAP_SECURE_SESSIONS; i++)
+  {
+      if(sessions[i].session == NO_SESSION)
+      {
+          return &sessions[i];
+      }
+      if(use_count - sessions[i].used > use_count - oldest->used)
+      {
+          oldest = &sessions[i];
+      }
+  }
+
+  evict(oldest);
+  return oldest;
+}
+
+// the sequence number it got to stays behind for a resume
+static void evict(session_t *entry)
+{
+  if(remotes[entry->remote].session == entry->session)
+  {
+      remotes[entry->remote].floor = entry->highest;
+  }
+
+  memset(entry, 0, sizeof(*entry));
+  stats.evicted++;
+}
+
+// sliding window over the last 32 sequence numbers, marks the one seen
+static bool fresh(session_t *entry, uint32_t sequence)
+{
+  uint32_t behind;
+
+  if(sequence > entry->highest)
+  {
+      behind          = sequence - entry->highest;
+      entry->window   = (behind < 32u) ? (entry->window << behind) | 1u : 1u;
+      entry->highest  = sequence;
+      return true;
+  }
+
+  behind = entry->highest - sequence;
+  if(behind >= 32u || (entry->window & (1u << behind)))
+  {
+      return false;
+  }
+
+  entry->window |= 1u << behind;
+  return true;
+}
+
+// AES-128-CCM with an 8 byte tag, data in place, false if it isn't authentic
+static bool ccm(const uint8_t *key, bool seal, const uint8_t *nonce, const uint8_t *aad, size_t aad_length,
+                uint8_t *data, size_t length, uint8_t *tag)
+{
+  int result;
+
+  result = mbedtls_ccm_setkey(&ccm_context, MBEDTLS_CIPHER_ID_AES, key, COAP_SECURE_KEY_SIZE * 8);
+  if(result != 0)
+  {
+      return false;
+  }
+
+  if(seal)
+  {
+      result = mbedtls_ccm_encrypt_and_tag(&ccm_context, length, nonce, NONCE_SIZE, aad, aad_length,
+                                           data, data, tag, COAP_SECURE_TAG_SIZE);
+  }
+  else
+  {
+      result = mbedtls_ccm_auth_decrypt(&ccm_context, length, nonce, NONCE_SIZE, aad, aad_length,
+                                        data, data, tag, COAP_SECURE_TAG_SIZE);
+  }
+
+  return result == 0;
+}
+
+// a u32 little-endian, then b, then zeros, session nonces are (session,
+// sequence) and ticket nonces (0, ticket counter)
+static void make_nonce(uint8_t *nonce, uint32_t a, uint32_t b)
+{
+  memset(nonce, 0, NONCE_SIZE);
+  coap_diag_put_u32(&nonce[0], a);
+  coap_diag_put_u32(&nonce[4], b);
+}
+
+static uint32_t get_u32(const uint8_t *p)
+{
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint32_t now_s(void)
+{
+  return (uint32_t)(answer_time_now() / 1000000u);
+}
+
+#endif /* COAP_SECURE_ENABLE */
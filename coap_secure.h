@@ -0,0 +1,143 @@
+/***************************************************************************//**
+ * @file
+ * @brief Secure Answers over Cached CoAPS Sessions
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#ifndef COAP_SECURE_H_
+#define COAP_SECURE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <openthread/coap.h>
+
+#include "base_station_config.h"
+
+/*
+ * Secure answers. A remote runs one DTLS handshake, PSK
+ * COAP_SECURE_PSK_IDENTITY, with the CoAPS endpoint on
+ * OT_DEFAULT_COAP_SECURE_PORT and POSTs COAP_SECURE_SESSION_URI there. The
+ * 2.01 carries a session:
+ *
+ *   session id u32, key 16 bytes, ticket COAP_SECURE_TICKET_SIZE bytes
+ *
+ * and the remote closes the connection. OpenThread's CoAPS endpoint serves
+ * one DTLS session at a time, so a handshake per answer would serialize the
+ * whole classroom behind it. Answers rather go to COAP_SECURE_ANSWER_URI on
+ * the plain server, sealed with AES-128-CCM under the session key:
+ *
+ *   session id u32, sequence u32, answer payload, tag 8 bytes
+ *
+ * The nonce is the session id and the sequence number, the header and the
+ * Uri-Query options, i.e. the press stamp, are authenticated with the answer.
+ * Sequence numbers start at 1 and only go up, a 32 number window takes them
+ * out of order. The remote is the one the session was issued to, not whoever
+ * the packet claims to come from.
+ *
+ * The base station keeps COAP_SECURE_SESSIONS session keys, least recently
+ * used out first, and 8 bytes per remote id so that a session can come back.
+ * An answer on a session that isn't cached gets 4.01 and the remote resumes
+ * with a POST to COAP_SECURE_RESUME_URI on the plain server:
+ *
+ *   ticket, sequence u32, tag 8 bytes
+ *
+ * with the tag sealing nothing under the session key over the ticket and the
+ * sequence number. The ticket is the session sealed under a key drawn at boot,
+ * so the base station needn't remember it. Only the latest session of a
+ * remote resumes, at its last sequence number, so old answers can't be
+ * replayed through an old ticket. A 4.01 to the resume means a new handshake:
+ * the ticket is older than COAP_SECURE_TICKET_LIFETIME_S, the base station has
+ * reset since, or the remote lost its id in the registry.
+ *
+ * The acknowledgments to sealed answers are the plain ones of coap_server.h,
+ * they say what happened to an answer but are not authenticated.
+ */
+
+#define COAP_SECURE_SESSION_URI   "session"             // on the CoAPS endpoint
+#define COAP_SECURE_RESUME_URI    "session/resume"
+#define COAP_SECURE_ANSWER_URI    "question/sealed"
+
+#define COAP_SECURE_KEY_SIZE      16u
+#define COAP_SECURE_TAG_SIZE      8u
+#define COAP_SECURE_HEADER_SIZE   8u                    // session id and sequence
+#define COAP_SECURE_TICKET_SIZE   (4u + 32u + COAP_SECURE_TAG_SIZE)
+
+typedef enum {
+  COAP_SECURE_OPENED,         // authentic and fresh, the payload is the answer
+  COAP_SECURE_UNKNOWN,        // no such session cached, 4.01
+  COAP_SECURE_REJECTED,       // forged, malformed or replayed, 4.00
+} coap_secure_result_t;
+
+typedef struct {
+  uint32_t  handshakes;       // sessions issued over DTLS
+  uint32_t  held_ms;          // DTLS connections from handshake done to closed, summed
+  uint32_t  held_max_ms;
+  uint32_t  aborted;          // DTLS connections closed without a session issued
+  uint32_t  resumed;
+  uint32_t  resume_failed;    // sent back to the handshake
+  uint32_t  hits;             // sealed answers on a cached session
+  uint32_t  misses;           // on an unknown one
+  uint32_t  evicted;
+  uint32_t  rejected;         // failed authentication
+  uint32_t  replayed;
+  uint16_t  cached;           // sessions in the cache now
+  uint16_t  session_bytes;    // RAM per cached session, 8 more per remote id
+} coap_secure_stats_t;
+
+// starts the CoAPS endpoint and registers the resume resource on the running
+// coap server; called again on a return to leader, only the resources are
+// registered again and the sessions, tickets and endpoint are kept
+otError coap_secure_init(otInstance *aInstance);
+
+// called from the main loop, closes DTLS sessions that take too long
+void coap_secure_process(void);
+
+// opens a sealed answer in place, on COAP_SECURE_OPENED the answer is left at
+// the start of the payload, its length in aLength and the interface identifier
+// of the remote that sealed it in aIid
+coap_secure_result_t coap_secure_open(const otMessage *aMessage, uint8_t *aPayload, uint16_t *aLength,
+                                      const uint8_t **aIid);
+
+// drops every cached session, remotes resume from their tickets
+void coap_secure_flush(void);
+
+const coap_secure_stats_t *coap_secure_get_stats(void);
+void coap_secure_reset_stats(void);
+
+// little-endian dump for diag/secure, returns the length or 0 if size is short
+size_t coap_secure_export(uint8_t *buffer, size_t size);
+
+#define COAP_SECURE_EXPORT_SIZE   (1 + 3 * 2 + 11 * 4)
+
+#endif /* COAP_SECURE_H_ */
@@ -39,15 +39,60 @@
 #include <string.h>
 #include "printf.h"
 
+#define LOG_MODULE  COAP
+#include "logging.h"
+
+#include "coap_server.h"
 #include "gui.h"
 #include "gui_event_queue.h"
+#include "gui_trace.h"
+#include "tally.h"
+#include "coap_diag.h"
+#include "coap_results.h"
+#include "question_publish.h"
+#include "roster.h"
+#include "prof.h"
+#include "buffer_pressure.h"
+#include "vote_journal.h"
+#include "results_stream.h"
+#include "answer_time.h"
+#include "remote_registry.h"
+#include "coap_secure.h"
 #include "sl_simple_led_instances.h"
 
 static otCoapResource   mResource;
 static char*            uri_path        = "question/answer";
+static otCoapResource   rank_resource;
+static char*            rank_uri_path   = "question/rank";
+static otCoapResource   answered_resource;
+static char*            answered_uri_path = "question/answered";
+#if COAP_SECURE_ENABLE
+static otCoapResource   sealed_resource;
+#endif
 static uint8_t          attr_state[256] = {0};
 
 static void coap_server_handler(void *aContext, otMessage *aMessage, const otMessageInfo *aMessageInfo);
+#if COAP_SECURE_ENABLE
+static void sealed_handler(void *aContext, otMessage *aMessage, const otMessageInfo *aMessageInfo);
+#endif
+static bool reject_under_pressure(otInstance *aInstance, otMessage *aMessage, const otMessageInfo *aMessageInfo,
+                                  buffer_pressure_level_t aLevel);
+static void record_answer(otInstance *aInstance, otMessage *aMessage, const otMessageInfo *aMessageInfo,
+                          const uint8_t *aIid, const char *aData, uint16_t aLength, uint32_t aTimeUs,
+                          uint32_t aCreated, buffer_pressure_level_t aLevel);
+static void rank_handler(void *aContext, otMessage *aMessage, const otMessageInfo *aMessageInfo);
+static void answered_handler(void *aContext, otMessage *aMessage, const otMessageInfo *aMessageInfo);
+static otError send_response(otInstance *aInstance, otMessage *aRequest, const otMessageInfo *aMessageInfo,
+                             otCoapCode aCode, uint32_t aMaxAge, const uint8_t *aPayload, uint16_t aLength);
+static coap_ack_policy_t ack_policy(const otMessage *aMessage, coap_ack_policy_t aDefault);
+static otError send_answer_ack(otInstance *aInstance, otMessage *aRequest, const otMessageInfo *aMessageInfo,
+                               coap_answer_status_t aStatus, uint16_t aId, buffer_pressure_level_t aLevel);
+
+static const char * const ack_queries[COAP_ACK_POLICY_COUNT] = {
+  [COAP_ACK_EMPTY]  = "ack=empty",
+  [COAP_ACK_STATUS] = "ack=status",
+  [COAP_ACK_FULL]   = "ack=full",
+};
 
 otError coap_server_init(otInstance *aInstance)
 {
@@ -55,8 +100,8 @@ otError coap_server_init(otInstance *aInstance)
 
   // start coap server
   error = otCoapStart(aInstance, OT_DEFAULT_COAP_PORT);
-  printf("coap server start: %s\r\n", otThreadErrorToString(error));
   if(error) {
+      LOG_ERR("coap server start: %s\r\n", otThreadErrorToString(error));
       goto exit;
   }
 
@@ -67,6 +112,36 @@ otError coap_server_init(otInstance *aInstance)
 
   otCoapAddResource(aInstance, &mResource);
 
+  rank_resource.mUriPath = rank_uri_path;
+  rank_resource.mHandler = &rank_handler;
+  rank_resource.mContext = aInstance;
+
+  otCoapAddResource(aInstance, &rank_resource);
+
+  answered_resource.mUriPath = answered_uri_path;
+  answered_resource.mHandler = &answered_handler;
+  answered_resource.mContext = aInstance;
+
+  otCoapAddResource(aInstance, &answered_resource);
+
+#if COAP_SECURE_ENABLE
+  sealed_resource.mUriPath = COAP_SECURE_ANSWER_URI;
+  sealed_resource.mHandler = &sealed_handler;
+  sealed_resource.mContext = aInstance;
+
+  otCoapAddResource(aInstance, &sealed_resource);
+
+  // the CoAPS endpoint the sessions come from
+  coap_secure_init(aInstance);
+#endif
+
+  // diagnostics, the roster, the results and the question start share the
+  // server
+  coap_diag_init(aInstance);
+  roster_coap_init(aInstance);
+  coap_results_init(aInstance);
+  question_publish_coap_init(aInstance);
+
 exit:
   return error;
 }
@@ -74,42 +149,31 @@ exit:
 
 static void coap_server_handler(void *aContext, otMessage *aMessage, const otMessageInfo *aMessageInfo)
 {
+  // before anything else, queueing on the base station doesn't count
+  uint64_t   delivered    = answer_time_now();
+  uint32_t   created      = gui_trace_now();
   otError    error        = OT_ERROR_NONE;
 
   otCoapCode message_code = otCoapMessageGetCode(aMessage);
-  otCoapType message_type = otCoapMessageGetType(aMessage);
 
-  otMessage  *response_message;
+  buffer_pressure_level_t level;
 
-  gui_event_t gui_event = {
-      .flag = 0,
-      .msg  = {0},
-  };
+  PROF_BEGIN(PROF_STAGE_COAP);
 
-  response_message = otCoapNewMessage((otInstance *)aContext, NULL);
+  level = buffer_pressure_sample();
 
-  // set up response message
-  otCoapMessageInitResponse(response_message, aMessage, OT_COAP_TYPE_ACKNOWLEDGMENT, OT_COAP_CODE_CHANGED);
-
-  // message set token
-  otCoapMessageSetToken(response_message, otCoapMessageGetToken(aMessage), otCoapMessageGetTokenLength(aMessage));
-
-  // set payload marker
-  otCoapMessageSetPayloadMarker(response_message);
+  if(reject_under_pressure((otInstance *)aContext, aMessage, aMessageInfo, level))
+  {
+      goto exit;
+  }
 
   if(OT_COAP_CODE_GET == message_code)
   {
-      error = otMessageAppend(response_message, attr_state, strlen((const char*) attr_state));
-      printf("coap server get response append: %s\r\n", otThreadErrorToString(error));
-      if(error)
-      {
-          goto exit;
-      }
-
-      error = otCoapSendResponse((otInstance *)aContext, response_message, aMessageInfo);
-      printf("coap server send get response: %s\r\n", otThreadErrorToString(error));
+      error = send_response((otInstance *)aContext, aMessage, aMessageInfo, OT_COAP_CODE_CHANGED, 0,
+                            attr_state, (uint16_t)strlen((const char*) attr_state));
       if(error)
       {
+          LOG_WRN("coap server send get response: %s\r\n", otThreadErrorToString(error));
           goto exit;
       }
   }
@@ -120,38 +184,384 @@ static void coap_server_handler(void *aContext, otMessage *aMessage, const otMes
       uint16_t read   = otMessageRead(aMessage, offset, data, sizeof(data) - 1);
       data[read]      = '\0';
 
-      char ipaddr[OT_IP6_ADDRESS_STRING_SIZE];
+#if COAP_SECURE_ENABLE && COAP_SECURE_REQUIRED
+      // plain answers don't count, the remote has to get a session
+      if(OT_COAP_TYPE_CONFIRMABLE == otCoapMessageGetType(aMessage))
+      {
+          send_response((otInstance *)aContext, aMessage, aMessageInfo, OT_COAP_CODE_UNAUTHORIZED, 0, NULL, 0);
+      }
+      goto exit;
+#endif
+
+      // remotes are told apart by the lower half of their address
+      record_answer((otInstance *)aContext, aMessage, aMessageInfo, &aMessageInfo->mPeerAddr.mFields.m8[8],
+                    data, read, answer_time_stamp(aMessage, delivered), created, level);
+  }
+
+exit:
+  PROF_END(PROF_STAGE_COAP);
+}
+
+#if COAP_SECURE_ENABLE
+/*
+ * question/sealed
+ *
+ * POST an answer sealed under a session, see coap_secure.h, acknowledged like
+ * a plain one. 4.01 when the session isn't cached, the remote resumes it or
+ * runs a new handshake, 4.00 when it isn't authentic or was seen before.
+ */
+static void sealed_handler(void *aContext, otMessage *aMessage, const otMessageInfo *aMessageInfo)
+{
+  uint64_t              delivered = answer_time_now();
+  uint32_t              created   = gui_trace_now();
+  otCoapType            type      = otCoapMessageGetType(aMessage);
+  uint8_t               data[256];
+  uint16_t              read;
+  const uint8_t         *iid      = NULL;
+  coap_secure_result_t  result;
 
-      otIp6AddressToString(&aMessageInfo->mPeerAddr, ipaddr, OT_IP6_ADDRESS_STRING_SIZE);
+  buffer_pressure_level_t level;
+
+  PROF_BEGIN(PROF_STAGE_COAP);
+
+  level = buffer_pressure_sample();
+
+  if(reject_under_pressure((otInstance *)aContext, aMessage, aMessageInfo, level))
+  {
+      goto exit;
+  }
+
+  if(otCoapMessageGetCode(aMessage) != OT_COAP_CODE_POST)
+  {
+      coap_diag_respond(aContext, aMessage, aMessageInfo, OT_COAP_CODE_METHOD_NOT_ALLOWED, NULL, 0);
+      goto exit;
+  }
 
-      gui_event.flag = GUI_EVENT_FLAG_LOG;
-      snprintf((char *)gui_event.msg, GUI_EVENT_MSG_SIZE, "[coap] *%s", (char *) &(data[8]));
-      ring_buffer_add(&gui_event_queue, &gui_event);
+  read   = otMessageRead(aMessage, otMessageGetOffset(aMessage), data, sizeof(data) - 1);
+  result = coap_secure_open(aMessage, data, &read, &iid);
 
-      // led indication of msg received
-      sl_led_toggle(&sl_led_led0);
+  switch(result) {
+    case COAP_SECURE_OPENED:
+      data[read] = '\0';
+      record_answer((otInstance *)aContext, aMessage, aMessageInfo, iid, (const char *)data, read,
+                    answer_time_stamp(aMessage, delivered), created, level);
+      break;
 
-      if(OT_COAP_TYPE_CONFIRMABLE == message_type)
+    case COAP_SECURE_UNKNOWN:
+      if(OT_COAP_TYPE_CONFIRMABLE == type)
       {
-          error = otMessageAppend(response_message, attr_state, strlen((const char*) attr_state));
-          printf("coap server confirmable response: %s\r\n", otThreadErrorToString(error));
-          if(error)
+          send_response((otInstance *)aContext, aMessage, aMessageInfo, OT_COAP_CODE_UNAUTHORIZED, 0, NULL, 0);
+      }
+      break;
+
+    default:
+      if(OT_COAP_TYPE_CONFIRMABLE == type)
+      {
+          send_response((otInstance *)aContext, aMessage, aMessageInfo, OT_COAP_CODE_BAD_REQUEST, 0, NULL, 0);
+      }
+      break;
+  }
+
+exit:
+  PROF_END(PROF_STAGE_COAP);
+}
+#endif
+
+/*
+ * Out of buffers, turn confirmable requests away before doing any work, the
+ * remote asks again after Max-Age. True if the request was turned away.
+ */
+static bool reject_under_pressure(otInstance *aInstance, otMessage *aMessage, const otMessageInfo *aMessageInfo,
+                                  buffer_pressure_level_t aLevel)
+{
+  otError error;
+
+  if(aLevel < BUFFER_PRESSURE_REJECT || OT_COAP_TYPE_CONFIRMABLE != otCoapMessageGetType(aMessage))
+  {
+      return false;
+  }
+
+  buffer_pressure_count_rejected();
+
+  error = send_response(aInstance, aMessage, aMessageInfo, OT_COAP_CODE_SERVICE_UNAVAILABLE,
+                        BUFFER_PRESSURE_MAX_AGE_S, NULL, 0);
+  if(error)
+  {
+      LOG_WRN("coap server send reject: %s\r\n", otThreadErrorToString(error));
+  }
+
+  return true;
+}
+
+/*
+ * Count an answer from the remote with that interface identifier, the answer
+ * is the ninth byte of the payload, and acknowledge it. aCreated is the
+ * gui_trace_now() tick the request came in, the results view is timed from it.
+ */
+static void record_answer(otInstance *aInstance, otMessage *aMessage, const otMessageInfo *aMessageInfo,
+                          const uint8_t *aIid, const char *aData, uint16_t aLength, uint32_t aTimeUs,
+                          uint32_t aCreated, buffer_pressure_level_t aLevel)
+{
+  coap_answer_status_t  status = COAP_ANSWER_INVALID;
+  uint16_t              id     = REMOTE_ID_NONE;
+  otError               error;
+
+  // count the vote, the results view picks it up on its next frame, the
+  // registry turns the interface identifier into a dense id
+  if(aLength > 8)
+  {
+      sl_status_t result = remote_registry_add(aIid, tally_answered(), &id);
+
+      if(result == SL_STATUS_OK)
+      {
+          result = tally_record_at(id, aData[8], aTimeUs);
+      }
+
+      switch(result) {
+        case SL_STATUS_OK:
+          status = COAP_ANSWER_ACCEPTED;
+          gui_trace_vote(aCreated);
+#if VOTE_JOURNAL_ENABLE
+          // buffered only, flash is written from the main loop
+          vote_journal_append(id, aData[8]);
+#endif
+#if RESULTS_STREAM_ENABLE
+          results_stream_vote(aIid, aData[8], aTimeUs);
+#endif
+          break;
+
+        case SL_STATUS_FULL:
+          status = COAP_ANSWER_FULL;
+          break;
+
+        default:
+          break;
+      }
+  }
+
+  // led indication of msg received
+  sl_led_toggle(&sl_led_led0);
+
+  if(OT_COAP_TYPE_CONFIRMABLE == otCoapMessageGetType(aMessage))
+  {
+      error = send_answer_ack(aInstance, aMessage, aMessageInfo, status, id, aLevel);
+      if(error)
+      {
+          LOG_WRN("coap server send confirm response: %s\r\n", otThreadErrorToString(error));
+      }
+  }
+}
+
+/*
+ * question/rank
+ *
+ * GET returns the question id and TALLY_TOP_K, then per answer choice the
+ * number of ranked remotes and for each, fastest first, its interface
+ * identifier and its answer time in us since the question started, u32
+ * little-endian. TALLY_NO_TIME marks answers without a time, i.e. replayed
+ * from the journal.
+ */
+static void rank_handler(void *aContext, otMessage *aMessage, const otMessageInfo *aMessageInfo)
+{
+  static uint8_t  payload[2 + TALLY_CHOICE_COUNT * (1 + TALLY_TOP_K * (TALLY_IID_SIZE + 4))];
+  tally_rank_t    ranks[TALLY_TOP_K];
+  uint8_t         *p = payload;
+  uint8_t         count;
+
+  if(otCoapMessageGetCode(aMessage) != OT_COAP_CODE_GET)
+  {
+      coap_diag_respond(aContext, aMessage, aMessageInfo, OT_COAP_CODE_METHOD_NOT_ALLOWED, NULL, 0);
+      return;
+  }
+
+  *p++ = tally_question();
+  *p++ = TALLY_TOP_K;
+
+  for(uint8_t c = 0; c < TALLY_CHOICE_COUNT; c++)
+  {
+      count = tally_fastest(c, ranks, TALLY_TOP_K);
+      *p++  = count;
+
+      for(uint8_t i = 0; i < count; i++)
+      {
+          const uint8_t *iid = remote_registry_iid(ranks[i].id);
+
+          if(iid != NULL)
           {
-              goto exit;
+              memcpy(p, iid, TALLY_IID_SIZE);
           }
+          else
+          {
+              // replayed from the journal for an id whose registry write
+              // didn't make it before the reset
+              memset(p, 0, TALLY_IID_SIZE);
+          }
+          p = coap_diag_put_u32(p + TALLY_IID_SIZE, ranks[i].time);
+      }
+  }
+
+  coap_diag_respond(aContext, aMessage, aMessageInfo, OT_COAP_CODE_CONTENT, payload, (uint16_t)(p - payload));
+}
+
+/*
+ * question/answered
+ *
+ * GET returns the question id, the number of remote ids handed out, u16
+ * little-endian, and a bitmap with a bit per id, id n at bit n % 8 of byte
+ * n / 8, set for the remotes that answered the question. The remotes still
+ * to answer are the clear bits, their interface identifiers are in the order
+ * of the ids and don't change until the registry is cleared.
+ */
+static void answered_handler(void *aContext, otMessage *aMessage, const otMessageInfo *aMessageInfo)
+{
+  static uint8_t  payload[3 + REMOTE_REGISTRY_WORDS * 4];
+  const uint32_t  *answered = tally_answered();
+  uint16_t        ids       = remote_registry_count();
+  uint8_t         *p        = payload;
+
+  if(otCoapMessageGetCode(aMessage) != OT_COAP_CODE_GET)
+  {
+      coap_diag_respond(aContext, aMessage, aMessageInfo, OT_COAP_CODE_METHOD_NOT_ALLOWED, NULL, 0);
+      return;
+  }
+
+  *p++ = tally_question();
+  p    = coap_diag_put_u16(p, ids);
+
+  for(uint16_t i = 0; i < (ids + 7u) / 8u; i++)
+  {
+      *p++ = (uint8_t)(answered[i / 4u] >> (8u * (i % 4u)));
+  }
+
+  coap_diag_respond(aContext, aMessage, aMessageInfo, OT_COAP_CODE_CONTENT, payload, (uint16_t)(p - payload));
+}
+
+/*
+ * Acknowledge an answer as the remote asked, or with the default policy. Under
+ * buffer pressure the receipt is all the remote gets.
+ */
+static otError send_answer_ack(otInstance *aInstance, otMessage *aRequest, const otMessageInfo *aMessageInfo,
+                               coap_answer_status_t aStatus, uint16_t aId, buffer_pressure_level_t aLevel)
+{
+  coap_ack_policy_t policy = ack_policy(aRequest, COAP_ANSWER_ACK_POLICY);
+  uint8_t           status[4];
+
+  if(aLevel >= BUFFER_PRESSURE_LEAN)
+  {
+      policy = COAP_ACK_EMPTY;
+  }
+
+  switch(policy) {
+    case COAP_ACK_EMPTY:
+      return send_response(aInstance, aRequest, aMessageInfo,
+                           (aStatus == COAP_ANSWER_ACCEPTED) ? OT_COAP_CODE_CHANGED : OT_COAP_CODE_BAD_REQUEST,
+                           0, NULL, 0);
+
+    case COAP_ACK_STATUS:
+      status[0] = (uint8_t)aStatus;
+      status[1] = tally_question();
+      coap_diag_put_u16(&status[2], aId);
+      return send_response(aInstance, aRequest, aMessageInfo, OT_COAP_CODE_CHANGED, 0, status, sizeof(status));
+
+    default:
+      return send_response(aInstance, aRequest, aMessageInfo, OT_COAP_CODE_CHANGED, 0,
+                           attr_state, (uint16_t)strlen((const char*) attr_state));
+  }
+}
+
+/*
+ * The first "ack=" Uri-Query the server knows decides, anything else is
+ * ignored.
+ */
+static coap_ack_policy_t ack_policy(const otMessage *aMessage, coap_ack_policy_t aDefault)
+{
+  otCoapOptionIterator  iterator;
+  const otCoapOption    *option;
+  char                  query[16];
+
+  if(otCoapOptionIteratorInit(&iterator, aMessage) != OT_ERROR_NONE)
+  {
+      return aDefault;
+  }
+
+  for(option = otCoapOptionIteratorGetFirstOptionMatching(&iterator, OT_COAP_OPTION_URI_QUERY);
+      option != NULL;
+      option = otCoapOptionIteratorGetNextOptionMatching(&iterator, OT_COAP_OPTION_URI_QUERY))
+  {
+      if(option->mLength >= sizeof(query) || otCoapOptionIteratorGetOptionValue(&iterator, query) != OT_ERROR_NONE)
+      {
+          continue;
+      }
+      query[option->mLength] = '\0';
 
-          error = otCoapSendResponse((otInstance *)aContext, response_message, aMessageInfo);
-          printf("coap server send confirm response: %s\r\n", otThreadErrorToString(error));
-          if(error)
+      for(uint32_t i = 0; i < COAP_ACK_POLICY_COUNT; i++)
+      {
+          if(strcmp(query, ack_queries[i]) == 0)
           {
-              goto exit;
+              return (coap_ack_policy_t)i;
           }
       }
   }
 
+  return aDefault;
+}
+
+/*
+ * Piggybacked response, a Max-Age of 0 leaves the option out and so does an
+ * empty payload with the payload marker.
+ */
+static otError send_response(otInstance *aInstance, otMessage *aRequest, const otMessageInfo *aMessageInfo,
+                             otCoapCode aCode, uint32_t aMaxAge, const uint8_t *aPayload, uint16_t aLength)
+{
+  otError   error = OT_ERROR_NONE;
+  otMessage *response_message;
+
+  // the response is only allocated once it is known to be sent
+  response_message = otCoapNewMessage(aInstance, NULL);
+  if(response_message == NULL)
+  {
+      return OT_ERROR_NO_BUFS;
+  }
+
+  // set up response message
+  error = otCoapMessageInitResponse(response_message, aRequest, OT_COAP_TYPE_ACKNOWLEDGMENT, aCode);
+  if(error)
+  {
+      goto exit;
+  }
+
+  if(aMaxAge > 0)
+  {
+      error = otCoapMessageAppendMaxAgeOption(response_message, aMaxAge);
+      if(error)
+      {
+          goto exit;
+      }
+  }
+
+  if(aLength > 0)
+  {
+      // set payload marker
+      error = otCoapMessageSetPayloadMarker(response_message);
+      if(error)
+      {
+          goto exit;
+      }
+
+      error = otMessageAppend(response_message, aPayload, aLength);
+      if(error)
+      {
+          goto exit;
+      }
+  }
+
+  error = otCoapSendResponse(aInstance, response_message, aMessageInfo);
+
 exit:
-  if(error != OT_ERROR_NONE && response_message != NULL)
+  if(error != OT_ERROR_NONE)
   {
       otMessageFree(response_message);
   }
+
+  return error;
 }
@@ -37,6 +37,24 @@
 #ifndef COAP_SERVER_H_
 #define COAP_SERVER_H_
 
+/*
+ * What a confirmable answer is acknowledged with. The remote picks one with a
+ * "ack=empty", "ack=status" or "ack=full" Uri-Query, otherwise
+ * COAP_ANSWER_ACK_POLICY applies.
+ */
+typedef enum {
+  COAP_ACK_EMPTY,     // no payload, 2.04 if counted, 4.00 if not
+  COAP_ACK_STATUS,    // 2.04 with a coap_answer_status_t byte, the question id and the remote id, u16 LE
+  COAP_ACK_FULL,      // 2.04 with the whole attr_state, as before
+  COAP_ACK_POLICY_COUNT
+} coap_ack_policy_t;
+
+typedef enum {
+  COAP_ANSWER_ACCEPTED,
+  COAP_ANSWER_INVALID,  // no answer or not a choice
+  COAP_ANSWER_FULL,     // no room for another remote in the tally
+} coap_answer_status_t;
+
 otError coap_server_init(otInstance *aInstance);
 
 #endif /* COAP_SERVER_H_ */
@@ -0,0 +1,199 @@
+/***************************************************************************//**
+ * @file
+ * @brief Asynchronous Display Flush over DMA
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+/*
+ * GLIB keeps rendering into the DMD framebuffer (back buffer). A flush copies
+ * it into a front buffer already laid out as a memory LCD update command and
+ * hands that to DMADRV, so the main loop goes back to the radio stack while
+ * the frame is clocked out. The GUI draws incrementally, so the back buffer
+ * can't be swapped out for a stale one: the copy is the swap.
+ */
+
+#include <string.h>
+
+#include "em_device.h"
+#include "em_gpio.h"
+#include "em_usart.h"
+#include "dmadrv.h"
+#include "dmd.h"
+#include "sl_udelay.h"
+
+#include "sl_component_catalog.h"
+#ifdef SL_CATALOG_POWER_MANAGER_PRESENT
+#include "sl_power_manager.h"
+#endif
+
+#include "sl_memlcd_usart_config.h"
+
+#include "display_flush.h"
+
+#define DISPLAY_WIDTH             128u
+#define DISPLAY_HEIGHT            128u
+
+// row stride of the DMD framebuffer
+#define DISPLAY_FB_STRIDE         (DISPLAY_WIDTH / 8u)
+
+#define MEMLCD_CMD_UPDATE         0x01u
+#define MEMLCD_LINE_SIZE          (1u + DISPLAY_FB_STRIDE + 1u)     // address, data, dummy
+#define MEMLCD_FRAME_SIZE         (1u + DISPLAY_HEIGHT * MEMLCD_LINE_SIZE + 1u)
+
+// LS013B7DH03 chip select timing, as the SDK memlcd driver waits them out
+#define MEMLCD_SETUP_US           6u      // cs high to the first clock edge
+#define MEMLCD_HOLD_US            2u      // last clock edge to cs low
+
+#ifndef DISPLAY_FLUSH_DMA_SIGNAL
+#define DISPLAY_FLUSH_DMA_SIGNAL  dmadrvPeripheralSignal_USART1_TXBL
+#endif
+
+static  uint8_t                 front_buffer[MEMLCD_FRAME_SIZE];
+static  uint8_t*                back_buffer;
+static  unsigned int            dma_channel;
+static  volatile bool           busy;
+static  display_flush_done_t    done_callback;
+
+static bool dma_complete(unsigned int channel, unsigned int sequenceNo, void *userParam)
+{
+  (void)channel;
+  (void)sequenceNo;
+  (void)userParam;
+
+  // DMA is done once the last byte is in the shift register, wait for it
+  while(!(SL_MEMLCD_SPI_PERIPHERAL->STATUS & USART_STATUS_TXC));
+  sl_udelay_wait(MEMLCD_HOLD_US);
+
+  GPIO_PinOutClear(SL_MEMLCD_SPI_CS_PORT, SL_MEMLCD_SPI_CS_PIN);
+
+#ifdef SL_CATALOG_POWER_MANAGER_PRESENT
+  sl_power_manager_remove_em_requirement(SL_POWER_MANAGER_EM1);
+#endif
+
+  busy = false;
+
+  if(done_callback != NULL)
+  {
+      done_callback();
+  }
+
+  return true;
+}
+
+sl_status_t display_flush_init(display_flush_done_t on_done)
+{
+  uint8_t *line;
+  Ecode_t ecode;
+
+  done_callback = on_done;
+  busy          = false;
+
+  // render into a framebuffer we know the address of
+  if(DMD_allocateFramebuffer((void **)&back_buffer) != DMD_OK)
+  {
+      return SL_STATUS_ALLOCATION_FAILED;
+  }
+
+  DMD_selectFramebuffer(back_buffer);
+
+  // the radio stack may have brought DMADRV up already
+  ecode = DMADRV_Init();
+  if(ecode != ECODE_EMDRV_DMADRV_OK && ecode != ECODE_EMDRV_DMADRV_ALREADY_INITIALIZED)
+  {
+      return SL_STATUS_FAIL;
+  }
+
+  if(DMADRV_AllocateChannel(&dma_channel, NULL) != ECODE_EMDRV_DMADRV_OK)
+  {
+      return SL_STATUS_NO_MORE_RESOURCE;
+  }
+
+  // command, line addresses and trailers never change
+  memset(front_buffer, 0, sizeof(front_buffer));
+  front_buffer[0] = MEMLCD_CMD_UPDATE;
+
+  for(uint32_t row = 0; row < DISPLAY_HEIGHT; row++)
+  {
+      line    = &front_buffer[1 + row * MEMLCD_LINE_SIZE];
+      line[0] = (uint8_t)(row + 1);
+  }
+
+  return SL_STATUS_OK;
+}
+
+sl_status_t display_flush_start(void)
+{
+  uint8_t *line;
+
+  if(busy)
+  {
+      return SL_STATUS_BUSY;
+  }
+
+  // copy the rendered rows in between the line headers
+  for(uint32_t row = 0; row < DISPLAY_HEIGHT; row++)
+  {
+      line = &front_buffer[1 + row * MEMLCD_LINE_SIZE];
+      memcpy(&line[1], &back_buffer[row * DISPLAY_FB_STRIDE], DISPLAY_FB_STRIDE);
+  }
+
+  busy = true;
+
+#ifdef SL_CATALOG_POWER_MANAGER_PRESENT
+  // DMA and USART stop below EM1
+  sl_power_manager_add_em_requirement(SL_POWER_MANAGER_EM1);
+#endif
+
+  GPIO_PinOutSet(SL_MEMLCD_SPI_CS_PORT, SL_MEMLCD_SPI_CS_PIN);
+  sl_udelay_wait(MEMLCD_SETUP_US);
+
+  if(DMADRV_MemoryPeripheral(dma_channel, DISPLAY_FLUSH_DMA_SIGNAL,
+                             (void *)&SL_MEMLCD_SPI_PERIPHERAL->TXDATA, front_buffer, true,
+                             sizeof(front_buffer), dmadrvDataSize1,
+                             dma_complete, NULL) != ECODE_EMDRV_DMADRV_OK)
+  {
+      GPIO_PinOutClear(SL_MEMLCD_SPI_CS_PORT, SL_MEMLCD_SPI_CS_PIN);
+#ifdef SL_CATALOG_POWER_MANAGER_PRESENT
+      sl_power_manager_remove_em_requirement(SL_POWER_MANAGER_EM1);
+#endif
+      busy = false;
+      return SL_STATUS_FAIL;
+  }
+
+  return SL_STATUS_OK;
+}
+
+bool display_flush_busy(void)
+{
+  return busy;
+}
@@ -0,0 +1,56 @@
+/***************************************************************************//**
+ * @file
+ * @brief Asynchronous Display Flush Header
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#ifndef DISPLAY_FLUSH_H_
+#define DISPLAY_FLUSH_H_
+
+#include <stdbool.h>
+#include "sl_status.h"
+
+// called from interrupt context once the panel shows the flushed frame
+typedef void (*display_flush_done_t)(void);
+
+// init, takes over the DMD framebuffer that GLIB renders into (back buffer)
+sl_status_t display_flush_init(display_flush_done_t on_done);
+
+// snapshot the back buffer into the front buffer and start clocking it out,
+// returns SL_STATUS_BUSY while the previous frame is still in flight
+sl_status_t display_flush_start(void);
+
+// true while a frame is being transferred
+bool display_flush_busy(void);
+
+#endif /* DISPLAY_FLUSH_H_ */
@@ -0,0 +1,360 @@
+/***************************************************************************//**
+ * @file
+ * @brief Deferred Logging
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#include <string.h>
+
+#include "sl_sleeptimer.h"
+#include "openthread-system.h"
+#include "printf.h"
+
+#if DLOG_OUTPUT_BINARY
+#include "sl_iostream.h"
+#endif
+
+#include "dlog.h"
+
+#if RESULTS_STREAM_ENABLE
+#include "results_stream.h"
+#endif
+
+#if DLOG_OUTPUT_BINARY && RESULTS_STREAM_ENABLE
+#error "DLOG_OUTPUT_BINARY and RESULTS_STREAM_ENABLE both want the UART"
+#endif
+
+#define RING_MASK         (DLOG_RING_SIZE - 1u)
+#define TEXT_RECORD       ((const char *)0)
+
+#define FRAME_SYNC        0xA5u
+#define FRAME_FORMAT      0x00u
+#define FRAME_TEXT        0x01u
+#define FRAME_DROPPED     0x02u
+
+typedef struct {
+  volatile uint32_t seq;          // slot ownership, see dlog_write()
+  const char*       fmt;          // TEXT_RECORD for preformatted lines
+  uint32_t          tick;
+  uint32_t          nargs;
+  uintptr_t         args[DLOG_MAX_ARGS];
+} dlog_record_t;
+
+static  dlog_record_t     ring[DLOG_RING_SIZE];
+static  uint32_t          head;             // next slot to claim, shared by producers
+static  uint32_t          tail;             // next slot to drain, main loop only
+static  volatile uint32_t dropped;
+static  uint32_t          dropped_reported;
+
+static  char              text[DLOG_TEXT_SLOTS][DLOG_TEXT_SIZE];
+static  volatile bool     text_busy[DLOG_TEXT_SLOTS];
+
+_Static_assert((DLOG_RING_SIZE & RING_MASK) == 0, "DLOG_RING_SIZE must be a power of two");
+
+void dlog_init(void)
+{
+  // slot n is free for the producer that claims position n
+  for(uint32_t i = 0; i < DLOG_RING_SIZE; i++)
+  {
+      ring[i].seq = i;
+  }
+
+  head             = 0;
+  tail             = 0;
+  dropped          = 0;
+  dropped_reported = 0;
+  memset((void *)text_busy, 0, sizeof(text_busy));
+}
+
+/*
+ * Bounded multi-producer ring: a producer claims a position with a CAS on
+ * head, fills the slot and publishes it by setting seq to position + 1. The
+ * consumer frees it again with seq = position + DLOG_RING_SIZE.
+ */
+static dlog_record_t* claim(void)
+{
+  dlog_record_t *record;
+  uint32_t      pos = __atomic_load_n(&head, __ATOMIC_RELAXED);
+  int32_t       diff;
+
+  for(;;)
+  {
+      record = &ring[pos & RING_MASK];
+      diff   = (int32_t)(__atomic_load_n(&record->seq, __ATOMIC_ACQUIRE) - pos);
+
+      if(diff == 0)
+      {
+          if(__atomic_compare_exchange_n(&head, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+          {
+              return record;
+          }
+      }
+      else if(diff < 0)
+      {
+          // full, the oldest record hasn't been drained yet
+          __atomic_fetch_add(&dropped, 1, __ATOMIC_RELAXED);
+          return NULL;
+      }
+      else
+      {
+          pos = __atomic_load_n(&head, __ATOMIC_RELAXED);
+      }
+  }
+}
+
+static void publish(dlog_record_t *record, uint32_t pos)
+{
+  __atomic_store_n(&record->seq, pos + 1, __ATOMIC_RELEASE);
+  otSysEventSignalPending();
+}
+
+void dlog_write(const char *fmt, uint32_t nargs, ...)
+{
+  va_list       ap;
+  dlog_record_t *record = claim();
+
+  if(record == NULL)
+  {
+      return;
+  }
+
+  record->fmt   = fmt;
+  record->tick  = sl_sleeptimer_get_tick_count();
+  record->nargs = (nargs < DLOG_MAX_ARGS) ? nargs : DLOG_MAX_ARGS;
+
+  va_start(ap, nargs);
+  for(uint32_t i = 0; i < record->nargs; i++)
+  {
+      record->args[i] = va_arg(ap, uintptr_t);
+  }
+  va_end(ap);
+
+  // seq still holds the claimed position
+  publish(record, record->seq);
+}
+
+void dlog_vprintf(const char *fmt, va_list ap)
+{
+  dlog_record_t *record;
+  uint32_t      slot;
+
+  for(slot = 0; slot < DLOG_TEXT_SLOTS; slot++)
+  {
+      if(!text_busy[slot])
+      {
+          break;
+      }
+  }
+
+  if(slot == DLOG_TEXT_SLOTS)
+  {
+      __atomic_fetch_add(&dropped, 1, __ATOMIC_RELAXED);
+      return;
+  }
+
+  record = claim();
+  if(record == NULL)
+  {
+      return;
+  }
+
+  text_busy[slot] = true;
+  vsnprintf(text[slot], DLOG_TEXT_SIZE, fmt, ap);
+
+  record->fmt     = TEXT_RECORD;
+  record->tick    = sl_sleeptimer_get_tick_count();
+  record->nargs   = 1;
+  record->args[0] = slot;
+
+  publish(record, record->seq);
+}
+
+#if DLOG_OUTPUT_BINARY
+static void output_u32(uint8_t *p, uint32_t value)
+{
+  p[0] = (uint8_t)(value);
+  p[1] = (uint8_t)(value >> 8);
+  p[2] = (uint8_t)(value >> 16);
+  p[3] = (uint8_t)(value >> 24);
+}
+
+/*
+ * Frames, little endian:
+ *   sync 0xA5, type u8, tick u32, then
+ *   format:  format address u32, nargs u8, args u32[nargs]
+ *   text:    length u8, characters
+ *   dropped: total dropped u32
+ */
+static void output(const dlog_record_t *record)
+{
+  uint8_t frame[6 + 5 + 4 * DLOG_MAX_ARGS + DLOG_TEXT_SIZE];
+  size_t  length = 6;
+
+  frame[0] = FRAME_SYNC;
+  output_u32(&frame[2], record->tick);
+
+  if(record->fmt == TEXT_RECORD)
+  {
+      const char *line = text[record->args[0]];
+      uint8_t    size  = (uint8_t)strnlen(line, DLOG_TEXT_SIZE);
+
+      frame[1]        = FRAME_TEXT;
+      frame[length++] = size;
+      memcpy(&frame[length], line, size);
+      length += size;
+  }
+  else
+  {
+      frame[1] = FRAME_FORMAT;
+      output_u32(&frame[length], (uint32_t)(uintptr_t)record->fmt);
+      length += 4;
+      frame[length++] = (uint8_t)record->nargs;
+
+      for(uint32_t i = 0; i < record->nargs; i++)
+      {
+          output_u32(&frame[length], (uint32_t)record->args[i]);
+          length += 4;
+      }
+  }
+
+  sl_iostream_write(SL_IOSTREAM_STDOUT, frame, length);
+}
+
+static void output_dropped(uint32_t total)
+{
+  uint8_t frame[10];
+
+  frame[0] = FRAME_SYNC;
+  frame[1] = FRAME_DROPPED;
+  output_u32(&frame[2], sl_sleeptimer_get_tick_count());
+  output_u32(&frame[6], total);
+
+  sl_iostream_write(SL_IOSTREAM_STDOUT, frame, sizeof(frame));
+}
+#elif RESULTS_STREAM_ENABLE
+// console lines travel as log frames, a raw line would corrupt the stream
+static void output(const dlog_record_t *record)
+{
+  char            line[DLOG_TEXT_SIZE];
+  const uintptr_t *a = record->args;
+  int             length;
+
+  if(record->fmt == TEXT_RECORD)
+  {
+      results_stream_log(text[a[0]], strnlen(text[a[0]], DLOG_TEXT_SIZE));
+      return;
+  }
+
+  length = snprintf(line, sizeof(line), record->fmt, a[0], a[1], a[2], a[3]);
+  if(length > 0)
+  {
+      results_stream_log(line, ((size_t)length < sizeof(line)) ? (size_t)length : sizeof(line) - 1);
+  }
+}
+
+static void output_dropped(uint32_t total)
+{
+  char line[40];
+  int  length = snprintf(line, sizeof(line), "[dlog] %lu records dropped", (unsigned long)total);
+
+  results_stream_log(line, (size_t)length);
+}
+#else
+static void output(const dlog_record_t *record)
+{
+  const uintptr_t *a = record->args;
+
+  if(record->fmt == TEXT_RECORD)
+  {
+      printf("%s\r\n", text[a[0]]);
+      return;
+  }
+
+  // unused arguments are passed as zero and ignored by printf
+  printf(record->fmt, a[0], a[1], a[2], a[3]);
+}
+
+static void output_dropped(uint32_t total)
+{
+  printf("[dlog] %lu records dropped\r\n", (unsigned long)total);
+}
+#endif
+
+void dlog_process(void)
+{
+  dlog_record_t *record;
+  uint32_t      lost;
+
+  for(uint32_t n = 0; n < DLOG_DRAIN_MAX; n++)
+  {
+      record = &ring[tail & RING_MASK];
+
+      if(__atomic_load_n(&record->seq, __ATOMIC_ACQUIRE) != tail + 1)
+      {
+          break;
+      }
+
+      // clear what this record didn't set so the printf varargs are defined
+      for(uint32_t i = record->nargs; i < DLOG_MAX_ARGS; i++)
+      {
+          record->args[i] = 0;
+      }
+
+      output(record);
+
+      if(record->fmt == TEXT_RECORD)
+      {
+          text_busy[record->args[0]] = false;
+      }
+
+      __atomic_store_n(&record->seq, tail + DLOG_RING_SIZE, __ATOMIC_RELEASE);
+      tail++;
+  }
+
+  lost = dropped;
+  if(lost != dropped_reported)
+  {
+      output_dropped(lost);
+      dropped_reported = lost;
+  }
+}
+
+bool dlog_pending(void)
+{
+  return __atomic_load_n(&ring[tail & RING_MASK].seq, __ATOMIC_ACQUIRE) == tail + 1;
+}
+
+uint32_t dlog_dropped(void)
+{
+  return dropped;
+}
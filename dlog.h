@@ -0,0 +1,90 @@
+/***************************************************************************//**
+ * @file
+ * @brief Deferred Logging Header
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#ifndef DLOG_H_
+#define DLOG_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdarg.h>
+
+#include "base_station_config.h"
+
+/*
+ * Deferred logging. DLOG() stores the format string pointer and up to
+ * DLOG_MAX_ARGS raw arguments in a lock-free ring, formatting and UART output
+ * happen in dlog_process() from the main loop.
+ *
+ * Arguments must be integers or pointers to strings that outlive the record,
+ * like string literals or the otThreadErrorToString() results. Anything on the
+ * stack has to be formatted on the spot, see dlog_vprintf().
+ */
+
+#define DLOG_MAX_ARGS   4u
+
+#define DLOG(...)                   DLOG_(__VA_ARGS__)
+#define DLOG_(fmt, ...)             dlog_write(fmt, DLOG_NARGS(__VA_ARGS__) \
+                                               DLOG_CAT(DLOG_CAST_, DLOG_NARGS(__VA_ARGS__))(__VA_ARGS__))
+
+#define DLOG_NARGS(...)             DLOG_NARGS_(0, ##__VA_ARGS__, 4, 3, 2, 1, 0)
+#define DLOG_NARGS_(_0, _1, _2, _3, _4, n, ...) n
+#define DLOG_CAT(a, b)              DLOG_CAT_(a, b)
+#define DLOG_CAT_(a, b)             a##b
+#define DLOG_CAST_0()
+#define DLOG_CAST_1(a)              , (uintptr_t)(a)
+#define DLOG_CAST_2(a, b)           , (uintptr_t)(a), (uintptr_t)(b)
+#define DLOG_CAST_3(a, b, c)        , (uintptr_t)(a), (uintptr_t)(b), (uintptr_t)(c)
+#define DLOG_CAST_4(a, b, c, d)     , (uintptr_t)(a), (uintptr_t)(b), (uintptr_t)(c), (uintptr_t)(d)
+
+void dlog_init(void);
+
+// record a format and nargs uintptr_t arguments, safe from interrupt context
+void dlog_write(const char *fmt, uint32_t nargs, ...);
+
+// format a line now and output it later, for va_lists and transient strings,
+// the line ending is added on output, main loop only
+void dlog_vprintf(const char *fmt, va_list ap);
+
+// write out up to DLOG_DRAIN_MAX records, called from the main loop
+void dlog_process(void);
+
+// records waiting to be written out
+bool dlog_pending(void);
+
+// records lost because the ring or the text slots were full
+uint32_t dlog_dropped(void);
+
+#endif /* DLOG_H_ */
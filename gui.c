@@ -42,20 +42,37 @@
 
 // platform includes
 #include "sl_simple_button_instances.h"
+#include "openthread-system.h"
 #include "printf.h"
 
+#define LOG_MODULE  GUI
+#include "logging.h"
+
 #include "gui.h"
 #include "gui_event_queue.h"
+#include "gui_trace.h"
+#include "display_flush.h"
+#include "tally.h"
 
 // local functions
 static  void display_init(void);
+static  void display_flush_done(void);
 static  void draw_button(const button_t* button, bool pressed);
+static  void draw_log(void);
+static  void draw_results(bool force);
 
 // local vars
 static  char                     log_buffer[LOG_BUFFER_LEN][DISPLAY_LOG_MAX_STR_LEN + 1];
 static  uint8_t                  log_index;
 static  const GLIB_Rectangle_t   log_window = {0, 55, 127, 98};
 
+static  const GLIB_Rectangle_t   results_window = {0, 55, 127, 98};
+static  gui_view_t               view;
+static  uint16_t                 drawn_counts[TALLY_CHOICE_COUNT];
+static  uint16_t                 drawn_responded;
+static  uint16_t                 drawn_remotes;
+static  uint32_t                 drawn_version;
+
 static  GLIB_Context_t           glib_context;
 static  bool                     update_display;
 
@@ -68,6 +85,9 @@ static void display_init(void)
   // initialize dot matrix display driver
   DMD_init(0);
 
+  // render into a back buffer, flush the front buffer over dma
+  display_flush_init(display_flush_done);
+
   // get glib handle
   GLIB_contextInit(&glib_context);
 
@@ -85,6 +105,14 @@ static void display_init(void)
   update_display = true;
 }
 
+static void display_flush_done(void)
+{
+  gui_trace_flush_done();
+
+  // changes made during the flush are waiting for the next frame
+  otSysEventSignalPending();
+}
+
 static void draw_button(const button_t* button, bool pressed)
 {
   int32_t char_x, char_y;
@@ -125,9 +153,136 @@ static void draw_button(const button_t* button, bool pressed)
   update_display = true;
 }
 
+static void draw_log(void)
+{
+  uint8_t temp_ind;
+
+  // clear log area
+  GLIB_setClippingRegion(&glib_context, &log_window);
+  GLIB_clearRegion(&glib_context);
+
+  GLIB_resetClippingRegion(&glib_context);
+  GLIB_resetDisplayClippingArea(&glib_context);
+
+  // reverse print the log buffer to the display, newest entry at the bottom
+  temp_ind = (log_index == 0) ? LOG_BUFFER_LEN - 1 : log_index - 1;
+  for(int8_t x = LOG_BUFFER_LEN - 1; x >= 0; x--)
+  {
+      GLIB_drawStringOnLine(&glib_context, (const char*) &log_buffer[temp_ind],
+                            LOG_LINE + x, GLIB_ALIGN_LEFT,
+                            LOG_OFFSET_X, LOG_OFFSET_Y,
+                            false);
+
+      temp_ind = (temp_ind == 0) ? LOG_BUFFER_LEN - 1 : temp_ind - 1;
+  }
+
+  // mark display update needed
+  update_display = true;
+}
+
+static void draw_result_bar(uint8_t choice, uint16_t count, uint16_t scale)
+{
+  char              temp[8];
+  int32_t           y   = RESULTS_ROW_Y + choice * RESULTS_ROW_HEIGHT;
+  int32_t           len = (int32_t)count * RESULTS_BAR_MAX_LEN / scale;
+  GLIB_Rectangle_t  row = {results_window.xMin, y, results_window.xMax, y + RESULTS_ROW_HEIGHT - 2};
+  GLIB_Rectangle_t  bar = {RESULTS_BAR_X, y + 1, RESULTS_BAR_X + len - 1, y + RESULTS_ROW_HEIGHT - 3};
+
+  // only modify this bar's row
+  GLIB_setClippingRegion(&glib_context, &row);
+  GLIB_clearRegion(&glib_context);
+
+  GLIB_drawChar(&glib_context, (char)('A' + choice), RESULTS_LABEL_X, y, false);
+
+  if(len > 0)
+  {
+      GLIB_drawRectFilled(&glib_context, &bar);
+  }
+
+  snprintf(temp, sizeof(temp), "%3u", count);
+  GLIB_drawString(&glib_context, temp, strlen(temp), RESULTS_COUNT_X, y, false);
+
+  GLIB_resetClippingRegion(&glib_context);
+  GLIB_resetDisplayClippingArea(&glib_context);
+}
+
+static void draw_results(bool force)
+{
+  char              temp[24];
+  uint16_t          count;
+  uint16_t          remotes   = tally_remotes();
+  uint16_t          responded = tally_responded();
+  GLIB_Rectangle_t  line      = {results_window.xMin, RESULTS_RESPONDED_Y,
+                                 results_window.xMax, results_window.yMax};
+
+  if(force)
+  {
+      GLIB_setClippingRegion(&glib_context, &results_window);
+      GLIB_clearRegion(&glib_context);
+      GLIB_resetClippingRegion(&glib_context);
+      GLIB_resetDisplayClippingArea(&glib_context);
+  }
+
+  // bars are scaled to the class size, all of them move when it changes
+  if(remotes != drawn_remotes)
+  {
+      force = true;
+  }
+
+  for(uint8_t choice = 0; choice < TALLY_CHOICE_COUNT; choice++)
+  {
+      count = tally_count(choice);
+
+      if(force || count != drawn_counts[choice])
+      {
+          draw_result_bar(choice, count, remotes ? remotes : 1);
+          drawn_counts[choice] = count;
+      }
+  }
+
+  if(force || responded != drawn_responded)
+  {
+      GLIB_setClippingRegion(&glib_context, &line);
+      GLIB_clearRegion(&glib_context);
+
+      snprintf(temp, sizeof(temp), "responded %u / %u", responded, remotes);
+      GLIB_drawString(&glib_context, temp, strlen(temp), RESULTS_LABEL_X, RESULTS_RESPONDED_Y, false);
+
+      GLIB_resetClippingRegion(&glib_context);
+      GLIB_resetDisplayClippingArea(&glib_context);
+  }
+
+  drawn_responded = responded;
+  drawn_remotes   = remotes;
+  drawn_version   = tally_version();
+
+  gui_trace_votes_drawn();
+
+  // mark display update needed
+  update_display = true;
+}
+
+void gui_set_view(gui_view_t new_view)
+{
+  view = new_view;
+
+  if(view == GUI_VIEW_RESULTS)
+  {
+      draw_results(true);
+  }
+  else
+  {
+      draw_log();
+  }
+}
+
 void gui_init(void)
 {
   log_index = 0;
+  view      = GUI_VIEW_LOG;
+
+  // start counting answers
+  tally_reset();
 
   // initialize event queue
   gui_event_queue_init();
@@ -165,6 +320,9 @@ void gui_update(void)
   sl_status_t status;
   gui_event_t event;
 
+  // the frame that went out since the last pass
+  gui_trace_process();
+
   // read events from the queue
   do {
       status = ring_buffer_get(&gui_event_queue, &event);
@@ -174,7 +332,10 @@ void gui_update(void)
           break;
       }
 
-      printf("\tflag: %u, msg: %s\r\n", event.flag, event.msg);
+      // msg lives on the stack, the deferred log only gets the flag
+      LOG_DBG("\tgui event flag: 0x%x\r\n", event.flag);
+
+      gui_trace_dequeued(event.flag, event.created);
 
       switch(event.flag) {
         case GUI_EVENT_FLAG_BTN0_PRESSED:
@@ -187,6 +348,7 @@ void gui_update(void)
 
         case GUI_EVENT_FLAG_BTN1_PRESSED:
           draw_button(&button_left, true);
+          gui_set_view((view == GUI_VIEW_LOG) ? GUI_VIEW_RESULTS : GUI_VIEW_LOG);
           break;
 
         case GUI_EVENT_FLAG_BTN1_RELEASED:
@@ -213,55 +375,82 @@ void gui_update(void)
           gui_print_log((char *)&event.msg);
           break;
 
+        case GUI_EVENT_FLAG_JOIN:
+          gui_print_join_summary((char *)&event.msg);
+          break;
+
         default:
           break;
       }
 
   } while (status == SL_STATUS_OK);
 
-  // only update when needed
-  if(update_display)
+  // fold every vote since the last frame into one redraw of the changed bars
+  if(view == GUI_VIEW_RESULTS && tally_version() != drawn_version && !display_flush_busy())
+  {
+      draw_results(false);
+  }
+  else if(view != GUI_VIEW_RESULTS)
+  {
+      gui_trace_votes_hidden();
+  }
+
+  // only update when needed, while a frame is in flight the changes
+  // accumulate in the back buffer and go out with the next one
+  if(update_display && !display_flush_busy())
   {
-      DMD_updateDisplay();
-      update_display = false;
+      gui_trace_flush_started();
+
+      if(display_flush_start() == SL_STATUS_OK)
+      {
+          update_display = false;
+      }
+      else
+      {
+          gui_trace_flush_failed();
+      }
+  }
+  else if(!update_display)
+  {
+      // what was taken left the panel as it was, e.g. log lines under the results
+      gui_trace_frame_skipped();
   }
 }
 
 void gui_button_handler(const sl_button_t *handle)
 {
   gui_event_t event = {
-      .flag = 0,
-      .msg  = {0},
+      .flag     = 0,
+      .created  = gui_trace_now(),
+      .msg      = {0},
   };
 
   if (sl_button_get_state(handle) == SL_SIMPLE_BUTTON_PRESSED) {
     if (&sl_button_btn0 == handle) {
         event.flag = GUI_EVENT_FLAG_BTN0_PRESSED;
-        ring_buffer_add(&gui_event_queue, &event);
+        gui_event_queue_add(&event);
     }
 
     if (&sl_button_btn1 == handle) {
         event.flag = GUI_EVENT_FLAG_BTN1_PRESSED;
-        ring_buffer_add(&gui_event_queue, &event);
+        gui_event_queue_add(&event);
     }
   }
   else if (sl_button_get_state(handle) == SL_SIMPLE_BUTTON_RELEASED) {
     if (&sl_button_btn0 == handle) {
         event.flag = GUI_EVENT_FLAG_BTN0_RELEASED;
-        ring_buffer_add(&gui_event_queue, &event);
+        gui_event_queue_add(&event);
     }
 
     if (&sl_button_btn1 == handle) {
         event.flag = GUI_EVENT_FLAG_BTN1_RELEASED;
-        ring_buffer_add(&gui_event_queue, &event);
+        gui_event_queue_add(&event);
     }
   }
 }
 
 void gui_print_log(char *string)
 {
-  uint8_t temp_ind;
-
   // add entry to log buffer
   strncpy((char *)&log_buffer[log_index], string, DISPLAY_LOG_MAX_STR_LEN);
 
@@ -275,30 +464,14 @@ void gui_print_log(char *string)
   // mark last char as empty in the case that string is longer than DISPLAY_LOG_MAX_STR_LEN
   log_buffer[log_index][DISPLAY_LOG_MAX_STR_LEN] = '\0';
 
-  // clear log area
-  GLIB_setClippingRegion(&glib_context, &log_window);
-  GLIB_clearRegion(&glib_context);
-
-  GLIB_resetClippingRegion(&glib_context);
-  GLIB_resetDisplayClippingArea(&glib_context);
-
-  // reverse print the log buffer to the display
-  temp_ind = log_index;
-  for(int8_t x = LOG_BUFFER_LEN - 1; x >= 0; x--)
-  {
-      GLIB_drawStringOnLine(&glib_context, (const char*) &log_buffer[temp_ind],
-                            LOG_LINE + x, GLIB_ALIGN_LEFT,
-                            LOG_OFFSET_X, LOG_OFFSET_Y,
-                            false);
-
-      temp_ind = (temp_ind == 0) ? 3 : temp_ind - 1;
-  }
-
   // increment and loop around log index
   log_index = (log_index + 1) % LOG_BUFFER_LEN;
 
-  // mark display update needed
-  update_display = true;
+  // the results view owns the log area, keep the entry for later
+  if(view == GUI_VIEW_LOG)
+  {
+      draw_log();
+  }
 }
 
 void gui_print_network_name(char *string)
@@ -379,6 +552,32 @@ void gui_print_device_role(char *string)
   update_display = true;
 }
 
+void gui_print_join_summary(char *string)
+{
+  char temp[20];
+
+  // blank line
+  memset(&temp, ' ', 20);
+  temp[19] = '\0';
+
+  GLIB_drawStringOnLine(&glib_context, temp,
+                            JOIN_INFO_LINE, GLIB_ALIGN_LEFT,
+                            THREAD_INFO_OFFSET_X, THREAD_INFO_OFFSET_Y,
+                            true);
+
+  // print commissioning summary
+  snprintf((char *)&temp, 20, "%s", string);
+  temp[19] = '\0';
+
+  GLIB_drawStringOnLine(&glib_context, temp,
+                          JOIN_INFO_LINE, GLIB_ALIGN_LEFT,
+                          THREAD_INFO_OFFSET_X, THREAD_INFO_OFFSET_Y,
+                          false);
+
+  // mark display update needed
+  update_display = true;
+}
+
 void gui_print_mac_addr(char *mac_addr)
 {
   char temp[20];
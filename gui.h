@@ -46,11 +46,21 @@
 #define THREAD_INFO_OFFSET_X      2
 #define THREAD_INFO_OFFSET_Y      4
 
+#define JOIN_INFO_LINE            4
+
 #define LOG_LINE                  6
 #define LOG_OFFSET_X              2
 #define LOG_OFFSET_Y              0
 #define LOG_BUFFER_LEN            4
 
+#define RESULTS_ROW_Y             56
+#define RESULTS_ROW_HEIGHT        9
+#define RESULTS_LABEL_X           2
+#define RESULTS_BAR_X             12
+#define RESULTS_BAR_MAX_LEN       88
+#define RESULTS_COUNT_X           104
+#define RESULTS_RESPONDED_Y       91
+
 #define ADDR_LINE                 10
 #define ADDR_OFFSET_X             0
 #define ADDR_OFFSET_Y             3
@@ -72,6 +82,11 @@ typedef struct {
   char              name;
 } button_t;
 
+typedef enum {
+  GUI_VIEW_LOG,
+  GUI_VIEW_RESULTS,
+} gui_view_t;
+
 typedef struct {
   uint32_t          event;
   char              info[32];
@@ -86,6 +101,8 @@ void gui_print_network_name(char *string);
 void gui_print_network_channel(char *ch);
 void gui_print_device_role(char *string);
 void gui_print_mac_addr(char *mac_str);
+void gui_print_join_summary(char *string);
+void gui_set_view(gui_view_t view);
 
 
 #endif /* GUI_H_ */
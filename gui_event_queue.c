@@ -34,16 +34,21 @@
  * Silicon Labs may update projects from time to time.
  ******************************************************************************/
 
+#include "em_core.h"
+#include "openthread-system.h"
+
 #include "ring_buffer.h"
 #include "gui_event_queue.h"
+#include "gui_trace.h"
 
 #define EVENT_QUEUE_BUFFER_SIZE 16
 
 static gui_event_t gui_events[EVENT_QUEUE_BUFFER_SIZE];
 static void*       buffer[EVENT_QUEUE_BUFFER_SIZE];
+static bool        log_muted;
 
 ring_buffer_handle_t  gui_event_queue = {
-    .buffer   = &buffer,
+    .buffer   = buffer,
     .head     = 0,
     .tail     = 0,
     .size     = sizeof(gui_event_t),
@@ -63,3 +68,35 @@ sl_status_t gui_event_queue_init(void)
 
   return error;
 }
+
+sl_status_t gui_event_queue_add(gui_event_t *event)
+{
+  sl_status_t error;
+
+  if(log_muted && event->flag == GUI_EVENT_FLAG_LOG)
+  {
+      return SL_STATUS_OK;
+  }
+
+  // producers that don't time their events from creation
+  if(event->created == 0)
+  {
+      event->created = gui_trace_now();
+  }
+
+  // button interrupts and the main loop both produce events
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+  error = ring_buffer_add(&gui_event_queue, event);
+  CORE_EXIT_ATOMIC();
+
+  // let the main loop know there is something to draw
+  otSysEventSignalPending();
+
+  return error;
+}
+
+void gui_event_queue_set_log_muted(bool muted)
+{
+  log_muted = muted;
+}
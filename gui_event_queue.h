@@ -53,8 +53,11 @@
 
 #define GUI_EVENT_FLAG_LOG              (1 << 8)
 
+#define GUI_EVENT_FLAG_JOIN             (1 << 9)   // commissioning summary line
+
 typedef struct {
   uint32_t  flag;
+  uint32_t  created;    // gui_trace_now() tick, stamped on add if 0
   char      msg[GUI_EVENT_MSG_SIZE];
 } gui_event_t;
 
@@ -62,4 +65,10 @@ extern ring_buffer_handle_t gui_event_queue;
 
 sl_status_t gui_event_queue_init(void);
 
+// add an event and wake the main loop, safe to call from interrupt context
+sl_status_t gui_event_queue_add(gui_event_t *event);
+
+// drop GUI_EVENT_FLAG_LOG events while muted, see buffer_pressure.h
+void gui_event_queue_set_log_muted(bool muted);
+
 #endif /* GUI_EVENT_QUEUE_H_ */
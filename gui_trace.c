@@ -0,0 +1,287 @@
+/***************************************************************************//**
+ * @file
+ * @brief Event to Panel Latency Tracing for the Base Station GUI
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "sl_sleeptimer.h"
+
+#include "gui_trace.h"
+#include "gui_event_queue.h"
+#include "coap_diag_codec.h"
+
+#define GUI_TRACE_EXPORT_VERSION  1u
+#define GUI_TRACE_BUCKET_US       64u     // upper end of bucket 0
+
+typedef struct {
+  uint8_t   kind;
+  uint32_t  created;      // ticks
+  uint32_t  dequeued;
+} traced_t;
+
+typedef struct {
+  traced_t  events[GUI_TRACE_FRAME_EVENTS];
+  uint32_t  count;
+  uint32_t  started;      // ticks, flush start
+} frame_t;
+
+static gui_trace_kind_t kind_of(uint32_t flag);
+static void taken(gui_trace_kind_t kind, uint32_t created);
+static void fold_flight(void);
+static void record(gui_trace_kind_t kind, gui_trace_stage_t stage, uint32_t ticks);
+
+static  gui_trace_stats_t   stats;
+static  frame_t             drawn;          // in the back buffer, waiting for a frame
+static  frame_t             flight;         // in the frame being flushed
+static  volatile bool       flush_done;
+static  volatile uint32_t   flush_done_at;
+static  bool                vote_pending;
+static  uint32_t            vote_created;
+
+void gui_trace_reset(void)
+{
+  memset(&stats, 0, sizeof(stats));
+}
+
+uint32_t gui_trace_now(void)
+{
+  return sl_sleeptimer_get_tick_count();
+}
+
+void gui_trace_dequeued(uint32_t flag, uint32_t created)
+{
+  gui_trace_kind_t kind = kind_of(flag);
+
+  if(kind < GUI_TRACE_KIND_COUNT)
+  {
+      taken(kind, created);
+  }
+}
+
+void gui_trace_vote(uint32_t created)
+{
+  if(!vote_pending)
+  {
+      vote_pending = true;
+      vote_created = created;
+  }
+}
+
+void gui_trace_votes_drawn(void)
+{
+  if(vote_pending)
+  {
+      vote_pending = false;
+      taken(GUI_TRACE_KIND_VOTE, vote_created);
+  }
+}
+
+void gui_trace_votes_hidden(void)
+{
+  // timed from when the view comes back they would measure the teacher
+  vote_pending = false;
+}
+
+void gui_trace_flush_started(void)
+{
+  // no flush is in flight, the last one completed or there was none
+  fold_flight();
+
+  flight          = drawn;
+  flight.started  = gui_trace_now();
+  drawn.count     = 0;
+}
+
+void gui_trace_flush_failed(void)
+{
+  // back to waiting, they go out with the next frame
+  drawn         = flight;
+  flight.count  = 0;
+}
+
+void gui_trace_flush_done(void)
+{
+  flush_done_at = gui_trace_now();
+  flush_done    = true;
+}
+
+void gui_trace_frame_skipped(void)
+{
+  drawn.count = 0;
+}
+
+void gui_trace_process(void)
+{
+  fold_flight();
+}
+
+const gui_trace_stats_t *gui_trace_get(void)
+{
+  return &stats;
+}
+
+/*
+ * Little endian, one header followed by a record per kind and stage, kinds
+ * and stages in gui_trace.h order:
+ *   header: version u8, kind count u8, stage count u8, bucket count u8, untraced u32
+ *   record: count u32, mean us u32, max us u32, buckets u16[bucket count]
+ * Bucket counts saturate at 0xFFFF.
+ */
+size_t gui_trace_export(uint8_t *buffer, size_t size)
+{
+  uint8_t                 *p = buffer;
+  const gui_trace_hist_t  *hist;
+
+  if(size < GUI_TRACE_EXPORT_SIZE)
+  {
+      return 0;
+  }
+
+  *p++ = GUI_TRACE_EXPORT_VERSION;
+  *p++ = GUI_TRACE_KIND_COUNT;
+  *p++ = GUI_TRACE_STAGE_COUNT;
+  *p++ = GUI_TRACE_BUCKETS;
+  p    = coap_diag_put_u32(p, stats.untraced);
+
+  for(uint32_t k = 0; k < GUI_TRACE_KIND_COUNT; k++)
+  {
+      for(uint32_t s = 0; s < GUI_TRACE_STAGE_COUNT; s++)
+      {
+          hist = &stats.hist[k][s];
+
+          p = coap_diag_put_u32(p, hist->count);
+          p = coap_diag_put_u32(p, hist->count ? (uint32_t)(hist->sum_us / hist->count) : 0);
+          p = coap_diag_put_u32(p, hist->max_us);
+          for(uint32_t b = 0; b < GUI_TRACE_BUCKETS; b++)
+          {
+              p = coap_diag_put_u16(p, (hist->buckets[b] > 0xFFFFu) ? 0xFFFFu : (uint16_t)hist->buckets[b]);
+          }
+      }
+  }
+
+  return (size_t)(p - buffer);
+}
+
+static gui_trace_kind_t kind_of(uint32_t flag)
+{
+  switch(flag) {
+    case GUI_EVENT_FLAG_BTN0_PRESSED:
+    case GUI_EVENT_FLAG_BTN0_RELEASED:
+    case GUI_EVENT_FLAG_BTN1_PRESSED:
+    case GUI_EVENT_FLAG_BTN1_RELEASED:
+      return GUI_TRACE_KIND_BUTTON;
+
+    case GUI_EVENT_FLAG_NTWK_NAME:
+    case GUI_EVENT_FLAG_NTWK_CH:
+    case GUI_EVENT_FLAG_NTWK_ADDR:
+    case GUI_EVENT_FLAG_NTWK_ROLE:
+      return GUI_TRACE_KIND_NETWORK;
+
+    case GUI_EVENT_FLAG_LOG:
+      return GUI_TRACE_KIND_LOG;
+
+    case GUI_EVENT_FLAG_JOIN:
+      return GUI_TRACE_KIND_JOIN;
+
+    default:
+      return GUI_TRACE_KIND_COUNT;
+  }
+}
+
+// drawn into the back buffer from here on, timed again when its frame goes out
+static void taken(gui_trace_kind_t kind, uint32_t created)
+{
+  uint32_t now = gui_trace_now();
+
+  record(kind, GUI_TRACE_STAGE_WAIT, now - created);
+
+  if(drawn.count >= GUI_TRACE_FRAME_EVENTS)
+  {
+      stats.untraced++;
+      return;
+  }
+
+  drawn.events[drawn.count].kind      = (uint8_t)kind;
+  drawn.events[drawn.count].created   = created;
+  drawn.events[drawn.count].dequeued  = now;
+  drawn.count++;
+}
+
+static void fold_flight(void)
+{
+  uint32_t          done_at;
+  gui_trace_kind_t  kind;
+
+  if(!flush_done)
+  {
+      return;
+  }
+
+  done_at     = flush_done_at;
+  flush_done  = false;
+
+  // all stages at once, a frame that failed to start goes back to waiting
+  for(uint32_t i = 0; i < flight.count; i++)
+  {
+      kind = (gui_trace_kind_t)flight.events[i].kind;
+
+      record(kind, GUI_TRACE_STAGE_RENDER, flight.started - flight.events[i].dequeued);
+      record(kind, GUI_TRACE_STAGE_FLUSH, done_at - flight.started);
+      record(kind, GUI_TRACE_STAGE_TOTAL, done_at - flight.events[i].created);
+  }
+
+  flight.count = 0;
+}
+
+static void record(gui_trace_kind_t kind, gui_trace_stage_t stage, uint32_t ticks)
+{
+  gui_trace_hist_t  *hist   = &stats.hist[kind][stage];
+  uint32_t          us      = (uint32_t)(((uint64_t)ticks * 1000000u) / sl_sleeptimer_get_timer_frequency());
+  uint32_t          bucket  = 0;
+
+  while(bucket < GUI_TRACE_BUCKETS - 1u && us >= (GUI_TRACE_BUCKET_US << bucket))
+  {
+      bucket++;
+  }
+
+  hist->count++;
+  hist->sum_us += us;
+  hist->buckets[bucket]++;
+  if(us > hist->max_us)
+  {
+      hist->max_us = us;
+  }
+}
@@ -0,0 +1,122 @@
+/***************************************************************************//**
+ * @file
+ * @brief Event to Panel Latency Tracing for the Base Station GUI
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#ifndef GUI_TRACE_H_
+#define GUI_TRACE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "base_station_config.h"
+
+/*
+ * Latency of GUI events from where they are created to the panel. Events
+ * carry the sleeptimer tick of their creation through the event queue, votes
+ * don't go through the queue and are timed from the oldest one the results
+ * view hasn't drawn yet. Each event is timed again when gui_update() takes
+ * it, when the frame it was drawn into starts to flush and when that flush
+ * completes, the stages go into log2 histograms per event kind. Events drawn
+ * while GUI_TRACE_FRAME_EVENTS are already waiting for a frame only count
+ * toward the queue wait.
+ */
+
+typedef enum {
+  GUI_TRACE_KIND_BUTTON,    // btn0 and btn1 presses and releases
+  GUI_TRACE_KIND_NETWORK,   // name, channel, address and role from the stack
+  GUI_TRACE_KIND_LOG,       // log lines
+  GUI_TRACE_KIND_JOIN,      // commissioning summary
+  GUI_TRACE_KIND_VOTE,      // counted answers, through the tally
+  GUI_TRACE_KIND_COUNT
+} gui_trace_kind_t;
+
+typedef enum {
+  GUI_TRACE_STAGE_WAIT,     // created to taken by gui_update
+  GUI_TRACE_STAGE_RENDER,   // taken to its frame starting to flush
+  GUI_TRACE_STAGE_FLUSH,    // frame flush start to completion
+  GUI_TRACE_STAGE_TOTAL,    // created to on the panel
+  GUI_TRACE_STAGE_COUNT
+} gui_trace_stage_t;
+
+#define GUI_TRACE_BUCKETS   16u   // bucket n holds [2^(n-1), 2^n) * 64 us, the last is open ended
+
+typedef struct {
+  uint32_t  count;
+  uint32_t  max_us;
+  uint64_t  sum_us;
+  uint32_t  buckets[GUI_TRACE_BUCKETS];
+} gui_trace_hist_t;
+
+typedef struct {
+  gui_trace_hist_t  hist[GUI_TRACE_KIND_COUNT][GUI_TRACE_STAGE_COUNT];
+  uint32_t          untraced;     // drawn with the frame table full, queue wait only
+} gui_trace_stats_t;
+
+void gui_trace_reset(void);
+
+// sleeptimer tick to stamp events with, safe to call from interrupt context
+uint32_t gui_trace_now(void);
+
+// an event with that GUI_EVENT_FLAG_* taken from the queue by gui_update
+void gui_trace_dequeued(uint32_t flag, uint32_t created);
+
+// an answer counted, only the oldest one not drawn yet is timed
+void gui_trace_vote(uint32_t created);
+
+// the results view drew the counted answers, or isn't shown and won't
+void gui_trace_votes_drawn(void);
+void gui_trace_votes_hidden(void);
+
+// the back buffer is about to go out, called before display_flush_start()
+// since the flush may complete before it returns, and failed if it didn't
+// start; done is safe to call from interrupt context and folded in by the
+// next gui_trace_process()
+void gui_trace_flush_started(void);
+void gui_trace_flush_failed(void);
+void gui_trace_flush_done(void);
+
+// nothing taken since the last frame changed the panel, they only count
+// toward queue wait
+void gui_trace_frame_skipped(void);
+void gui_trace_process(void);
+
+const gui_trace_stats_t *gui_trace_get(void);
+
+// little-endian dump for diag/gui, returns the length or 0 if size is short
+size_t gui_trace_export(uint8_t *buffer, size_t size);
+
+#define GUI_TRACE_EXPORT_SIZE (4 + 4 + GUI_TRACE_KIND_COUNT * GUI_TRACE_STAGE_COUNT * (4 + 4 + 4 + 2 * GUI_TRACE_BUCKETS))
+
+#endif /* GUI_TRACE_H_ */
@@ -0,0 +1,115 @@
+/***************************************************************************//**
+ * @file
+ * @brief Host Stand-In for the Asynchronous Display Flush
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#include <string.h>
+
+#include "dmd.h"
+#include "glib_host.h"
+#include "display_flush_host.h"
+
+static  uint8_t                     front_buffer[GLIB_HOST_FRAME_SIZE];
+static  uint8_t*                    back_buffer;
+static  bool                        busy;
+static  bool                        auto_complete = true;
+static  display_flush_done_t        done_callback;
+static  display_flush_host_stats_t  stats;
+
+sl_status_t display_flush_init(display_flush_done_t on_done)
+{
+  done_callback = on_done;
+  busy          = false;
+
+  if(DMD_allocateFramebuffer((void **)&back_buffer) != DMD_OK)
+  {
+      return SL_STATUS_ALLOCATION_FAILED;
+  }
+
+  DMD_selectFramebuffer(back_buffer);
+
+  return SL_STATUS_OK;
+}
+
+sl_status_t display_flush_start(void)
+{
+  if(busy)
+  {
+      stats.rejected++;
+      return SL_STATUS_BUSY;
+  }
+
+  memcpy(front_buffer, back_buffer, sizeof(front_buffer));
+  busy = true;
+  stats.started++;
+
+  if(auto_complete)
+  {
+      display_flush_host_complete();
+  }
+
+  return SL_STATUS_OK;
+}
+
+bool display_flush_busy(void)
+{
+  return busy;
+}
+
+void display_flush_host_complete(void)
+{
+  if(!busy)
+  {
+      return;
+  }
+
+  glib_host_present(front_buffer);
+  busy = false;
+  stats.completed++;
+
+  if(done_callback != NULL)
+  {
+      done_callback();
+  }
+}
+
+void display_flush_host_set_auto_complete(bool enable)
+{
+  auto_complete = enable;
+}
+
+void display_flush_host_stats_get(display_flush_host_stats_t *out)
+{
+  *out = stats;
+}
@@ -0,0 +1,58 @@
+/***************************************************************************//**
+ * @file
+ * @brief Host Stand-In for the Asynchronous Display Flush
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#ifndef DISPLAY_FLUSH_HOST_H_
+#define DISPLAY_FLUSH_HOST_H_
+
+#include <stdint.h>
+
+#include "display_flush.h"
+
+typedef struct {
+  uint32_t  started;      // frames handed to the "dma"
+  uint32_t  completed;    // completion callbacks fired
+  uint32_t  rejected;     // starts refused because a frame was in flight
+} display_flush_host_stats_t;
+
+// simulated dma completion interrupt, presents the in-flight frame
+void display_flush_host_complete(void);
+
+// complete each frame right away, on by default
+void display_flush_host_set_auto_complete(bool enable);
+
+void display_flush_host_stats_get(display_flush_host_stats_t *stats);
+
+#endif /* DISPLAY_FLUSH_HOST_H_ */
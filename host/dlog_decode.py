@@ -0,0 +1,124 @@
+#!/usr/bin/env python3
+#
+# Copyright 2022 Silicon Laboratories Inc. www.silabs.com
+# SPDX-License-Identifier: Zlib
+#
+# Decoder for the binary output of the deferred logger (DLOG_OUTPUT_BINARY).
+#
+# Records carry the address of their format string, so the firmware image is
+# needed to turn them back into text:
+#
+#   dlog_decode.py build/openclicker_basestation.axf capture.bin
+#   dlog_decode.py build/openclicker_basestation.axf /dev/ttyACM0
+#
+# Requires pyelftools.
+
+import re
+import struct
+import sys
+
+from elftools.elf.elffile import ELFFile
+
+FRAME_SYNC      = 0xA5
+FRAME_FORMAT    = 0x00
+FRAME_TEXT      = 0x01
+FRAME_DROPPED   = 0x02
+
+TICK_HZ         = 32768
+
+CONVERSION      = re.compile(r'%([-+ #0]*\d*(?:\.\d+)?)(hh|h|ll|l|L|q|j|z|t)?([diouxXcsp%])')
+
+
+class Image:
+    """Read-only view of the loadable sections of the firmware image."""
+
+    def __init__(self, path):
+        self.sections = []
+        with open(path, 'rb') as f:
+            elf = ELFFile(f)
+            for section in elf.iter_sections():
+                if section['sh_addr'] and section['sh_type'] == 'SHT_PROGBITS':
+                    self.sections.append((section['sh_addr'], section.data()))
+
+    def string(self, address):
+        for base, data in self.sections:
+            if base <= address < base + len(data):
+                end = data.find(b'\0', address - base)
+                return data[address - base:end].decode('utf-8', 'replace')
+        return '<0x%08x>' % address
+
+
+def format_record(image, fmt, args):
+    args = list(args)
+
+    def convert(match):
+        flags, _, kind = match.groups()
+        if kind == '%':
+            return '%'
+        value = args.pop(0) if args else 0
+        if kind == 's':
+            return ('%' + flags + 's') % image.string(value)
+        if kind == 'p':
+            return '0x%08x' % value
+        if kind in 'di' and value & 0x80000000:
+            value -= 1 << 32
+        if kind == 'u':
+            kind = 'd'
+        return ('%' + flags + kind) % value
+
+    return CONVERSION.sub(convert, fmt)
+
+
+def frames(stream):
+    """Yield (type, tick, body) tuples, resynchronising on garbage."""
+    while True:
+        byte = stream.read(1)
+        if not byte:
+            return
+        if byte[0] != FRAME_SYNC:
+            continue
+
+        header = stream.read(5)
+        if len(header) < 5:
+            return
+        kind, tick = header[0], struct.unpack('<I', header[1:])[0]
+
+        if kind == FRAME_FORMAT:
+            head = stream.read(5)
+            address, nargs = struct.unpack('<IB', head)
+            args = struct.unpack('<%dI' % nargs, stream.read(4 * nargs))
+            yield kind, tick, (address, args)
+        elif kind == FRAME_TEXT:
+            length = stream.read(1)[0]
+            yield kind, tick, stream.read(length).decode('utf-8', 'replace')
+        elif kind == FRAME_DROPPED:
+            yield kind, tick, struct.unpack('<I', stream.read(4))[0]
+
+
+def main():
+    if len(sys.argv) != 3:
+        print('usage: dlog_decode.py <image.axf> <capture|tty>', file=sys.stderr)
+        return 2
+
+    image   = Image(sys.argv[1])
+    dropped = 0
+
+    with open(sys.argv[2], 'rb', buffering=0) as stream:
+        for kind, tick, body in frames(stream):
+            stamp = '[%10.4f] ' % (tick / TICK_HZ)
+            if kind == FRAME_FORMAT:
+                address, args = body
+                line = format_record(image, image.string(address), args)
+            elif kind == FRAME_TEXT:
+                line = body
+            else:
+                dropped = body
+                line = '[dlog] %u records dropped' % body
+            print(stamp + line.rstrip('\r\n'), flush=True)
+
+    print('dropped: %u' % dropped, file=sys.stderr)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
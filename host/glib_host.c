@@ -0,0 +1,472 @@
+/***************************************************************************//**
+ * @file
+ * @brief Headless GLIB/DMD Backend for Host Builds
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+/*
+ * Implements the subset of GLIB and DMD used by gui.c over an in-memory 1bpp
+ * framebuffer so that the GUI can be rendered, measured and compared against
+ * golden images on a development machine.
+ *
+ * The glyphs are a deterministic placeholder pattern, not the SDK font. Pixel
+ * and glyph counts match the target since they only depend on the font
+ * geometry, but golden images are only comparable with other host renders.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "glib.h"
+#include "dmd.h"
+#include "glib_host.h"
+
+#define FONT_FIRST_CHAR   0x20
+#define FONT_LAST_CHAR    0x7E
+
+const GLIB_Font_t GLIB_FontNarrow6x8 = {
+    .pFontPixMap      = NULL,
+    .fontRowSize      = 0,
+    .cntOfMapElements = FONT_LAST_CHAR - FONT_FIRST_CHAR + 1,
+    .fontWidth        = 6,
+    .fontHeight       = 8,
+    .lineSpacing      = 2,
+    .charSpacing      = 0,
+};
+
+static  DMD_DisplayGeometry   geometry = {
+    .xSize      = DMD_HOST_DISPLAY_WIDTH,
+    .ySize      = DMD_HOST_DISPLAY_HEIGHT,
+    .xClipStart = 0,
+    .yClipStart = 0,
+    .clipWidth  = DMD_HOST_DISPLAY_WIDTH,
+    .clipHeight = DMD_HOST_DISPLAY_HEIGHT,
+};
+
+static  uint8_t               frame[GLIB_HOST_FRAME_SIZE];    // what glib draws into
+static  uint8_t               panel[GLIB_HOST_FRAME_SIZE];    // what the lcd shows
+static  glib_host_stats_t     stats;
+static  bool                  initialized;
+
+
+/**************************************************************************//**
+ * Framebuffer Helpers
+ *****************************************************************************/
+static inline bool in_rect(const GLIB_Rectangle_t *rect, int32_t x, int32_t y)
+{
+  return (x >= rect->xMin) && (x <= rect->xMax) && (y >= rect->yMin) && (y <= rect->yMax);
+}
+
+static void put_pixel(const GLIB_Context_t *pContext, int32_t x, int32_t y, uint32_t color)
+{
+  uint8_t mask;
+  uint8_t *byte;
+
+  if(!in_rect(&pContext->clippingRegion, x, y))
+  {
+      return;
+  }
+
+  if(x < 0 || y < 0 || x >= DMD_HOST_DISPLAY_WIDTH || y >= DMD_HOST_DISPLAY_HEIGHT)
+  {
+      return;
+  }
+
+  mask = (uint8_t)(0x80u >> (x & 7));
+  byte = &frame[y * GLIB_HOST_FRAME_STRIDE + (x >> 3)];
+
+  // only black is "ink" on a monochrome panel
+  if(color == Black)
+  {
+      *byte |= mask;
+  }
+  else
+  {
+      *byte &= (uint8_t)~mask;
+  }
+
+  stats.pixels++;
+}
+
+static void fill_rect(const GLIB_Context_t *pContext, const GLIB_Rectangle_t *rect, uint32_t color)
+{
+  for(int32_t y = rect->yMin; y <= rect->yMax; y++)
+  {
+      for(int32_t x = rect->xMin; x <= rect->xMax; x++)
+      {
+          put_pixel(pContext, x, y, color);
+      }
+  }
+}
+
+// placeholder glyph column, bit n is row n
+static uint8_t glyph_column(char c, uint8_t column)
+{
+  uint8_t bits;
+
+  if(c == ' ' || column >= 5)
+  {
+      return 0;
+  }
+
+  bits = (uint8_t)(((uint8_t)c * 0x9Du) ^ (column * 0x3Bu) ^ ((uint8_t)c << column));
+  bits &= 0x7F;
+
+  return bits ? bits : 0x41;
+}
+
+
+/**************************************************************************//**
+ * DMD
+ *****************************************************************************/
+EMSTATUS DMD_init(DMD_InitConfig_t *initConfig)
+{
+  (void)initConfig;
+
+  memset(frame, 0, sizeof(frame));
+  memset(panel, 0, sizeof(panel));
+  initialized = true;
+
+  return DMD_OK;
+}
+
+EMSTATUS DMD_getDisplayGeometry(DMD_DisplayGeometry **pGeometry)
+{
+  if(!initialized)
+  {
+      return DMD_ERROR_DRIVER_NOT_INITIALIZED;
+  }
+
+  *pGeometry = &geometry;
+
+  return DMD_OK;
+}
+
+EMSTATUS DMD_updateDisplay(void)
+{
+  if(!initialized)
+  {
+      return DMD_ERROR_DRIVER_NOT_INITIALIZED;
+  }
+
+  memcpy(panel, frame, sizeof(panel));
+  stats.flushes++;
+
+  return DMD_OK;
+}
+
+EMSTATUS DMD_allocateFramebuffer(void **framebuffer)
+{
+  // a single framebuffer on the host
+  *framebuffer = frame;
+
+  return DMD_OK;
+}
+
+EMSTATUS DMD_selectFramebuffer(void *framebuffer)
+{
+  return (framebuffer == frame) ? DMD_OK : DMD_ERROR_DRIVER_NOT_INITIALIZED;
+}
+
+
+/**************************************************************************//**
+ * GLIB
+ *****************************************************************************/
+EMSTATUS GLIB_contextInit(GLIB_Context_t *pContext)
+{
+  EMSTATUS status;
+
+  status = DMD_getDisplayGeometry(&pContext->pDisplayGeometry);
+  if(status != DMD_OK)
+  {
+      return status;
+  }
+
+  pContext->backgroundColor = White;
+  pContext->foregroundColor = Black;
+  pContext->font            = GLIB_FontNarrow6x8;
+
+  return GLIB_resetClippingRegion(pContext);
+}
+
+EMSTATUS GLIB_clear(GLIB_Context_t *pContext)
+{
+  GLIB_Rectangle_t saved = pContext->clippingRegion;
+
+  GLIB_resetClippingRegion(pContext);
+  fill_rect(pContext, &pContext->clippingRegion, pContext->backgroundColor);
+  pContext->clippingRegion = saved;
+
+  return GLIB_OK;
+}
+
+EMSTATUS GLIB_setClippingRegion(GLIB_Context_t *pContext, const GLIB_Rectangle_t *pRect)
+{
+  if(pRect->xMin > pRect->xMax || pRect->yMin > pRect->yMax)
+  {
+      return GLIB_ERROR_INVALID_ARGUMENT;
+  }
+
+  pContext->clippingRegion = *pRect;
+
+  return GLIB_OK;
+}
+
+EMSTATUS GLIB_resetClippingRegion(GLIB_Context_t *pContext)
+{
+  pContext->clippingRegion.xMin = 0;
+  pContext->clippingRegion.yMin = 0;
+  pContext->clippingRegion.xMax = pContext->pDisplayGeometry->xSize - 1;
+  pContext->clippingRegion.yMax = pContext->pDisplayGeometry->ySize - 1;
+
+  return GLIB_OK;
+}
+
+EMSTATUS GLIB_resetDisplayClippingArea(GLIB_Context_t *pContext)
+{
+  // the host display has no hardware clipping area
+  (void)pContext;
+
+  return GLIB_OK;
+}
+
+EMSTATUS GLIB_clearRegion(const GLIB_Context_t *pContext)
+{
+  fill_rect(pContext, &pContext->clippingRegion, pContext->backgroundColor);
+
+  return GLIB_OK;
+}
+
+EMSTATUS GLIB_drawPixel(GLIB_Context_t *pContext, int32_t x, int32_t y)
+{
+  put_pixel(pContext, x, y, pContext->foregroundColor);
+
+  return GLIB_OK;
+}
+
+EMSTATUS GLIB_drawLineH(GLIB_Context_t *pContext, int32_t x1, int32_t y1, int32_t x2)
+{
+  GLIB_Rectangle_t line = {
+      .xMin = (x1 < x2) ? x1 : x2,
+      .yMin = y1,
+      .xMax = (x1 < x2) ? x2 : x1,
+      .yMax = y1,
+  };
+
+  fill_rect(pContext, &line, pContext->foregroundColor);
+
+  return GLIB_OK;
+}
+
+EMSTATUS GLIB_drawLineV(GLIB_Context_t *pContext, int32_t x1, int32_t y1, int32_t y2)
+{
+  GLIB_Rectangle_t line = {
+      .xMin = x1,
+      .yMin = (y1 < y2) ? y1 : y2,
+      .xMax = x1,
+      .yMax = (y1 < y2) ? y2 : y1,
+  };
+
+  fill_rect(pContext, &line, pContext->foregroundColor);
+
+  return GLIB_OK;
+}
+
+EMSTATUS GLIB_drawRect(GLIB_Context_t *pContext, const GLIB_Rectangle_t *pRect)
+{
+  GLIB_drawLineH(pContext, pRect->xMin, pRect->yMin, pRect->xMax);
+  GLIB_drawLineH(pContext, pRect->xMin, pRect->yMax, pRect->xMax);
+  GLIB_drawLineV(pContext, pRect->xMin, pRect->yMin + 1, pRect->yMax - 1);
+  GLIB_drawLineV(pContext, pRect->xMax, pRect->yMin + 1, pRect->yMax - 1);
+
+  return GLIB_OK;
+}
+
+EMSTATUS GLIB_drawRectFilled(GLIB_Context_t *pContext, const GLIB_Rectangle_t *pRect)
+{
+  fill_rect(pContext, pRect, pContext->foregroundColor);
+
+  return GLIB_OK;
+}
+
+EMSTATUS GLIB_drawChar(GLIB_Context_t *pContext, char myChar, int32_t x, int32_t y, bool opaque)
+{
+  uint8_t bits;
+
+  if(myChar < FONT_FIRST_CHAR || myChar > FONT_LAST_CHAR)
+  {
+      return GLIB_ERROR_INVALID_ARGUMENT;
+  }
+
+  for(uint8_t col = 0; col < pContext->font.fontWidth; col++)
+  {
+      bits = glyph_column(myChar, col);
+
+      for(uint8_t row = 0; row < pContext->font.fontHeight; row++)
+      {
+          if(bits & (1u << row))
+          {
+              put_pixel(pContext, x + col, y + row, pContext->foregroundColor);
+          }
+          else if(opaque)
+          {
+              put_pixel(pContext, x + col, y + row, pContext->backgroundColor);
+          }
+      }
+  }
+
+  stats.glyphs++;
+
+  return GLIB_OK;
+}
+
+EMSTATUS GLIB_drawString(GLIB_Context_t *pContext, const char *pString, uint32_t sLength,
+                         int32_t x0, int32_t y0, bool opaque)
+{
+  int32_t advance = pContext->font.fontWidth + pContext->font.charSpacing;
+
+  for(uint32_t i = 0; i < sLength && pString[i] != '\0'; i++)
+  {
+      GLIB_drawChar(pContext, pString[i], x0 + (int32_t)i * advance, y0, opaque);
+  }
+
+  return GLIB_OK;
+}
+
+EMSTATUS GLIB_drawStringOnLine(GLIB_Context_t *pContext, const char *pString, uint8_t line,
+                               GLIB_Align_t align, int32_t xOffset, int32_t yOffset, bool opaque)
+{
+  int32_t x, y;
+  int32_t width = (int32_t)strlen(pString) * (pContext->font.fontWidth + pContext->font.charSpacing);
+
+  y = line * (pContext->font.fontHeight + pContext->font.lineSpacing) + yOffset;
+
+  switch(align) {
+    case GLIB_ALIGN_CENTER:
+      x = (pContext->pDisplayGeometry->xSize - width) / 2 + xOffset;
+      break;
+
+    case GLIB_ALIGN_RIGHT:
+      x = pContext->pDisplayGeometry->xSize - width + xOffset;
+      break;
+
+    case GLIB_ALIGN_LEFT:
+    default:
+      x = xOffset;
+      break;
+  }
+
+  return GLIB_drawString(pContext, pString, (uint32_t)strlen(pString), x, y, opaque);
+}
+
+
+/**************************************************************************//**
+ * Host Helpers
+ *****************************************************************************/
+void glib_host_stats_get(glib_host_stats_t *out)
+{
+  *out = stats;
+}
+
+void glib_host_stats_reset(void)
+{
+  memset(&stats, 0, sizeof(stats));
+}
+
+void glib_host_present(const uint8_t *framebuffer)
+{
+  memcpy(panel, framebuffer, sizeof(panel));
+  stats.flushes++;
+}
+
+const uint8_t* glib_host_panel(void)
+{
+  return panel;
+}
+
+bool glib_host_panel_pixel(int32_t x, int32_t y)
+{
+  if(x < 0 || y < 0 || x >= DMD_HOST_DISPLAY_WIDTH || y >= DMD_HOST_DISPLAY_HEIGHT)
+  {
+      return false;
+  }
+
+  return panel[y * GLIB_HOST_FRAME_STRIDE + (x >> 3)] & (0x80u >> (x & 7));
+}
+
+int glib_host_save_pbm(const char *path)
+{
+  FILE *file = fopen(path, "wb");
+
+  if(file == NULL)
+  {
+      return -1;
+  }
+
+  fprintf(file, "P4\n%d %d\n", DMD_HOST_DISPLAY_WIDTH, DMD_HOST_DISPLAY_HEIGHT);
+  fwrite(panel, 1, sizeof(panel), file);
+  fclose(file);
+
+  return 0;
+}
+
+int glib_host_compare_pbm(const char *path)
+{
+  uint8_t golden[GLIB_HOST_FRAME_SIZE];
+  int     width, height;
+  int     diff = 0;
+  FILE    *file = fopen(path, "rb");
+
+  if(file == NULL)
+  {
+      return -1;
+  }
+
+  if(fscanf(file, "P4 %d %d", &width, &height) != 2
+     || width != DMD_HOST_DISPLAY_WIDTH || height != DMD_HOST_DISPLAY_HEIGHT
+     || fgetc(file) == EOF
+     || fread(golden, 1, sizeof(golden), file) != sizeof(golden))
+  {
+      fclose(file);
+      return -1;
+  }
+
+  fclose(file);
+
+  for(uint32_t i = 0; i < sizeof(golden); i++)
+  {
+      diff += __builtin_popcount((unsigned)(golden[i] ^ panel[i]));
+  }
+
+  return diff;
+}
@@ -0,0 +1,73 @@
+/***************************************************************************//**
+ * @file
+ * @brief Headless GLIB/DMD Backend for Host Builds
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#ifndef GLIB_HOST_H_
+#define GLIB_HOST_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "dmd.h"
+
+#define GLIB_HOST_FRAME_STRIDE    (DMD_HOST_DISPLAY_WIDTH / 8)
+#define GLIB_HOST_FRAME_SIZE      (GLIB_HOST_FRAME_STRIDE * DMD_HOST_DISPLAY_HEIGHT)
+
+typedef struct {
+  uint32_t  pixels;     // pixel writes issued by the glib primitives
+  uint32_t  glyphs;     // characters drawn
+  uint32_t  flushes;    // DMD_updateDisplay() calls
+} glib_host_stats_t;
+
+// counters since the last reset
+void glib_host_stats_get(glib_host_stats_t *stats);
+void glib_host_stats_reset(void);
+
+// show a frame on the panel, for flush drivers other than DMD_updateDisplay()
+void glib_host_present(const uint8_t *framebuffer);
+
+// 1bpp row-major image of the panel as of the last flush, set bit = black
+const uint8_t* glib_host_panel(void);
+
+// panel pixel, true when black
+bool glib_host_panel_pixel(int32_t x, int32_t y);
+
+// golden images are stored as binary PBM (P4)
+int glib_host_save_pbm(const char *path);
+
+// returns the number of differing pixels, or -1 if the golden can't be read
+int glib_host_compare_pbm(const char *path);
+
+#endif /* GLIB_HOST_H_ */
@@ -0,0 +1,426 @@
+/***************************************************************************//**
+ * @file
+ * @brief Host Render Benchmark for the GUI
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+/*
+ * Replays gui_event_t streams through gui_update() on top of the headless
+ * GLIB/DMD backend and reports the cost per event. The final panel can be
+ * written out or compared against a golden image.
+ *
+ * build (from the repository root):
+ *   gcc -O2 -Ihost/include -Ihost -I. -o gui_bench host/gui_bench.c \
+ *       host/glib_host.c host/display_flush_host.c host/sl_button_host.c \
+ *       host/sl_sleeptimer_host.c gui.c gui_event_queue.c gui_trace.c coap_diag_codec.c ring_buffer.c \
+ *       tally.c dlog.c logging.c
+ *
+ * usage:
+ *   gui_bench [-s boot|votes|buttons|results|all] [-f events.txt] [-n repeat]
+ *             [-b batch] [-l flush_latency] [-w out.pbm] [-g golden.pbm]
+ *
+ * The flush latency is the number of gui_update() calls a frame stays in
+ * flight before the simulated dma completion, 0 completes immediately. The
+ * report ends with the gui_trace.h latency per event kind, in sleeptimer
+ * resolution.
+ *
+ * An event file holds one event per line: "<flag> <msg>", where flag is a
+ * GUI_EVENT_FLAG_* value in decimal or 0x hex. Lines starting with '#' are
+ * skipped. Votes don't go through the event queue, they are written as
+ * "0x80000000 <remote> <answer>" and fed to the tally instead.
+ */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "sl_simple_button_instances.h"
+
+#include "gui.h"
+#include "gui_event_queue.h"
+#include "gui_trace.h"
+#include "tally.h"
+#include "dlog.h"
+#include "glib_host.h"
+#include "display_flush_host.h"
+
+#define MAX_EVENTS      4096
+#define BENCH_FLAG_VOTE (1u << 31)
+
+typedef struct {
+  gui_event_t events[MAX_EVENTS];
+  uint32_t    count;
+} event_stream_t;
+
+static event_stream_t stream;
+static int            saved_stdout = -1;
+static uint32_t       flush_latency;
+static uint32_t       flush_age;
+
+// nothing to wake, the benchmark drives the loop itself
+void otSysEventSignalPending(void)
+{
+}
+
+// the gui only forwards buttons, no application to route them to
+void sl_button_on_change(const sl_button_t *handle)
+{
+  gui_button_handler(handle);
+}
+
+static void stream_add(uint32_t flag, const char *msg)
+{
+  gui_event_t *event;
+
+  if(stream.count >= MAX_EVENTS)
+  {
+      return;
+  }
+
+  event = &stream.events[stream.count++];
+  memset(event, 0, sizeof(*event));
+  event->flag = flag;
+  snprintf(event->msg, GUI_EVENT_MSG_SIZE, "%s", msg);
+}
+
+static void scenario_boot(void)
+{
+  stream_add(GUI_EVENT_FLAG_NTWK_NAME, "OpenClicker");
+  stream_add(GUI_EVENT_FLAG_NTWK_CH,   "15");
+  stream_add(GUI_EVENT_FLAG_NTWK_ROLE, "detached");
+  stream_add(GUI_EVENT_FLAG_NTWK_ROLE, "leader");
+  stream_add(GUI_EVENT_FLAG_LOG,       "[coap] start");
+  stream_add(GUI_EVENT_FLAG_LOG,       "press 'B' to start");
+}
+
+static void scenario_votes(void)
+{
+  char msg[GUI_EVENT_MSG_SIZE];
+
+  // a classroom answering, one log line per vote
+  for(uint32_t i = 0; i < 150; i++)
+  {
+      snprintf(msg, sizeof(msg), "[coap] *%c", 'A' + (char)(i % 4));
+      stream_add(GUI_EVENT_FLAG_LOG, msg);
+  }
+}
+
+static void scenario_results(void)
+{
+  char msg[GUI_EVENT_MSG_SIZE];
+
+  // switch to the results view, then a classroom answering
+  stream_add(GUI_EVENT_FLAG_BTN1_PRESSED,  "");
+  stream_add(GUI_EVENT_FLAG_BTN1_RELEASED, "");
+
+  for(uint32_t i = 0; i < 150; i++)
+  {
+      snprintf(msg, sizeof(msg), "%u %c", i, 'A' + (char)((i * 7) % 4));
+      stream_add(BENCH_FLAG_VOTE, msg);
+  }
+}
+
+static void vote(const char *msg)
+{
+  char    *answer;
+  uint32_t remote = (uint32_t)strtoul(msg, &answer, 0);
+
+  tally_record((uint16_t)(remote % TALLY_MAX_REMOTES), answer[0] == ' ' ? answer[1] : answer[0]);
+  gui_trace_vote(gui_trace_now());
+}
+
+static void scenario_buttons(void)
+{
+  for(uint32_t i = 0; i < 32; i++)
+  {
+      stream_add((i & 1) ? GUI_EVENT_FLAG_BTN0_RELEASED : GUI_EVENT_FLAG_BTN0_PRESSED, "");
+      stream_add((i & 1) ? GUI_EVENT_FLAG_BTN1_RELEASED : GUI_EVENT_FLAG_BTN1_PRESSED, "");
+  }
+}
+
+static int stream_load(const char *path)
+{
+  char  line[128];
+  char  *msg;
+  FILE  *file = fopen(path, "r");
+
+  if(file == NULL)
+  {
+      return -1;
+  }
+
+  while(fgets(line, sizeof(line), file) != NULL)
+  {
+      if(line[0] == '#' || line[0] == '\n')
+      {
+          continue;
+      }
+
+      line[strcspn(line, "\r\n")] = '\0';
+      uint32_t flag = (uint32_t)strtoul(line, &msg, 0);
+
+      while(*msg == ' ')
+      {
+          msg++;
+      }
+
+      stream_add(flag, msg);
+  }
+
+  fclose(file);
+
+  return 0;
+}
+
+static uint64_t now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// gui_update() prints every event, keep that out of the report
+static void quiet_begin(void)
+{
+  int devnull = open("/dev/null", O_WRONLY);
+
+  fflush(stdout);
+  saved_stdout = dup(STDOUT_FILENO);
+  dup2(devnull, STDOUT_FILENO);
+  close(devnull);
+}
+
+static void quiet_end(void)
+{
+  fflush(stdout);
+  dup2(saved_stdout, STDOUT_FILENO);
+  close(saved_stdout);
+}
+
+// one pass of the main loop as far as the display is concerned
+static void loop_once(void)
+{
+  gui_update();
+  dlog_process();
+
+  if(display_flush_busy() && ++flush_age >= flush_latency)
+  {
+      display_flush_host_complete();
+      flush_age = 0;
+  }
+}
+
+// mean and max in us per event kind, of the stages with samples
+static void print_trace(void)
+{
+  static const char * const kinds[GUI_TRACE_KIND_COUNT]   = {"button", "network", "log", "join", "vote"};
+  static const char * const stages[GUI_TRACE_STAGE_COUNT] = {"wait", "render", "flush", "total"};
+
+  const gui_trace_stats_t *trace = gui_trace_get();
+  const gui_trace_hist_t  *hist;
+
+  for(uint32_t k = 0; k < GUI_TRACE_KIND_COUNT; k++)
+  {
+      if(trace->hist[k][GUI_TRACE_STAGE_WAIT].count == 0)
+      {
+          continue;
+      }
+
+      printf("%-8s", kinds[k]);
+      for(uint32_t s = 0; s < GUI_TRACE_STAGE_COUNT; s++)
+      {
+          hist = &trace->hist[k][s];
+          printf("  %s %lu/%lu", stages[s],
+                 (unsigned long)(hist->count ? hist->sum_us / hist->count : 0), (unsigned long)hist->max_us);
+      }
+      printf(" us\n");
+  }
+
+  if(trace->untraced)
+  {
+      printf("untraced:       %lu\n", (unsigned long)trace->untraced);
+  }
+}
+
+static void replay(uint32_t repeat, uint32_t batch)
+{
+  glib_host_stats_t           stats;
+  display_flush_host_stats_t  flush;
+  uint64_t          start, elapsed;
+  uint32_t          total = stream.count * repeat;
+  uint32_t          pending = 0;
+
+  if(total == 0)
+  {
+      printf("no events\n");
+      return;
+  }
+
+  glib_host_stats_reset();
+  gui_trace_reset();
+
+  quiet_begin();
+  start = now_ns();
+
+  for(uint32_t r = 0; r < repeat; r++)
+  {
+      for(uint32_t i = 0; i < stream.count; i++)
+      {
+          stream.events[i].created = gui_trace_now();
+
+          if(stream.events[i].flag == BENCH_FLAG_VOTE)
+          {
+              vote(stream.events[i].msg);
+          }
+          // gui_event_queue is bounded, drain it before it overflows
+          else if(ring_buffer_add(&gui_event_queue, &stream.events[i]) != SL_STATUS_OK)
+          {
+              loop_once();
+              ring_buffer_add(&gui_event_queue, &stream.events[i]);
+              pending = 0;
+          }
+
+          if(++pending >= batch)
+          {
+              loop_once();
+              pending = 0;
+          }
+      }
+  }
+
+  // let the last frame out
+  do {
+      loop_once();
+  } while(display_flush_busy());
+
+  elapsed = now_ns() - start;
+  quiet_end();
+
+  glib_host_stats_get(&stats);
+  display_flush_host_stats_get(&flush);
+
+  printf("events:         %u\n", total);
+  printf("ns/event:       %.1f\n", (double)elapsed / total);
+  printf("pixels/event:   %.1f\n", (double)stats.pixels / total);
+  printf("glyphs/event:   %.2f\n", (double)stats.glyphs / total);
+  printf("flushes/event:  %.2f\n", (double)stats.flushes / total);
+  printf("flush busy:     %u\n", flush.rejected);
+
+  print_trace();
+}
+
+int main(int argc, char **argv)
+{
+  const char  *scenario = "all";
+  const char  *file     = NULL;
+  const char  *write    = NULL;
+  const char  *golden   = NULL;
+  uint32_t    repeat    = 100;
+  uint32_t    batch     = 1;
+  int         opt;
+
+  while((opt = getopt(argc, argv, "s:f:n:b:l:w:g:")) != -1)
+  {
+      switch(opt) {
+        case 's': scenario      = optarg;                              break;
+        case 'f': file          = optarg;                              break;
+        case 'n': repeat        = (uint32_t)strtoul(optarg, NULL, 0);  break;
+        case 'b': batch         = (uint32_t)strtoul(optarg, NULL, 0);  break;
+        case 'l': flush_latency = (uint32_t)strtoul(optarg, NULL, 0);  break;
+        case 'w': write         = optarg;                              break;
+        case 'g': golden        = optarg;                              break;
+        default:
+          fprintf(stderr, "usage: %s [-s boot|votes|buttons|results|all] [-f events.txt] "
+                          "[-n repeat] [-b batch] [-l flush_latency] [-w out.pbm] [-g golden.pbm]\n", argv[0]);
+          return 2;
+      }
+  }
+
+  if(batch == 0)
+  {
+      batch = 1;
+  }
+
+  display_flush_host_set_auto_complete(flush_latency == 0);
+
+  if(file != NULL)
+  {
+      if(stream_load(file) != 0)
+      {
+          fprintf(stderr, "can't read %s\n", file);
+          return 2;
+      }
+  }
+  else
+  {
+      bool all = (strcmp(scenario, "all") == 0);
+
+      if(all || strcmp(scenario, "boot")    == 0) scenario_boot();
+      if(all || strcmp(scenario, "votes")   == 0) scenario_votes();
+      if(all || strcmp(scenario, "buttons") == 0) scenario_buttons();
+      if(all || strcmp(scenario, "results") == 0) scenario_results();
+  }
+
+  quiet_begin();
+  dlog_init();
+  gui_init();
+  quiet_end();
+
+  replay(repeat, batch);
+
+  if(write != NULL && glib_host_save_pbm(write) != 0)
+  {
+      fprintf(stderr, "can't write %s\n", write);
+      return 2;
+  }
+
+  if(golden != NULL)
+  {
+      int diff = glib_host_compare_pbm(golden);
+
+      if(diff != 0)
+      {
+          fprintf(stderr, "golden mismatch %s: %d pixels\n", golden, diff);
+          return 1;
+      }
+
+      printf("golden match:   %s\n", golden);
+  }
+
+  return 0;
+}
@@ -0,0 +1,70 @@
+/***************************************************************************//**
+ * @file
+ * @brief Host Stand-In for the Dot Matrix Display Driver
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#ifndef DMD_H
+#define DMD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef uint32_t EMSTATUS;
+
+#define DMD_OK                      0x00000000
+#define DMD_ERROR_DRIVER_NOT_INITIALIZED  0x00000001
+#define DMD_ERROR_PIXEL_OUT_OF_BOUNDS     0x00000002
+
+// memory LCD on the BRD4162A
+#define DMD_HOST_DISPLAY_WIDTH      128
+#define DMD_HOST_DISPLAY_HEIGHT     128
+
+typedef struct {
+  uint16_t  xSize;
+  uint16_t  ySize;
+  uint16_t  xClipStart;
+  uint16_t  yClipStart;
+  uint16_t  clipWidth;
+  uint16_t  clipHeight;
+} DMD_DisplayGeometry;
+
+typedef void DMD_InitConfig_t;
+
+EMSTATUS DMD_init(DMD_InitConfig_t *initConfig);
+EMSTATUS DMD_getDisplayGeometry(DMD_DisplayGeometry **geometry);
+EMSTATUS DMD_updateDisplay(void);
+EMSTATUS DMD_allocateFramebuffer(void **framebuffer);
+EMSTATUS DMD_selectFramebuffer(void *framebuffer);
+
+#endif /* DMD_H */
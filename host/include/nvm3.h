@@ -0,0 +1,89 @@
+/***************************************************************************//**
+ * @file
+ * @brief Host Stand-In for NVM3
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#ifndef NVM3_H
+#define NVM3_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/*
+ * The subset of the NVM3 API the application uses, over an emulated flash of
+ * erasable pages. Objects are appended to the current page, a rewrite leaves
+ * the old copy behind, and the oldest page is compacted and erased once the
+ * erased pages run low, much like NVM3 repacks. Programmed bytes and erases
+ * are counted so that write amplification can be measured.
+ */
+
+typedef uint32_t Ecode_t;
+typedef uint32_t nvm3_ObjectKey_t;
+typedef struct nvm3_Handle nvm3_Handle_t;
+
+#define ECODE_NVM3_OK                   0u
+#define ECODE_NVM3_ERR_KEY_NOT_FOUND    0xF001000Eu
+#define ECODE_NVM3_ERR_STORAGE_FULL     0xF0010008u
+#define ECODE_NVM3_ERR_WRITE_DATA_SIZE  0xF001000Bu
+#define ECODE_NVM3_ERR_PARAMETER        0xF0010001u
+
+#define NVM3_OBJECTTYPE_DATA            0u
+#define NVM3_KEY_MIN                    0u
+#define NVM3_KEY_MAX                    0xFFFFFu
+
+Ecode_t nvm3_writeData(nvm3_Handle_t *h, nvm3_ObjectKey_t key, const void *value, size_t len);
+Ecode_t nvm3_readData(nvm3_Handle_t *h, nvm3_ObjectKey_t key, void *value, size_t maxLen);
+Ecode_t nvm3_getObjectInfo(nvm3_Handle_t *h, nvm3_ObjectKey_t key, uint32_t *type, size_t *len);
+Ecode_t nvm3_deleteObject(nvm3_Handle_t *h, nvm3_ObjectKey_t key);
+size_t  nvm3_enumObjects(nvm3_Handle_t *h, nvm3_ObjectKey_t *keyListPtr, size_t keyListSize,
+                         nvm3_ObjectKey_t keyMin, nvm3_ObjectKey_t keyMax);
+size_t  nvm3_countObjects(nvm3_Handle_t *h);
+bool    nvm3_repackNeeded(nvm3_Handle_t *h);
+Ecode_t nvm3_repack(nvm3_Handle_t *h);
+
+typedef struct {
+  uint32_t  writes;
+  uint64_t  user_bytes;         // object data handed to nvm3_writeData
+  uint64_t  programmed_bytes;   // including object headers, padding and repack copies
+  uint32_t  erases;
+  uint32_t  repacks;
+} nvm3_host_stats_t;
+
+// host only: (re)format the default instance with this many pages
+void nvm3_host_init(uint32_t pages, uint32_t page_size);
+void nvm3_host_stats_get(nvm3_host_stats_t *stats);
+void nvm3_host_stats_reset(void);
+
+#endif /* NVM3_H */
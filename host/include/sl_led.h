@@ -0,0 +1,62 @@
+/***************************************************************************//**
+ * @file
+ * @brief Host Stand-In for the LED Driver
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#ifndef SL_LED_H
+#define SL_LED_H
+
+#include <stdint.h>
+#include "sl_status.h"
+
+#define SL_LED_CURRENT_STATE_OFF  0U
+#define SL_LED_CURRENT_STATE_ON   1U
+
+typedef uint8_t sl_led_state_t;
+
+typedef struct sl_led {
+  void*           context;    // sl_led_host_t on the host
+} sl_led_t;
+
+typedef struct {
+  sl_led_state_t  state;
+  uint32_t        toggles;
+} sl_led_host_t;
+
+void sl_led_turn_on(const sl_led_t *led_handle);
+void sl_led_turn_off(const sl_led_t *led_handle);
+void sl_led_toggle(const sl_led_t *led_handle);
+sl_led_state_t sl_led_get_state(const sl_led_t *led_handle);
+
+#endif /* SL_LED_H */
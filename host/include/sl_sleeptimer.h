@@ -0,0 +1,87 @@
+/***************************************************************************//**
+ * @file
+ * @brief Host Stand-In for the Sleeptimer Service
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#ifndef SL_SLEEPTIMER_H
+#define SL_SLEEPTIMER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "sl_status.h"
+
+// same tick rate as the LFXO backed sleeptimer on target
+#define SL_SLEEPTIMER_HOST_FREQUENCY  32768u
+
+typedef struct sl_sleeptimer_timer_handle sl_sleeptimer_timer_handle_t;
+
+typedef void (*sl_sleeptimer_timer_callback_t)(sl_sleeptimer_timer_handle_t *handle, void *data);
+
+struct sl_sleeptimer_timer_handle {
+  void*                           callback_data;
+  sl_sleeptimer_timer_callback_t  callback;
+  uint64_t                        expiry;         // host ticks
+  uint32_t                        period;         // 0 for one shot timers
+  bool                            running;
+  sl_sleeptimer_timer_handle_t*   next;
+};
+
+uint32_t    sl_sleeptimer_get_tick_count(void);
+uint64_t    sl_sleeptimer_get_tick_count64(void);
+uint32_t    sl_sleeptimer_get_timer_frequency(void);
+uint32_t    sl_sleeptimer_tick_to_ms(uint32_t tick);
+uint32_t    sl_sleeptimer_ms_to_tick(uint16_t time_ms);
+sl_status_t sl_sleeptimer_ms32_to_tick(uint32_t time_ms, uint32_t *tick);
+
+sl_status_t sl_sleeptimer_start_timer_ms(sl_sleeptimer_timer_handle_t *handle, uint32_t timeout_ms,
+                                         sl_sleeptimer_timer_callback_t callback, void *callback_data,
+                                         uint8_t priority, uint16_t option_flags);
+sl_status_t sl_sleeptimer_start_periodic_timer_ms(sl_sleeptimer_timer_handle_t *handle, uint32_t timeout_ms,
+                                                  sl_sleeptimer_timer_callback_t callback, void *callback_data,
+                                                  uint8_t priority, uint16_t option_flags);
+sl_status_t sl_sleeptimer_restart_timer_ms(sl_sleeptimer_timer_handle_t *handle, uint32_t timeout_ms,
+                                           sl_sleeptimer_timer_callback_t callback, void *callback_data,
+                                           uint8_t priority, uint16_t option_flags);
+sl_status_t sl_sleeptimer_stop_timer(sl_sleeptimer_timer_handle_t *handle);
+sl_status_t sl_sleeptimer_is_timer_running(sl_sleeptimer_timer_handle_t *handle, bool *running);
+
+// host only: fire the callbacks of expired timers, call from the main loop
+void sl_sleeptimer_host_process(void);
+
+// host only: leave the monotonic clock for a virtual one set to ticks, for
+// benchmarks that run faster than real time
+void sl_sleeptimer_host_set_ticks(uint64_t ticks);
+
+#endif /* SL_SLEEPTIMER_H */
@@ -0,0 +1,59 @@
+/***************************************************************************//**
+ * @file
+ * @brief Host Stand-In for the Gecko SDK Status Codes
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#ifndef SL_STATUS_H
+#define SL_STATUS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef uint32_t sl_status_t;
+
+#define SL_STATUS_OK                ((sl_status_t)0x0000)
+#define SL_STATUS_FAIL              ((sl_status_t)0x0001)
+#define SL_STATUS_INVALID_STATE     ((sl_status_t)0x0002)
+#define SL_STATUS_NOT_READY         ((sl_status_t)0x0003)
+#define SL_STATUS_BUSY              ((sl_status_t)0x0004)
+#define SL_STATUS_IN_PROGRESS       ((sl_status_t)0x0005)
+#define SL_STATUS_FULL              ((sl_status_t)0x0009)
+#define SL_STATUS_EMPTY             ((sl_status_t)0x000A)
+#define SL_STATUS_NO_MORE_RESOURCE  ((sl_status_t)0x001A)
+#define SL_STATUS_NULL_POINTER      ((sl_status_t)0x0022)
+#define SL_STATUS_INVALID_PARAMETER ((sl_status_t)0x0021)
+#define SL_STATUS_NOT_FOUND         ((sl_status_t)0x000C)
+#define SL_STATUS_ALLOCATION_FAILED ((sl_status_t)0x0019)
+
+#endif /* SL_STATUS_H */
@@ -0,0 +1,134 @@
+/***************************************************************************//**
+ * @file
+ * @brief Host Replay of Commissioner Events through the Join Statistics
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+/*
+ * Replays commissioner joiner event sequences through join_stats.c, the way
+ * base_station.c and roster.c produce them, and checks the joined and failed
+ * counts. Exits with 1 on the first sequence that counts wrong.
+ *
+ * build (from the repository root), with OT the OpenThread checkout for the
+ * headers:
+ *   gcc -O2 -I$OT/include -Ihost/include -Ihost -I. -o join_replay host/join_replay.c \
+ *       join_stats.c coap_diag_codec.c gui_event_queue.c gui_trace.c ring_buffer.c \
+ *       host/sl_sleeptimer_host.c dlog.c logging.c
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "sl_sleeptimer.h"
+#include "join_stats.h"
+#include "gui_event_queue.h"
+
+#define S   OT_COMMISSIONER_JOINER_START
+#define C   OT_COMMISSIONER_JOINER_CONNECTED
+#define F   OT_COMMISSIONER_JOINER_FINALIZE
+#define E   OT_COMMISSIONER_JOINER_END
+#define R   OT_COMMISSIONER_JOINER_REMOVED
+
+#define SEQUENCE_MAX  16u
+
+typedef struct {
+  const char  *name;
+  uint8_t     joiner[SEQUENCE_MAX];     // joiner id byte per event
+  uint8_t     event[SEQUENCE_MAX];
+  uint8_t     length;
+  uint32_t    joined;
+  uint32_t    failed[JOIN_PHASE_COUNT];
+  uint32_t    restarted;
+} sequence_t;
+
+static const sequence_t sequences[] = {
+  // the roster removes a joined remote right after its end
+  {"joined, removed by the roster", {1, 1, 1, 1, 1}, {S, C, F, E, R}, 5, 1, {0, 0, 0, 0}, 0},
+  // the entry of a joined remote expires later on its own
+  {"joined, entry expires later",   {1, 1, 1, 2, 2, 2, 2, 1, 2}, {S, C, F, S, C, F, E, E, R}, 9, 2, {0, 0, 0, 0}, 0},
+  {"wrong pskd, removed",           {1, 1, 1}, {S, E, R}, 3, 0, {1, 0, 0, 0}, 0},
+  {"end before finalize, retried",  {1, 1, 1, 1, 1, 1, 1, 1, 1}, {S, C, E, R, S, C, F, E, R}, 9, 1, {0, 1, 0, 0}, 0},
+  {"expired while finalizing",      {1, 1, 1, 1}, {S, C, F, R}, 4, 0, {0, 0, 1, 0}, 0},
+  {"never showed up",               {1}, {R}, 1, 0, {0, 0, 0, 1}, 0},
+  {"restarted handshake",           {1, 1, 1, 1, 1, 1}, {S, S, C, F, E, R}, 6, 1, {0, 0, 0, 0}, 1},
+};
+
+// nothing to wake, the replay drives the events itself
+void otSysEventSignalPending(void)
+{
+}
+
+static bool replay(const sequence_t *sequence)
+{
+  const join_stats_t  *stats = join_stats_get();
+  bool                pass;
+
+  join_stats_reset();
+
+  for(uint8_t i = 0; i < sequence->length; i++)
+  {
+      otExtAddress id;
+
+      memset(&id, 0, sizeof(id));
+      id.m8[7] = sequence->joiner[i];
+
+      sl_sleeptimer_host_set_ticks((uint64_t)(i + 1u) * 1000u);
+      join_stats_event((otCommissionerJoinerEvent)sequence->event[i], &id);
+  }
+
+  pass = stats->joined == sequence->joined && stats->restarted == sequence->restarted
+         && memcmp(stats->failed, sequence->failed, sizeof(stats->failed)) == 0;
+
+  printf("%-32s joined %lu failed %lu/%lu/%lu/%lu restarted %lu  %s\n", sequence->name,
+         (unsigned long)stats->joined, (unsigned long)stats->failed[JOIN_PHASE_HANDSHAKE],
+         (unsigned long)stats->failed[JOIN_PHASE_COMMISSION], (unsigned long)stats->failed[JOIN_PHASE_FINALIZE],
+         (unsigned long)stats->failed[JOIN_PHASE_TOTAL], (unsigned long)stats->restarted, pass ? "ok" : "WRONG");
+
+  return pass;
+}
+
+int main(void)
+{
+  bool pass = true;
+
+  gui_event_queue_init();
+  // keep the console for the report
+  gui_event_queue_set_log_muted(true);
+
+  for(size_t i = 0; i < sizeof(sequences) / sizeof(sequences[0]); i++)
+  {
+      pass = replay(&sequences[i]) && pass;
+  }
+
+  return pass ? 0 : 1;
+}
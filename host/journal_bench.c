@@ -0,0 +1,217 @@
+/***************************************************************************//**
+ * @file
+ * @brief Host Benchmark for the Vote Journal
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+/*
+ * Pushes answers through vote_journal.c onto the NVM3 flash emulator, then
+ * rebuilds the tally from flash as after a reset and checks it matches, and
+ * that every answer journaled for the last question came back.
+ * Reports the write amplification, i.e. bytes programmed into flash per byte
+ * of journal record, the erases and the cost of the rebuild.
+ *
+ * build (from the repository root), with room for 10k answers in full batches:
+ *   gcc -O2 -DVOTE_JOURNAL_MAX_BATCHES=512 -Ihost/include -I. -o journal_bench \
+ *       host/journal_bench.c vote_journal.c tally.c coap_diag_codec.c host/nvm3_host.c \
+ *       host/sl_sleeptimer_host.c dlog.c logging.c
+ *
+ * usage:
+ *   journal_bench [-n answers] [-r remotes] [-q answers_per_question]
+ *                 [-f flush_every] [-p flash_pages]
+ *
+ * -f forces a partial batch out every so many answers, the way a trickle of
+ * answers slower than VOTE_JOURNAL_FLUSH_MS does on target, 0 never forces.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "nvm3.h"
+#include "tally.h"
+#include "vote_journal.h"
+#include "dlog.h"
+
+// nothing to wake, the benchmark drives the loop itself
+void otSysEventSignalPending(void)
+{
+}
+
+static uint64_t now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+int main(int argc, char **argv)
+{
+  uint32_t            answers   = 10000;
+  uint32_t            remotes   = 150;
+  uint32_t            question  = 0;
+  uint32_t            flush     = 0;
+  uint32_t            pages     = 128;
+  uint16_t            counts[TALLY_CHOICE_COUNT];
+  uint16_t            responded;
+  uint32_t            journaled = 0;
+  bool                match     = true;
+  nvm3_host_stats_t   flash;
+  const vote_journal_stats_t *journal;
+  uint32_t            batches;
+  uint64_t            start, rebuild_ns;
+  int                 opt;
+
+  while((opt = getopt(argc, argv, "n:r:q:f:p:")) != -1)
+  {
+      switch(opt) {
+        case 'n': answers  = (uint32_t)strtoul(optarg, NULL, 0);  break;
+        case 'r': remotes  = (uint32_t)strtoul(optarg, NULL, 0);  break;
+        case 'q': question = (uint32_t)strtoul(optarg, NULL, 0);  break;
+        case 'f': flush    = (uint32_t)strtoul(optarg, NULL, 0);  break;
+        case 'p': pages    = (uint32_t)strtoul(optarg, NULL, 0);  break;
+        default:
+          fprintf(stderr, "usage: %s [-n answers] [-r remotes] [-q answers_per_question] [-f flush_every] [-p flash_pages]\n", argv[0]);
+          return 2;
+      }
+  }
+
+  if(remotes == 0 || remotes > TALLY_MAX_REMOTES)
+  {
+      fprintf(stderr, "remotes must be 1 to %u\n", TALLY_MAX_REMOTES);
+      return 2;
+  }
+
+  if(pages < 3)
+  {
+      fprintf(stderr, "pages must be at least 3\n");
+      return 2;
+  }
+
+  // a full ring must fit with room to repack, or NVM3 spends its time moving it
+  if((uint32_t)VOTE_JOURNAL_MAX_BATCHES * (VOTE_JOURNAL_OBJECT_SIZE + 8u) > (pages - 2u) * 2048u * 3u / 4u)
+  {
+      fprintf(stderr, "warning: %u pages are tight for %u batches\n", pages, VOTE_JOURNAL_MAX_BATCHES);
+  }
+
+  // keep the console for the report
+  dlog_init();
+  nvm3_host_init(pages, 2048);
+  tally_reset();
+  vote_journal_init();
+  srand(1);
+
+  for(uint32_t i = 0; i < answers; i++)
+  {
+      char      answer  = (char)('A' + rand() % TALLY_CHOICE_COUNT);
+      uint16_t  remote  = (uint16_t)((uint32_t)rand() % remotes);
+
+      if(question > 0 && i > 0 && i % question == 0)
+      {
+          tally_reset();
+          vote_journal_new_question();
+          journaled = 0;
+      }
+
+      if(tally_record(remote, answer) == SL_STATUS_OK)
+      {
+          vote_journal_append(remote, answer);
+          journaled++;
+      }
+
+      if(flush > 0 && (i + 1) % flush == 0)
+      {
+          vote_journal_flush();
+      }
+
+      // one main loop pass per answer
+      vote_journal_process();
+  }
+  vote_journal_flush();
+
+  journal = vote_journal_get_stats();
+  nvm3_host_stats_get(&flash);
+
+  printf("answers:            %lu\n", (unsigned long)journal->committed);
+  printf("dropped:            %lu\n", (unsigned long)journal->dropped);
+  printf("write errors:       %lu\n", (unsigned long)journal->write_errors);
+  printf("batches:            %lu, %.1f answers each\n", (unsigned long)journal->batches,
+         journal->batches ? (double)journal->committed / journal->batches : 0.0);
+  printf("record bytes:       %lu\n", (unsigned long)(journal->committed * VOTE_JOURNAL_RECORD_SIZE));
+  printf("object bytes:       %lu\n", (unsigned long)journal->bytes_written);
+  printf("flash programmed:   %llu\n", (unsigned long long)flash.programmed_bytes);
+  printf("flash erases:       %lu\n", (unsigned long)flash.erases);
+  printf("write amplification %.2f (programmed / record bytes)\n",
+         journal->committed ? (double)flash.programmed_bytes / (journal->committed * VOTE_JOURNAL_RECORD_SIZE) : 0.0);
+
+  // reset: the tally is gone, the journal brings it back
+  for(uint8_t c = 0; c < TALLY_CHOICE_COUNT; c++)
+  {
+      counts[c] = tally_count(c);
+  }
+  responded = tally_responded();
+  batches   = journal->batches;
+
+  tally_reset();
+  start = now_ns();
+  vote_journal_init();
+  rebuild_ns = now_ns() - start;
+  journal = vote_journal_get_stats();
+
+  for(uint8_t c = 0; c < TALLY_CHOICE_COUNT; c++)
+  {
+      match = match && (counts[c] == tally_count(c));
+  }
+  match = match && (responded == tally_responded());
+  // a remote that answered again hides the loss of its first answer from
+  // the counts, compare with every answer written instead
+  match = match && !journal->truncated && journal->rebuilt_question == journaled;
+
+  printf("rebuild:            %lu records, %u batches, %.3f ms, %.1f ns/record\n",
+         (unsigned long)journal->rebuilt, journal->rebuilt_batches, (double)rebuild_ns / 1e6,
+         journal->rebuilt ? (double)rebuild_ns / journal->rebuilt : 0.0);
+  printf("last question:      %lu of %lu answers rebuilt%s\n", (unsigned long)journal->rebuilt_question,
+         (unsigned long)journaled, journal->truncated ? ", truncated" : "");
+  // a question longer than the ring loses its oldest batches, see vote_journal.h
+  if(journal->truncated)
+  {
+      printf("                    %lu batches went round %u keys\n", (unsigned long)batches, VOTE_JOURNAL_MAX_BATCHES);
+  }
+  printf("tally after reset:  %s\n", match ? "matches" : "DIFFERS");
+
+  return match ? 0 : 1;
+}
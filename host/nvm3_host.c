@@ -0,0 +1,401 @@
+/***************************************************************************//**
+ * @file
+ * @brief Host Stand-In for NVM3
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "nvm3.h"
+#include "nvm3_default.h"
+
+#define DEFAULT_PAGES       20u         // 40 kB, the default NVM3 size on target
+#define DEFAULT_PAGE_SIZE   2048u       // EFR32MG12 flash page
+#define OBJECT_HEADER       8u          // key and length
+#define MAX_KEYS            2048u
+#define RESERVE_PAGES       1u          // kept erased for repacking
+#define DELETED             0xFFFFFFFFu
+
+typedef struct {
+  nvm3_ObjectKey_t  key;
+  uint32_t          page;
+  uint32_t          offset;     // of the data
+  uint32_t          length;
+} entry_t;
+
+struct nvm3_Handle {
+  uint8_t           *flash;
+  bool              *erased;
+  uint32_t          pages;
+  uint32_t          page_size;
+  uint32_t          head_page;
+  uint32_t          head_offset;
+  entry_t           entries[MAX_KEYS];
+  uint32_t          count;
+  nvm3_host_stats_t stats;
+};
+
+static  nvm3_Handle_t default_instance;
+nvm3_Handle_t         *nvm3_defaultHandle = &default_instance;
+
+static nvm3_Handle_t *ready(nvm3_Handle_t *h)
+{
+  if(h->flash == NULL)
+  {
+      nvm3_host_init(DEFAULT_PAGES, DEFAULT_PAGE_SIZE);
+  }
+
+  return h;
+}
+
+static uint32_t padded(size_t len)
+{
+  return (uint32_t)((len + 3u) & ~(size_t)3u);
+}
+
+static uint32_t erased_pages(const nvm3_Handle_t *h)
+{
+  uint32_t count = 0;
+
+  for(uint32_t i = 0; i < h->pages; i++)
+  {
+      count += h->erased[i] ? 1u : 0u;
+  }
+
+  return count;
+}
+
+static entry_t *find(nvm3_Handle_t *h, nvm3_ObjectKey_t key)
+{
+  for(uint32_t i = 0; i < h->count; i++)
+  {
+      if(h->entries[i].key == key)
+      {
+          return &h->entries[i];
+      }
+  }
+
+  return NULL;
+}
+
+// program at the head, moving to the next erased page if needed, no repack
+static bool append(nvm3_Handle_t *h, nvm3_ObjectKey_t key, const void *value, uint32_t len, uint32_t *page, uint32_t *offset)
+{
+  uint32_t  need = OBJECT_HEADER + ((len == DELETED) ? 0u : padded(len));
+  uint32_t  header[2] = { key, len };
+  uint8_t   *p;
+
+  if(h->head_offset + need > h->page_size)
+  {
+      uint32_t next = h->head_page;
+
+      do
+      {
+          next = (next + 1u) % h->pages;
+      } while(!h->erased[next] && next != h->head_page);
+
+      if(next == h->head_page)
+      {
+          return false;
+      }
+
+      h->head_page    = next;
+      h->head_offset  = 0;
+  }
+
+  h->erased[h->head_page] = false;
+
+  p = h->flash + h->head_page * h->page_size + h->head_offset;
+  memcpy(p, header, sizeof(header));
+  if(len != DELETED)
+  {
+      memcpy(p + OBJECT_HEADER, value, len);
+  }
+
+  *page                     = h->head_page;
+  *offset                   = h->head_offset + OBJECT_HEADER;
+  h->head_offset           += need;
+  h->stats.programmed_bytes += need;
+
+  return true;
+}
+
+// move the live objects off the oldest page and erase it
+static bool repack_one(nvm3_Handle_t *h)
+{
+  static uint8_t  data[DEFAULT_PAGE_SIZE * 4];
+  uint32_t        oldest = h->head_page;
+
+  do
+  {
+      oldest = (oldest + 1u) % h->pages;
+  } while(h->erased[oldest] && oldest != h->head_page);
+
+  if(oldest == h->head_page)
+  {
+      return false;
+  }
+
+  for(uint32_t i = 0; i < h->count; i++)
+  {
+      entry_t *entry = &h->entries[i];
+
+      if(entry->page != oldest)
+      {
+          continue;
+      }
+
+      memcpy(data, h->flash + entry->page * h->page_size + entry->offset, entry->length);
+      if(!append(h, entry->key, data, entry->length, &entry->page, &entry->offset))
+      {
+          return false;
+      }
+  }
+
+  memset(h->flash + oldest * h->page_size, 0xFF, h->page_size);
+  h->erased[oldest] = true;
+  h->stats.erases++;
+  h->stats.repacks++;
+
+  return true;
+}
+
+// room for need bytes at the head, repacking the way NVM3 does when forced
+static bool make_room(nvm3_Handle_t *h, uint32_t need)
+{
+  uint32_t live = need;
+
+  if(h->head_offset + need <= h->page_size)
+  {
+      return true;
+  }
+
+  // full of live objects, repacking would only go round in circles
+  for(uint32_t i = 0; i < h->count; i++)
+  {
+      live += OBJECT_HEADER + padded(h->entries[i].length);
+  }
+  if(live > (h->pages - RESERVE_PAGES - 1u) * h->page_size)
+  {
+      return false;
+  }
+
+  for(uint32_t i = 0; i < h->pages && erased_pages(h) <= RESERVE_PAGES; i++)
+  {
+      if(!repack_one(h))
+      {
+          break;
+      }
+  }
+
+  return erased_pages(h) > RESERVE_PAGES || h->head_offset + need <= h->page_size;
+}
+
+void nvm3_host_init(uint32_t pages, uint32_t page_size)
+{
+  nvm3_Handle_t *h = &default_instance;
+
+  free(h->flash);
+  free(h->erased);
+  memset(h, 0, sizeof(*h));
+
+  if(page_size > DEFAULT_PAGE_SIZE * 4)
+  {
+      page_size = DEFAULT_PAGE_SIZE * 4;
+  }
+
+  h->pages      = (pages < RESERVE_PAGES + 2u) ? RESERVE_PAGES + 2u : pages;
+  h->page_size  = page_size;
+  h->flash      = malloc((size_t)h->pages * h->page_size);
+  h->erased     = malloc(h->pages * sizeof(bool));
+
+  memset(h->flash, 0xFF, (size_t)h->pages * h->page_size);
+  for(uint32_t i = 0; i < h->pages; i++)
+  {
+      h->erased[i] = true;
+  }
+}
+
+void nvm3_host_stats_get(nvm3_host_stats_t *stats)
+{
+  *stats = ready(nvm3_defaultHandle)->stats;
+}
+
+void nvm3_host_stats_reset(void)
+{
+  memset(&ready(nvm3_defaultHandle)->stats, 0, sizeof(nvm3_host_stats_t));
+}
+
+Ecode_t nvm3_writeData(nvm3_Handle_t *h, nvm3_ObjectKey_t key, const void *value, size_t len)
+{
+  entry_t   *entry;
+  uint32_t  page;
+  uint32_t  offset;
+
+  h = ready(h);
+
+  if(key > NVM3_KEY_MAX || len + OBJECT_HEADER > h->page_size)
+  {
+      return ECODE_NVM3_ERR_WRITE_DATA_SIZE;
+  }
+
+  entry = find(h, key);
+  if(entry == NULL && h->count >= MAX_KEYS)
+  {
+      return ECODE_NVM3_ERR_STORAGE_FULL;
+  }
+
+  if(!make_room(h, OBJECT_HEADER + padded(len)) || !append(h, key, value, (uint32_t)len, &page, &offset))
+  {
+      return ECODE_NVM3_ERR_STORAGE_FULL;
+  }
+
+  // the repack may have moved the entry, look it up again
+  entry = find(h, key);
+  if(entry == NULL)
+  {
+      entry = &h->entries[h->count++];
+  }
+
+  entry->key      = key;
+  entry->page     = page;
+  entry->offset   = offset;
+  entry->length   = (uint32_t)len;
+
+  h->stats.writes++;
+  h->stats.user_bytes += len;
+
+  return ECODE_NVM3_OK;
+}
+
+Ecode_t nvm3_readData(nvm3_Handle_t *h, nvm3_ObjectKey_t key, void *value, size_t maxLen)
+{
+  entry_t *entry = find(ready(h), key);
+
+  if(entry == NULL)
+  {
+      return ECODE_NVM3_ERR_KEY_NOT_FOUND;
+  }
+
+  memcpy(value, h->flash + entry->page * h->page_size + entry->offset, (entry->length < maxLen) ? entry->length : maxLen);
+
+  return ECODE_NVM3_OK;
+}
+
+Ecode_t nvm3_getObjectInfo(nvm3_Handle_t *h, nvm3_ObjectKey_t key, uint32_t *type, size_t *len)
+{
+  entry_t *entry = find(ready(h), key);
+
+  if(entry == NULL)
+  {
+      return ECODE_NVM3_ERR_KEY_NOT_FOUND;
+  }
+
+  *type = NVM3_OBJECTTYPE_DATA;
+  *len  = entry->length;
+
+  return ECODE_NVM3_OK;
+}
+
+Ecode_t nvm3_deleteObject(nvm3_Handle_t *h, nvm3_ObjectKey_t key)
+{
+  entry_t   *entry = find(ready(h), key);
+  uint32_t  page;
+  uint32_t  offset;
+
+  if(entry == NULL)
+  {
+      return ECODE_NVM3_ERR_KEY_NOT_FOUND;
+  }
+
+  // NVM3 writes a deletion object rather than touching the old copy
+  if(!make_room(h, OBJECT_HEADER) || !append(h, key, NULL, DELETED, &page, &offset))
+  {
+      return ECODE_NVM3_ERR_STORAGE_FULL;
+  }
+
+  entry   = find(h, key);
+  *entry  = h->entries[--h->count];
+
+  return ECODE_NVM3_OK;
+}
+
+size_t nvm3_enumObjects(nvm3_Handle_t *h, nvm3_ObjectKey_t *keyListPtr, size_t keyListSize,
+                        nvm3_ObjectKey_t keyMin, nvm3_ObjectKey_t keyMax)
+{
+  size_t found = 0;
+
+  h = ready(h);
+
+  for(uint32_t i = 0; i < h->count; i++)
+  {
+      if(h->entries[i].key < keyMin || h->entries[i].key > keyMax)
+      {
+          continue;
+      }
+
+      // like NVM3, an empty list only counts
+      if(keyListSize > 0)
+      {
+          if(found >= keyListSize)
+          {
+              break;
+          }
+          keyListPtr[found] = h->entries[i].key;
+      }
+      found++;
+  }
+
+  return found;
+}
+
+size_t nvm3_countObjects(nvm3_Handle_t *h)
+{
+  return ready(h)->count;
+}
+
+bool nvm3_repackNeeded(nvm3_Handle_t *h)
+{
+  return erased_pages(ready(h)) <= RESERVE_PAGES + 1u;
+}
+
+Ecode_t nvm3_repack(nvm3_Handle_t *h)
+{
+  if(nvm3_repackNeeded(h))
+  {
+      repack_one(h);
+  }
+
+  return ECODE_NVM3_OK;
+}
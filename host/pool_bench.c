@@ -0,0 +1,374 @@
+/***************************************************************************//**
+ * @file
+ * @brief Block Pool Allocator Benchmark
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+/*
+ * Replays an allocation trace through block_pool.c and through libc malloc and
+ * reports the cost per call and the pool occupancy.
+ *
+ * build (from the repository root):
+ *   gcc -O2 -Ihost/include -I. -o pool_bench host/pool_bench.c block_pool.c
+ *
+ * usage:
+ *   pool_bench [-f trace.txt] [-n repeat] [-s sessions]
+ *
+ * A trace is the console output of a build with BLOCK_POOL_TRACE set to 1,
+ * lines other than "heap a <ptr> <size>" and "heap f <ptr>" are skipped. Raise
+ * DLOG_RING_SIZE when capturing, records lost by the logger leave allocations
+ * that are never freed in the replay. Without -f a trace shaped like the
+ * mbedTLS traffic of back to back joiner handshakes is generated: long-lived
+ * contexts and record buffers per session, short-lived bignums freed out of
+ * order, and the odd allocation that outlives its session.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "block_pool.h"
+
+#define MAX_OPS         (1u << 20)
+#define MAX_LIVE        4096u
+
+typedef struct {
+  uint8_t   alloc;
+  uint16_t  slot;
+  uint32_t  size;
+} op_t;
+
+static  op_t      ops[MAX_OPS];
+static  uint32_t  op_count;
+static  void     *live[MAX_LIVE];
+
+// trace pointers are mapped to dense slots while parsing
+static  uint64_t  slot_ptr[MAX_LIVE];
+static  uint16_t  free_slots[MAX_LIVE];
+static  uint32_t  free_slot_count;
+static  uint32_t  slot_limit;
+
+static void slots_init(void)
+{
+  for(uint32_t i = 0; i < MAX_LIVE; i++)
+  {
+      free_slots[i] = (uint16_t)(MAX_LIVE - 1 - i);
+      slot_ptr[i]   = 0;
+  }
+  free_slot_count = MAX_LIVE;
+}
+
+static int add_alloc(uint64_t ptr, uint32_t size)
+{
+  uint16_t slot;
+
+  if(free_slot_count == 0 || op_count == MAX_OPS)
+  {
+      return -1;
+  }
+
+  slot            = free_slots[--free_slot_count];
+  slot_ptr[slot]  = ptr;
+  if(slot >= slot_limit)
+  {
+      slot_limit = slot + 1u;
+  }
+  ops[op_count++] = (op_t){ .alloc = 1, .slot = slot, .size = size };
+
+  return 0;
+}
+
+static int add_free(uint64_t ptr)
+{
+  for(uint32_t slot = 0; slot < MAX_LIVE; slot++)
+  {
+      if(slot_ptr[slot] == ptr && ptr != 0)
+      {
+          if(op_count == MAX_OPS)
+          {
+              return -1;
+          }
+          slot_ptr[slot]                  = 0;
+          free_slots[free_slot_count++]   = (uint16_t)slot;
+          ops[op_count++] = (op_t){ .alloc = 0, .slot = (uint16_t)slot, .size = 0 };
+          return 0;
+      }
+  }
+
+  // freed before the capture started, or the allocation record was lost
+  return 0;
+}
+
+static int load_trace(const char *path)
+{
+  FILE  *file = fopen(path, "r");
+  char  line[128];
+
+  if(file == NULL)
+  {
+      perror(path);
+      return -1;
+  }
+
+  while(fgets(line, sizeof(line), file))
+  {
+      char      *p = strstr(line, "heap ");
+      char      *end;
+      uint64_t  ptr;
+
+      if(p == NULL)
+      {
+          continue;
+      }
+
+      ptr = strtoull(p + 7, &end, 16);
+      if(p[5] == 'a' && ptr != 0)
+      {
+          add_alloc(ptr, (uint32_t)strtoul(end, NULL, 0));
+      }
+      else if(p[5] == 'f')
+      {
+          add_free(ptr);
+      }
+  }
+
+  fclose(file);
+
+  return 0;
+}
+
+static uint32_t rand_range(uint32_t lo, uint32_t hi)
+{
+  return lo + (uint32_t)rand() % (hi - lo + 1);
+}
+
+static void generate_trace(uint32_t sessions)
+{
+  uint64_t  next_ptr = 1;
+  uint64_t  lingering[8];
+  uint32_t  lingering_count = 0;
+
+  srand(1);
+
+  for(uint32_t s = 0; s < sessions; s++)
+  {
+      uint64_t  session[4];
+      uint64_t  bignums[256];
+      uint32_t  bignum_count = 0;
+
+      // ssl context, handshake state and the two record buffers
+      session[0] = next_ptr++; add_alloc(session[0], 296);
+      session[1] = next_ptr++; add_alloc(session[1], 480);
+      session[2] = next_ptr++; add_alloc(session[2], 1040);
+      session[3] = next_ptr++; add_alloc(session[3], 1040);
+
+      // ec j-pake rounds, bignum limbs come and go out of order
+      for(uint32_t step = 0; step < 400; step++)
+      {
+          if(bignum_count < 48 && (bignum_count == 0 || rand() % 100 < 55))
+          {
+              bignums[bignum_count] = next_ptr++;
+              add_alloc(bignums[bignum_count++], 4 * rand_range(1, 18));
+          }
+          else
+          {
+              uint32_t victim = (uint32_t)rand() % bignum_count;
+
+              add_free(bignums[victim]);
+              bignums[victim] = bignums[--bignum_count];
+          }
+      }
+
+      while(bignum_count)
+      {
+          add_free(bignums[--bignum_count]);
+      }
+
+      // now and then something outlives the handshake
+      if(s % 8 == 0 && lingering_count < 8)
+      {
+          lingering[lingering_count] = next_ptr++;
+          add_alloc(lingering[lingering_count++], rand_range(48, 200));
+      }
+      if(s % 8 == 5 && lingering_count > 0)
+      {
+          add_free(lingering[0]);
+          memmove(&lingering[0], &lingering[1], --lingering_count * sizeof(lingering[0]));
+      }
+
+      for(uint32_t i = 0; i < 4; i++)
+      {
+          add_free(session[i]);
+      }
+  }
+}
+
+static uint64_t now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// returns failed allocations, everything still live at the end is freed
+static uint32_t replay_pool(void)
+{
+  uint32_t failed = 0;
+
+  for(uint32_t i = 0; i < op_count; i++)
+  {
+      if(ops[i].alloc)
+      {
+          live[ops[i].slot] = block_pool_alloc(ops[i].size, true);
+          failed += (live[ops[i].slot] == NULL);
+      }
+      else
+      {
+          block_pool_free(live[ops[i].slot]);
+          live[ops[i].slot] = NULL;
+      }
+  }
+
+  for(uint32_t slot = 0; slot < slot_limit; slot++)
+  {
+      block_pool_free(live[slot]);
+      live[slot] = NULL;
+  }
+
+  return failed;
+}
+
+static uint32_t replay_malloc(void)
+{
+  uint32_t failed = 0;
+
+  for(uint32_t i = 0; i < op_count; i++)
+  {
+      if(ops[i].alloc)
+      {
+          live[ops[i].slot] = calloc(1, ops[i].size);
+          failed += (live[ops[i].slot] == NULL);
+      }
+      else
+      {
+          free(live[ops[i].slot]);
+          live[ops[i].slot] = NULL;
+      }
+  }
+
+  for(uint32_t slot = 0; slot < slot_limit; slot++)
+  {
+      free(live[slot]);
+      live[slot] = NULL;
+  }
+
+  return failed;
+}
+
+int main(int argc, char **argv)
+{
+  const char          *file     = NULL;
+  uint32_t            repeat    = 100;
+  uint32_t            sessions  = 64;
+  uint32_t            failed    = 0;
+  uint64_t            pool_ns, malloc_ns, start;
+  block_pool_stats_t  stats;
+  int                 opt;
+
+  while((opt = getopt(argc, argv, "f:n:s:")) != -1)
+  {
+      switch(opt) {
+        case 'f': file     = optarg;                              break;
+        case 'n': repeat   = (uint32_t)strtoul(optarg, NULL, 0);  break;
+        case 's': sessions = (uint32_t)strtoul(optarg, NULL, 0);  break;
+        default:
+          fprintf(stderr, "usage: %s [-f trace.txt] [-n repeat] [-s sessions]\n", argv[0]);
+          return 2;
+      }
+  }
+
+  slots_init();
+  if(file != NULL)
+  {
+      if(load_trace(file))
+      {
+          return 1;
+      }
+  }
+  else
+  {
+      generate_trace(sessions);
+  }
+
+  if(op_count == 0 || repeat == 0)
+  {
+      fprintf(stderr, "nothing to replay\n");
+      return 1;
+  }
+
+  block_pool_init();
+
+  start = now_ns();
+  for(uint32_t r = 0; r < repeat; r++)
+  {
+      failed += replay_pool();
+  }
+  pool_ns = now_ns() - start;
+
+  block_pool_get_stats(&stats);
+
+  start = now_ns();
+  for(uint32_t r = 0; r < repeat; r++)
+  {
+      replay_malloc();
+  }
+  malloc_ns = now_ns() - start;
+
+  printf("calls:          %u\n", op_count);
+  printf("pool ns/call:   %.1f\n", (double)pool_ns / ((double)op_count * repeat));
+  printf("malloc ns/call: %.1f\n", (double)malloc_ns / ((double)op_count * repeat));
+  printf("pool failed:    %u\n", failed / repeat);
+  printf("peak requested: %u bytes\n", stats.bytes_peak);
+  printf("class  blocks  peak  spills\n");
+  for(uint32_t c = 0; c < BLOCK_POOL_CLASS_COUNT; c++)
+  {
+      printf("%5u  %6u  %4u  %6u\n", stats.classes[c].size, stats.classes[c].blocks,
+             stats.classes[c].peak, stats.classes[c].spills / repeat);
+  }
+
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,237 @@
+/***************************************************************************//**
+ * @file
+ * @brief Host Throughput Benchmark for the Results Stream
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+/*
+ * Feeds answers at a fixed rate through tally.c and results_stream.c onto a
+ * simulated UART and reports, per rate, the frames that made it out, the
+ * frames dropped for lack of ring space, the line utilization, the longest
+ * queue in front of the UART and the encoding cost. Time is simulated in 1 ms
+ * steps, so a run takes a fraction of the time it models.
+ *
+ * build (from the repository root):
+ *   gcc -O2 -DRESULTS_STREAM_ENABLE=1 -Ihost/include -Ihost -I. -o results_bench \
+ *       host/results_bench.c results_stream.c tally.c coap_diag_codec.c host/uart_dma_host.c \
+ *       host/sl_sleeptimer_host.c
+ *
+ * usage:
+ *   results_bench [-r answers_per_s] [-b baud] [-s seconds] [-n remotes]
+ *                 [-l log_lines_per_s] [-o stream.bin]
+ *
+ * Without -r the rate is swept. -o writes what went out on the line, the last
+ * run's when sweeping, for host/results_decode.py.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "sl_sleeptimer.h"
+#include "tally.h"
+#include "results_stream.h"
+#include "uart_dma_host.h"
+
+static const uint32_t sweep[] = { 100, 200, 300, 400, 500, 600, 800, 1000 };
+
+// nothing to wake, the benchmark drives the loop itself
+void otSysEventSignalPending(void)
+{
+}
+
+static uint64_t now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static void set_time_ms(uint64_t ms)
+{
+  sl_sleeptimer_host_set_ticks(ms * SL_SLEEPTIMER_HOST_FREQUENCY / 1000u);
+}
+
+static void run(uint32_t rate, uint32_t baud, uint32_t seconds, uint32_t remotes, uint32_t log_rate, FILE *out)
+{
+  results_stream_stats_t  stream;
+  uart_dma_host_stats_t   before, after;
+  uint32_t                counted  = 0;
+  uint32_t                queue_ms = 0;
+  uint64_t                encode_ns = 0;
+  uint64_t                ms;
+  uint64_t                start;
+
+  set_time_ms(0);
+  uart_dma_host_set_baud(baud);
+  uart_dma_host_set_sink(out);
+  uart_dma_host_stats_get(&before);
+  tally_reset();
+  results_stream_init();
+  srand(rate);
+
+  for(ms = 0; ms < (uint64_t)seconds * 1000u; ms++)
+  {
+      uint32_t due = (uint32_t)((ms + 1) * rate / 1000u - ms * rate / 1000u);
+
+      set_time_ms(ms);
+
+      while(due--)
+      {
+          uint8_t   iid[TALLY_IID_SIZE] = { 0 };
+          uint32_t  remote              = (uint32_t)rand() % remotes;
+          char      answer              = (char)('A' + rand() % TALLY_CHOICE_COUNT);
+
+          memcpy(iid, &remote, sizeof(remote));
+          if(tally_record_at((uint16_t)remote, answer, (uint32_t)(ms * 1000u)) == SL_STATUS_OK)
+          {
+              counted++;
+              start = now_ns();
+              results_stream_vote(iid, answer, (uint32_t)(ms * 1000u));
+              encode_ns += now_ns() - start;
+          }
+      }
+
+      if(log_rate && ms % (1000u / log_rate) == 0)
+      {
+          static const char line[] = "coap: answer from fdde:ad00:beef:0:0:ff:fe00:fc10\r\n";
+
+          results_stream_log(line, sizeof(line) - 1);
+      }
+
+      // one main loop pass per millisecond, then a millisecond on the line
+      results_stream_process();
+      uart_dma_host_advance(1000);
+  }
+
+  uart_dma_host_stats_get(&after);
+
+  // let the line drain, then one last snapshot for the decoder to check against
+  for(uint32_t pass = 0; pass < 2; pass++)
+  {
+      if(pass == 1)
+      {
+          ms += RESULTS_STREAM_SNAPSHOT_MS;
+          set_time_ms(ms);
+      }
+
+      results_stream_process();
+      for(uint32_t i = 0; i < 10000u && uart_dma_busy(); i++)
+      {
+          uart_dma_host_advance(1000);
+          results_stream_process();
+      }
+  }
+
+  results_stream_get_stats(&stream);
+
+  if(baud)
+  {
+      queue_ms = (uint32_t)((uint64_t)stream.ring_peak * 10u * 1000u / baud);
+  }
+
+  printf("%8lu %8lu %8lu %7lu %9.0f %5.1f%% %5lu %6lu %8.0f\n",
+         (unsigned long)rate, (unsigned long)counted, (unsigned long)stream.frames,
+         (unsigned long)stream.dropped,
+         (double)(after.bytes - before.bytes) / seconds,
+         baud ? 100.0 * (double)(after.line_us - before.line_us) / ((double)seconds * 1e6) : 0.0,
+         (unsigned long)stream.ring_peak, (unsigned long)queue_ms,
+         counted ? (double)encode_ns / counted : 0.0);
+}
+
+int main(int argc, char **argv)
+{
+  uint32_t  rate      = 0;
+  uint32_t  baud      = 115200;
+  uint32_t  seconds   = 10;
+  uint32_t  remotes   = 150;
+  uint32_t  log_rate  = 2;
+  FILE      *out      = NULL;
+  int       opt;
+
+  while((opt = getopt(argc, argv, "r:b:s:n:l:o:")) != -1)
+  {
+      switch(opt) {
+        case 'r': rate     = (uint32_t)strtoul(optarg, NULL, 0);  break;
+        case 'b': baud     = (uint32_t)strtoul(optarg, NULL, 0);  break;
+        case 's': seconds  = (uint32_t)strtoul(optarg, NULL, 0);  break;
+        case 'n': remotes  = (uint32_t)strtoul(optarg, NULL, 0);  break;
+        case 'l': log_rate = (uint32_t)strtoul(optarg, NULL, 0);  break;
+        case 'o':
+          out = fopen(optarg, "wb");
+          if(out == NULL)
+          {
+              perror(optarg);
+              return 1;
+          }
+          break;
+        default:
+          fprintf(stderr, "usage: %s [-r answers_per_s] [-b baud] [-s seconds] [-n remotes] [-l log_lines_per_s] [-o stream.bin]\n", argv[0]);
+          return 2;
+      }
+  }
+
+  if(remotes == 0 || remotes > TALLY_MAX_REMOTES || seconds == 0 || log_rate > 1000)
+  {
+      fprintf(stderr, "remotes must be 1 to %u, seconds at least 1, log lines at most 1000/s\n", TALLY_MAX_REMOTES);
+      return 2;
+  }
+
+  printf("%u baud, %u s per rate, %u remotes, ring %u bytes\n", baud, seconds, remotes, RESULTS_STREAM_RING_SIZE);
+  printf("    rate  counted   frames dropped    line/s  busy  peak  queue  ns/vote\n");
+
+  if(rate)
+  {
+      run(rate, baud, seconds, remotes, log_rate, out);
+  }
+  else
+  {
+      for(uint32_t i = 0; i < sizeof(sweep) / sizeof(sweep[0]); i++)
+      {
+          // only the last run ends up in the capture
+          run(sweep[i], baud, seconds, remotes, log_rate,
+              (i + 1 == sizeof(sweep) / sizeof(sweep[0])) ? out : NULL);
+      }
+  }
+
+  if(out != NULL)
+  {
+      fclose(out);
+  }
+
+  return 0;
+}
@@ -0,0 +1,199 @@
+#!/usr/bin/env python3
+#
+# Copyright 2022 Silicon Laboratories Inc. www.silabs.com
+# SPDX-License-Identifier: Zlib
+#
+# Decoder for the results stream (RESULTS_STREAM_ENABLE), see results_stream.h
+# for the frame layout:
+#
+#   results_decode.py /dev/ttyACM0              # print the frames as they come
+#   results_decode.py --stats capture.bin       # counts, losses and a tally check
+#
+# The tally check replays the vote frames of each question the way tally.c
+# counts them and compares the result with every snapshot and delta that
+# follows without a frame lost in between.
+
+import argparse
+import struct
+import sys
+
+VOTE        = 1
+DELTA       = 2
+SNAPSHOT    = 3
+LOG         = 4
+DROPPED     = 5
+
+NAMES       = { VOTE: 'vote', DELTA: 'delta', SNAPSHOT: 'snapshot', LOG: 'log', DROPPED: 'dropped' }
+
+CHOICES     = 4
+NO_TIME     = 0xFFFFFFFF
+TICK_HZ     = 32768
+
+
+def crc16(data):
+    """CRC-16/CCITT-FALSE"""
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) & 0xFFFF if crc & 0x8000 else (crc << 1) & 0xFFFF
+    return crc
+
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data):
+            return None
+        out += data[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def packets(stream):
+    """Yield the bytes between zero delimiters."""
+    pending = bytearray()
+    while True:
+        chunk = stream.read(4096)
+        if not chunk:
+            return
+        pending += chunk
+        *complete, rest = pending.split(b'\0')
+        pending = bytearray(rest)
+        for packet in complete:
+            if packet:
+                yield bytes(packet)
+
+
+def frames(stream, stats):
+    """Yield (type, sequence, tick, body) for every frame with a good CRC."""
+    for packet in packets(stream):
+        frame = cobs_decode(packet)
+        if frame is None or len(frame) < 8 or crc16(frame[:-2]) != struct.unpack('<H', frame[-2:])[0]:
+            stats['bad'] += 1
+            continue
+        kind, sequence, tick = struct.unpack('<BBI', frame[:6])
+        yield kind, sequence, tick, frame[6:-2]
+
+
+def choice(answer):
+    answer = chr(answer).upper()
+    index = ord(answer) - ord('A')
+    return index if 0 <= index < CHOICES else None
+
+
+class Replay:
+    """Tally of one question rebuilt from its vote frames."""
+
+    def __init__(self, question):
+        self.question = question
+        self.voters = {}
+        self.intact = True      # every frame of the question seen
+
+    def counts(self):
+        counts = [0] * CHOICES
+        for index in self.voters.values():
+            counts[index] += 1
+        return counts
+
+
+def describe(kind, body):
+    if kind == VOTE:
+        question, answer = body[0], body[1]
+        time = struct.unpack('<I', body[10:14])[0]
+        return 'q%u %s %s %s' % (question, chr(answer), body[2:10].hex(),
+                                 '-' if time == NO_TIME else '%.6f s' % (time / 1e6))
+    if kind == DELTA:
+        version, question, responded = struct.unpack('<IBH', body[:7])
+        changes = struct.unpack('<%dh' % CHOICES, body[7:7 + 2 * CHOICES])
+        return 'q%u v%u responded %u %s' % (question, version, responded, ' '.join('%+d' % c for c in changes))
+    if kind == SNAPSHOT:
+        version, question, remotes, responded = struct.unpack('<IBHH', body[:9])
+        counts = struct.unpack('<%dH' % CHOICES, body[9:9 + 2 * CHOICES])
+        return 'q%u v%u responded %u/%u %s' % (question, version, responded, remotes, ' '.join(str(c) for c in counts))
+    if kind == LOG:
+        return body.decode('utf-8', 'replace')
+    if kind == DROPPED:
+        return '%u frames dropped' % struct.unpack('<I', body[:4])[0]
+    return body.hex()
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Decode the binary results stream.')
+    parser.add_argument('source', help='capture file or tty')
+    parser.add_argument('--stats', action='store_true', help='summary only')
+    args = parser.parse_args()
+
+    stats = { 'bad': 0, 'lost': 0, 'matched': 0, 'mismatched': 0, 'unchecked': 0 }
+    kinds = {}
+    sequence = None
+    replay = None
+    running = None          # snapshot plus the deltas since
+    first_tick = last_tick = None
+    size = 0
+
+    with open(args.source, 'rb', buffering=0) as stream:
+        for kind, seq, tick, body in frames(stream, stats):
+            kinds[kind] = kinds.get(kind, 0) + 1
+            size += 8 + len(body)
+            first_tick = tick if first_tick is None else first_tick
+            last_tick = tick
+
+            if sequence is not None and seq != (sequence + 1) & 0xFF:
+                stats['lost'] += (seq - sequence - 1) & 0xFF
+                if replay:
+                    replay.intact = False
+            sequence = seq
+
+            if not args.stats:
+                print('[%10.4f] %-8s %s' % (tick / TICK_HZ, NAMES.get(kind, '?%u' % kind), describe(kind, body)), flush=True)
+
+            if kind == VOTE:
+                question, index = body[0], choice(body[1])
+                if replay is None or replay.question != question:
+                    # joined mid question, can't check it
+                    replay = Replay(question)
+                    replay.intact = False
+                if index is not None:
+                    replay.voters[body[2:10]] = index
+            elif kind in (DELTA, SNAPSHOT):
+                question = body[4]
+                if kind == SNAPSHOT:
+                    running = list(struct.unpack('<%dH' % CHOICES, body[9:9 + 2 * CHOICES]))
+                    if replay is None or replay.question != question:
+                        # a new question starts with nothing counted
+                        replay = Replay(question)
+                        replay.intact = not any(running)
+                elif running is not None:
+                    changes = struct.unpack('<%dh' % CHOICES, body[7:7 + 2 * CHOICES])
+                    running = [c + d for c, d in zip(running, changes)]
+
+                if replay is None or not replay.intact or running is None or replay.question != question:
+                    stats['unchecked'] += 1
+                elif replay.counts() == running:
+                    stats['matched'] += 1
+                else:
+                    stats['mismatched'] += 1
+                    print('tally mismatch in q%u: votes give %s, %s says %s'
+                          % (question, replay.counts(), NAMES[kind], running), file=sys.stderr)
+
+    span = (last_tick - first_tick) / TICK_HZ if first_tick is not None and last_tick != first_tick else 0
+    out = sys.stdout if args.stats else sys.stderr
+    print('frames:   %s' % ', '.join('%s %u' % (NAMES.get(k, '?%u' % k), n) for k, n in sorted(kinds.items())), file=out)
+    print('bad crc:  %u' % stats['bad'], file=out)
+    print('lost:     %u (sequence gaps)' % stats['lost'], file=out)
+    if span:
+        print('rate:     %.0f frames/s, %.0f bytes/s over %.1f s'
+              % (sum(kinds.values()) / span, size / span, span), file=out)
+    print('tally:    %u matched, %u mismatched, %u not checkable'
+          % (stats['matched'], stats['mismatched'], stats['unchecked']), file=out)
+
+    return 1 if stats['mismatched'] or stats['bad'] else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,296 @@
+/***************************************************************************//**
+ * @file
+ * @brief Base Station on the OpenThread Simulation Platform
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+/*
+ * Runs the unmodified application (app.c, base_station.c, coap_server.c and
+ * the modules below them) as one node of the OpenThread simulation platform,
+ * with the host stand-ins for the display, buttons, LEDs and sleeptimer.
+ * host/sim/swarm.py starts it next to a swarm of host/sim/remote_sim.c nodes.
+ *
+ * usage:
+ *   base_station_sim [-d] <node id>
+ *
+ *   -d   commit the credentials from sim_network.h before the application
+ *        starts, so that it resumes them and remotes attach without joining
+ *
+ * The node reads single character commands on stdin, which also wakes the
+ * platform loop so that sleeptimer callbacks run on time:
+ *
+ *   '.'  nothing, just a pass of the main loop
+ *   'j'  press and release btn0, i.e. start commissioning
+ *   'n'  new question, clears the tally, marks the journal, restarts the
+ *        answer clock and publishes it to the remotes
+ *   's'  answer slots on from the next question, QUESTION_PUBLISH_SLOT_WINDOW_MS
+ *   'f'  answer slots off, every remote answers when it likes
+ *   'x'  drop every cached secure session, the remotes resume from tickets
+ *   'r'  print a "sim base" report line
+ *   'q'  quit
+ *
+ * The report holds the tally and the message buffer figures sampled on every
+ * pass of the main loop: the lowest free count seen and how often the pool
+ * ran dry. With COAP_SECURE_ENABLE it adds the session figures of
+ * coap_secure.h, and with PROF_ENABLE the mean ns spent opening sealed answers
+ * and resumes.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <openthread/instance.h>
+#include <openthread/dataset_ftd.h>
+#include <openthread/message.h>
+#include <openthread/tasklet.h>
+#include <openthread/thread.h>
+#include <openthread/platform/uart.h>
+
+#include "openthread-system.h"
+#include "app.h"
+
+#include "sl_simple_button_instances.h"
+#include "sl_sleeptimer.h"
+
+#include "base_station_config.h"
+#include "tally.h"
+#include "question_publish.h"
+#include "coap_secure.h"
+#include "prof.h"
+#include "sim_network.h"
+
+otInstance *otGetInstance(void);
+
+static void commit_sim_dataset(otInstance *instance);
+static void sample_buffers(otInstance *instance);
+static void report(void);
+
+static  volatile bool quit;
+static  uint16_t      buffers_total;
+static  uint16_t      buffers_min     = UINT16_MAX;
+static  uint32_t      exhausted;
+static  bool          was_exhausted;
+
+int main(int argc, char *argv[])
+{
+  bool  dataset = false;
+  int   opt;
+
+  while((opt = getopt(argc, argv, "+d")) != -1)
+  {
+      switch(opt) {
+        case 'd':
+          dataset = true;
+          break;
+
+        default:
+          fprintf(stderr, "usage: %s [-d] <node id>\n", argv[0]);
+          return 1;
+      }
+  }
+
+  // the platform takes the remaining arguments, i.e. the node id
+  argv[optind - 1] = argv[0];
+  argc            -= optind - 1;
+  argv            += optind - 1;
+  optind           = 1;
+
+  // reports are read through a pipe
+  setvbuf(stdout, NULL, _IOLBF, 0);
+
+  otSysInit(argc, argv);
+  sl_ot_create_instance();
+  otPlatUartEnable();
+
+  if(dataset)
+  {
+      commit_sim_dataset(otGetInstance());
+  }
+
+  app_init();
+
+  while(!quit && !otSysPseudoResetWasRequested())
+  {
+      app_process_action();
+      sl_sleeptimer_host_process();
+      sample_buffers(otGetInstance());
+  }
+
+  report();
+  app_exit();
+
+  return 0;
+}
+
+// provided by the SDK on target
+void otTaskletsSignalPending(otInstance *aInstance)
+{
+  (void)aInstance;
+
+  otSysEventSignalPending();
+}
+
+void otPlatUartReceived(const uint8_t *aBuf, uint16_t aBufLength)
+{
+  for(uint16_t i = 0; i < aBufLength; i++)
+  {
+      switch(aBuf[i]) {
+        case 'j':
+          sl_button_host_set_state(&sl_button_btn0, SL_SIMPLE_BUTTON_PRESSED);
+          sl_button_host_set_state(&sl_button_btn0, SL_SIMPLE_BUTTON_RELEASED);
+          break;
+
+        case 'n':
+          question_publish_start(TALLY_CHOICE_COUNT, "sim");
+          break;
+
+        case 's':
+          question_publish_set_slot_window(QUESTION_PUBLISH_SLOT_WINDOW_MS);
+          break;
+
+        case 'f':
+          question_publish_set_slot_window(0);
+          break;
+
+#if COAP_SECURE_ENABLE
+        case 'x':
+          coap_secure_flush();
+          break;
+#endif
+
+        case 'r':
+          report();
+          break;
+
+        case 'q':
+          quit = true;
+          break;
+
+        default:
+          break;
+      }
+  }
+}
+
+void otPlatUartSendDone(void)
+{
+}
+
+static void commit_sim_dataset(otInstance *instance)
+{
+  static const uint8_t  network_key[]       = SIM_NETWORK_KEY;
+  static const uint8_t  extended_panid[]    = SIM_EXTENDED_PANID;
+  static const uint8_t  mesh_local_prefix[] = SIM_MESH_LOCAL_PREFIX;
+  otOperationalDataset  dataset;
+  otError               error;
+
+  error = otDatasetCreateNewNetwork(instance, &dataset);
+  if(error)
+  {
+      goto exit;
+  }
+
+  memcpy(dataset.mNetworkKey.m8, network_key, sizeof(network_key));
+  memcpy(dataset.mExtendedPanId.m8, extended_panid, sizeof(extended_panid));
+  memcpy(dataset.mMeshLocalPrefix.m8, mesh_local_prefix, sizeof(mesh_local_prefix));
+  dataset.mPanId    = SIM_PANID;
+  dataset.mChannel  = SIM_CHANNEL;
+
+  error = otNetworkNameFromString(&dataset.mNetworkName, OPENTHREAD_NETWORK_NAME);
+  if(error)
+  {
+      goto exit;
+  }
+
+  error = otDatasetSetActive(instance, &dataset);
+
+exit:
+  if(error)
+  {
+      fprintf(stderr, "sim dataset: %s\n", otThreadErrorToString(error));
+      exit(1);
+  }
+}
+
+static void sample_buffers(otInstance *instance)
+{
+  otBufferInfo info;
+
+  otMessageGetBufferInfo(instance, &info);
+
+  buffers_total = info.mTotalBuffers;
+  if(info.mFreeBuffers < buffers_min)
+  {
+      buffers_min = info.mFreeBuffers;
+  }
+
+  // count the times the pool ran dry, not the passes it stayed dry
+  if(info.mFreeBuffers == 0 && !was_exhausted)
+  {
+      exhausted++;
+  }
+  was_exhausted = (info.mFreeBuffers == 0);
+}
+
+static void report(void)
+{
+  const question_publish_stats_t *publish = question_publish_get_stats();
+
+  printf("sim base responded %u remotes %u buffers %u min_free %u exhausted %lu"
+         " published %lu question_acks %lu repairs %lu",
+         tally_responded(), tally_remotes(), buffers_total,
+         (buffers_min == UINT16_MAX) ? buffers_total : buffers_min, (unsigned long)exhausted,
+         (unsigned long)publish->published, (unsigned long)publish->acks, (unsigned long)publish->repairs);
+#if COAP_SECURE_ENABLE
+  {
+      const coap_secure_stats_t *secure = coap_secure_get_stats();
+
+      printf(" handshakes %lu resumed %lu resume_failed %lu hits %lu misses %lu evicted %lu"
+             " cached %u session_bytes %u",
+             (unsigned long)secure->handshakes, (unsigned long)secure->resumed,
+             (unsigned long)secure->resume_failed, (unsigned long)secure->hits, (unsigned long)secure->misses,
+             (unsigned long)secure->evicted, secure->cached, secure->session_bytes);
+  }
+#endif
+#if PROF_ENABLE
+  {
+      const prof_stat_t *stat = prof_get(PROF_STAGE_SECURE);
+
+      printf(" secure_ns %lu secure_ops %lu",
+             (unsigned long)(stat->count ? stat->sum / stat->count : 0), (unsigned long)stat->count);
+  }
+#endif
+  printf("\n");
+}
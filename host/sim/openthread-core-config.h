@@ -0,0 +1,68 @@
+/***************************************************************************//**
+ * @file
+ * @brief Stack Configuration Seen by the Application in Simulation
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#ifndef OPENTHREAD_CORE_CONFIG_H_
+#define OPENTHREAD_CORE_CONFIG_H_
+
+/*
+ * The application only reads a few stack switches. The simulation builds
+ * take them from here instead of the stack's internal headers, keep them in
+ * line with the options the OpenThread simulation libraries were built with.
+ */
+
+#define OPENTHREAD_CONFIG_LOG_OUTPUT_NONE                 0
+#define OPENTHREAD_CONFIG_LOG_OUTPUT_DEBUG_UART           1
+#define OPENTHREAD_CONFIG_LOG_OUTPUT_APP                  2
+#define OPENTHREAD_CONFIG_LOG_OUTPUT_PLATFORM_DEFINED     3
+
+// the simulation platform writes the stack log itself
+#ifndef OPENTHREAD_CONFIG_LOG_OUTPUT
+#define OPENTHREAD_CONFIG_LOG_OUTPUT                      OPENTHREAD_CONFIG_LOG_OUTPUT_PLATFORM_DEFINED
+#endif
+
+#ifndef OPENTHREAD_CONFIG_HEAP_EXTERNAL_ENABLE
+#define OPENTHREAD_CONFIG_HEAP_EXTERNAL_ENABLE            0
+#endif
+
+#ifndef OPENTHREAD_CONFIG_MULTIPLE_INSTANCE_ENABLE
+#define OPENTHREAD_CONFIG_MULTIPLE_INSTANCE_ENABLE        0
+#endif
+
+#ifndef OPENTHREAD_CONFIG_COMMISSIONER_MAX_JOINER_ENTRIES
+#define OPENTHREAD_CONFIG_COMMISSIONER_MAX_JOINER_ENTRIES 2
+#endif
+
+#endif /* OPENTHREAD_CORE_CONFIG_H_ */
@@ -0,0 +1,971 @@
+/***************************************************************************//**
+ * @file
+ * @brief Virtual Remote on the OpenThread Simulation Platform
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+/*
+ * One clicker remote as a node of the OpenThread simulation platform. It
+ * attaches as a rx-on end device, with the credentials from sim_network.h or
+ * through the joiner, and posts answers to the base station when told to on
+ * stdin. host/sim/swarm.py runs a few hundred of them.
+ *
+ * usage:
+ *   remote_sim [-k pskd] [-a ack_timeout_ms] [-m max_retransmit] [-u] [-s] <node id>
+ *
+ *   -k   commission with this PSKd instead of using the fixed credentials
+ *   -a   CoAP ACK timeout, 2000 by default
+ *   -m   CoAP retransmissions, 4 by default
+ *   -u   don't stamp answers, the base station times them on delivery
+ *   -s   seal answers under a session from the base station, see coap_secure.h
+ *
+ * Once the base station's time beacon has been heard, answers carry the time
+ * of the command against it, see answer_time.h.
+ *
+ * A question descriptor from the base station, multicast or a unicast repair,
+ * is acknowledged after a random delay up to the ack spread it carries, see
+ * question_publish.h. The delay runs on the loop passes, which only happen on
+ * radio traffic or stdin, so swarm.py sends '.' often while a question goes
+ * out.
+ *
+ * The remote learns its registry id from the status acknowledgment of its
+ * answers. With an id and a question that came with answer slots, an answer
+ * given before id times the slot after the question arrived waits until then,
+ * the same way on the loop passes.
+ *
+ * With -s the first answer starts a DTLS handshake with the CoAPS endpoint,
+ * which takes one remote at a time: a remote that isn't through after
+ * CONNECT_TIMEOUT_MS gives up and tries again a random while later. The
+ * answers wait for the session and then go out sealed. A 4.01 to a sealed
+ * answer resumes the session from its ticket, a 4.01 to the resume goes back
+ * to the handshake.
+ *
+ * stdin commands, one character each:
+ *
+ *   'A' to 'D'   post that answer as a confirmable request
+ *   '.'          nothing, just a pass of the loop
+ *   'q'          quit
+ *
+ * stdout lines, all starting with "sim remote":
+ *
+ *   attached <ms>        attached this long after start
+ *   ack <rtt ms> <retx> <latency ms>
+ *                        answer acknowledged, the latency counts from the
+ *                        command, including any wait for the answer slot
+ *   lost <ms>            no acknowledgment after the last retransmission
+ *   nobufs               the stack had no message buffer for the request
+ *   busy                 too many requests in flight
+ *   skipped              answer asked for before attaching
+ *   question <id> <how>  a new question arrived, how is multicast or unicast
+ *   handshake <ms> <attempts>
+ *                        got a session, this long after the first attempt
+ *   resumed <ms>         the session is back in the base station's cache
+ *
+ * The ACK timeout is used without the random factor, so that the number of
+ * retransmissions follows from the round trip time: retransmission i goes
+ * out at ack_timeout * (2^i - 1).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <openthread/instance.h>
+#include <openthread/coap.h>
+#include <openthread/coap_secure.h>
+#include <openthread/joiner.h>
+#include <openthread/link.h>
+#include <openthread/tasklet.h>
+#include <openthread/thread.h>
+#include <openthread/platform/uart.h>
+
+#include "openthread-system.h"
+#include "mbedtls/ccm.h"
+
+#include "sim_network.h"
+
+#define MAX_IN_FLIGHT   32u
+
+#define NO_ID           0xFFFFu
+
+#define CONNECT_TIMEOUT_MS  3000u
+#define RETRY_MS            1000u   // to 2 * RETRY_MS before the next attempt
+#define KEY_SIZE            16u
+#define TAG_SIZE            8u
+#define TICKET_SIZE         (4u + 32u + TAG_SIZE)
+#define NONCE_SIZE          13u
+
+typedef enum {
+  SECURE_NONE,
+  SECURE_CONNECTING,
+  SECURE_READY,
+  SECURE_RESUMING,
+} secure_state_t;
+
+typedef struct {
+  bool      used;
+  uint32_t  sent;         // ms
+  uint32_t  pressed;      // ms
+  uint64_t  pressed_us;
+  char      answer;
+} request_t;
+
+static uint32_t now_ms(void);
+static void state_changed(otChangedFlags flags, void *context);
+static void joiner_callback(otError error, void *context);
+static void start_joiner(void);
+static void start_thread(void);
+static void answer(char choice);
+static void post_answer(char answer, uint64_t pressed);
+static void response_handler(void *context, otMessage *message, const otMessageInfo *info, otError result);
+static void beacon_handler(void *context, otMessage *message, const otMessageInfo *info);
+static void question_handler(void *context, otMessage *message, const otMessageInfo *info);
+static void send_question_ack(void);
+static void secure_connect(void);
+static void connect_handler(bool connected, void *context);
+static void session_handler(void *context, otMessage *message, const otMessageInfo *info, otError result);
+static void send_resume(void);
+static void resume_handler(void *context, otMessage *message, const otMessageInfo *info, otError result);
+static void wait_for_session(char answer, uint64_t pressed);
+static void seal(uint32_t number, const uint8_t *aad, size_t aad_length, uint8_t *data, size_t length, uint8_t *tag);
+static uint64_t now_us(void);
+
+static  otInstance          *sInstance;
+static  const char          *sPskd;
+static  volatile bool       quit;
+static  bool                attached;
+static  uint32_t            started_at;
+static  request_t           requests[MAX_IN_FLIGHT];
+static  bool                stamp_answers = true;
+static  bool                beacon_heard;
+static  uint8_t             beacon_sequence;
+static  uint64_t            beacon_at;            // us, local clock
+static  otCoapResource      beacon_resource = {
+  .mUriPath = SIM_TIME_URI,
+  .mHandler = beacon_handler,
+};
+static  bool                question_heard;
+static  uint8_t             question;
+static  bool                question_ack_pending;
+static  uint32_t            question_ack_due;     // ms
+static  uint32_t            question_at;          // ms
+static  uint16_t            slot_ms;
+static  uint16_t            my_id = NO_ID;
+static  char                held_answer;          // waiting for the slot, 0 if none
+static  uint64_t            held_pressed;         // us
+static  uint32_t            held_until;           // ms
+static  otCoapResource      question_resource = {
+  .mUriPath = SIM_QUESTION_URI,
+  .mHandler = question_handler,
+};
+static  bool                secure;
+static  secure_state_t      secure_state;
+static  uint32_t            session;
+static  uint8_t             session_key[KEY_SIZE];
+static  uint8_t             ticket[TICKET_SIZE];
+static  uint32_t            sequence;
+static  uint32_t            handshake_started;    // ms, first attempt
+static  uint32_t            attempts;
+static  uint32_t            connect_at;           // ms, next attempt or this one's start
+static  uint32_t            resume_sent;          // ms
+static  char                waiting_answer;       // for the session, 0 if none
+static  uint64_t            waiting_pressed;      // us
+static  mbedtls_ccm_context ccm;
+static  otCoapTxParameters  tx_parameters = {
+  .mAckTimeout                  = 2000,
+  .mAckRandomFactorNumerator    = 1,
+  .mAckRandomFactorDenominator  = 1,
+  .mMaxRetransmit               = 4,
+};
+
+int main(int argc, char *argv[])
+{
+  int opt;
+
+  while((opt = getopt(argc, argv, "+k:a:m:us")) != -1)
+  {
+      switch(opt) {
+        case 'k':
+          sPskd = optarg;
+          break;
+
+        case 'a':
+          tx_parameters.mAckTimeout = (uint32_t)strtoul(optarg, NULL, 0);
+          break;
+
+        case 'm':
+          tx_parameters.mMaxRetransmit = (uint8_t)strtoul(optarg, NULL, 0);
+          break;
+
+        case 'u':
+          stamp_answers = false;
+          break;
+
+        case 's':
+          secure = true;
+          break;
+
+        default:
+          fprintf(stderr, "usage: %s [-k pskd] [-a ack_timeout_ms] [-m max_retransmit] [-u] [-s] <node id>\n", argv[0]);
+          return 1;
+      }
+  }
+
+  // the platform takes the remaining arguments, i.e. the node id
+  argv[optind - 1] = argv[0];
+  argc            -= optind - 1;
+  argv            += optind - 1;
+  optind           = 1;
+
+  setvbuf(stdout, NULL, _IOLBF, 0);
+  started_at = now_ms();
+
+  otSysInit(argc, argv);
+  sInstance = otInstanceInitSingle();
+  otPlatUartEnable();
+
+  otSetStateChangedCallback(sInstance, state_changed, NULL);
+  otThreadSetLinkMode(sInstance, (otLinkModeConfig){ .mRxOnWhenIdle = true, .mDeviceType = false, .mNetworkData = false });
+  otIp6SetEnabled(sInstance, true);
+
+  // for the time beacon and the question descriptor
+  otCoapStart(sInstance, OT_DEFAULT_COAP_PORT);
+  otCoapAddResource(sInstance, &beacon_resource);
+  otCoapAddResource(sInstance, &question_resource);
+  srand((unsigned int)getpid());
+
+  if(secure)
+  {
+      otCoapSecureSetPsk(sInstance, (const uint8_t *)SIM_PSK, sizeof(SIM_PSK) - 1,
+                         (const uint8_t *)SIM_PSK_IDENTITY, sizeof(SIM_PSK_IDENTITY) - 1);
+      otCoapSecureStart(sInstance, OT_DEFAULT_COAP_SECURE_PORT);
+      mbedtls_ccm_init(&ccm);
+  }
+
+  if(sPskd != NULL)
+  {
+      start_joiner();
+  }
+  else
+  {
+      static const uint8_t  network_key[]       = SIM_NETWORK_KEY;
+      static const uint8_t  extended_panid[]    = SIM_EXTENDED_PANID;
+      static const uint8_t  mesh_local_prefix[] = SIM_MESH_LOCAL_PREFIX;
+      otNetworkKey          key;
+      otExtendedPanId       xpanid;
+      otMeshLocalPrefix     prefix;
+
+      memcpy(key.m8, network_key, sizeof(key.m8));
+      memcpy(xpanid.m8, extended_panid, sizeof(xpanid.m8));
+      memcpy(prefix.m8, mesh_local_prefix, sizeof(prefix.m8));
+
+      otThreadSetNetworkKey(sInstance, &key);
+      otThreadSetExtendedPanId(sInstance, &xpanid);
+      otThreadSetMeshLocalPrefix(sInstance, &prefix);
+      otLinkSetPanId(sInstance, SIM_PANID);
+      otLinkSetChannel(sInstance, SIM_CHANNEL);
+
+      start_thread();
+  }
+
+  while(!quit && !otSysPseudoResetWasRequested())
+  {
+      otTaskletsProcess(sInstance);
+      otSysProcessDrivers(sInstance);
+
+      if(question_ack_pending && (int32_t)(now_ms() - question_ack_due) >= 0)
+      {
+          question_ack_pending = false;
+          send_question_ack();
+      }
+
+      if(held_answer != 0 && (int32_t)(now_ms() - held_until) >= 0)
+      {
+          post_answer(held_answer, held_pressed);
+          held_answer = 0;
+      }
+
+      // the endpoint is busy with another remote, or the handshake got lost
+      if(secure_state == SECURE_CONNECTING && now_ms() - connect_at >= CONNECT_TIMEOUT_MS)
+      {
+          otCoapSecureDisconnect(sInstance);
+          secure_state = SECURE_NONE;
+          connect_at   = now_ms() + RETRY_MS + (uint32_t)rand() % RETRY_MS;
+      }
+
+      if(secure_state == SECURE_NONE && waiting_answer != 0 && (int32_t)(now_ms() - connect_at) >= 0)
+      {
+          secure_connect();
+      }
+  }
+
+  otInstanceFinalize(sInstance);
+
+  return 0;
+}
+
+void otTaskletsSignalPending(otInstance *aInstance)
+{
+  (void)aInstance;
+}
+
+void otPlatUartReceived(const uint8_t *aBuf, uint16_t aBufLength)
+{
+  for(uint16_t i = 0; i < aBufLength; i++)
+  {
+      if(aBuf[i] >= 'A' && aBuf[i] <= 'D')
+      {
+          answer((char)aBuf[i]);
+      }
+      else if(aBuf[i] == 'q')
+      {
+          quit = true;
+      }
+  }
+}
+
+void otPlatUartSendDone(void)
+{
+}
+
+static uint64_t now_us(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+static uint32_t now_ms(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return (uint32_t)((uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u);
+}
+
+static void state_changed(otChangedFlags flags, void *context)
+{
+  (void)context;
+
+  if(!(flags & OT_CHANGED_THREAD_ROLE) || attached)
+  {
+      return;
+  }
+
+  switch(otThreadGetDeviceRole(sInstance)) {
+    case OT_DEVICE_ROLE_CHILD:
+    case OT_DEVICE_ROLE_ROUTER:
+      attached = true;
+      printf("sim remote attached %lu\n", (unsigned long)(now_ms() - started_at));
+      break;
+
+    default:
+      break;
+  }
+}
+
+static void joiner_callback(otError error, void *context)
+{
+  (void)context;
+
+  if(error)
+  {
+      // the commissioner may not have allowed us in yet, try again
+      start_joiner();
+      return;
+  }
+
+  start_thread();
+}
+
+static void start_joiner(void)
+{
+  otError error = otJoinerStart(sInstance, sPskd, NULL, "OpenClicker", "remote_sim", "1", NULL, joiner_callback, NULL);
+
+  if(error)
+  {
+      fprintf(stderr, "sim remote joiner start: %s\n", otThreadErrorToString(error));
+  }
+}
+
+static void start_thread(void)
+{
+  otError error = otThreadSetEnabled(sInstance, true);
+
+  if(error)
+  {
+      fprintf(stderr, "sim remote thread start: %s\n", otThreadErrorToString(error));
+  }
+}
+
+// straight out, or held for the slot, a change of mind while held replaces
+// the answer but keeps the time of the first press
+static void answer(char choice)
+{
+  uint32_t slot_at;
+
+  if(held_answer != 0)
+  {
+      held_answer = choice;
+      return;
+  }
+
+  slot_at = question_at + (uint32_t)my_id * slot_ms;
+  if(question_heard && slot_ms > 0 && my_id != NO_ID && (int32_t)(slot_at - now_ms()) > 0)
+  {
+      held_answer  = choice;
+      held_pressed = now_us();
+      held_until   = slot_at;
+      return;
+  }
+
+  post_answer(choice, now_us());
+}
+
+static void post_answer(char answer, uint64_t pressed)
+{
+  otError       error     = OT_ERROR_NONE;
+  otMessage     *message  = NULL;
+  otMessageInfo info;
+  request_t     *request  = NULL;
+  char          payload[] = "answer: X";
+  char          stamp[24] = "";
+  uint8_t       sealed[8 + sizeof(payload) - 1 + TAG_SIZE];
+  uint8_t       aad[8 + 1 + sizeof(stamp)];
+
+  if(!attached)
+  {
+      printf("sim remote skipped\n");
+      return;
+  }
+
+  if(secure && secure_state != SECURE_READY)
+  {
+      wait_for_session(answer, pressed);
+      return;
+  }
+
+  for(uint32_t i = 0; i < MAX_IN_FLIGHT; i++)
+  {
+      if(!requests[i].used)
+      {
+          request = &requests[i];
+          break;
+      }
+  }
+  if(request == NULL)
+  {
+      printf("sim remote busy\n");
+      return;
+  }
+
+  message = otCoapNewMessage(sInstance, NULL);
+  if(message == NULL)
+  {
+      error = OT_ERROR_NO_BUFS;
+      goto exit;
+  }
+
+  otCoapMessageInit(message, OT_COAP_TYPE_CONFIRMABLE, OT_COAP_CODE_POST);
+  otCoapMessageGenerateToken(message, OT_COAP_DEFAULT_TOKEN_LENGTH);
+
+  error = otCoapMessageAppendUriPathOptions(message, secure ? SIM_SEALED_URI : SIM_ANSWER_URI);
+  if(error)
+  {
+      goto exit;
+  }
+
+  if(stamp_answers && beacon_heard)
+  {
+      snprintf(stamp, sizeof(stamp), "t=%u.%llu", beacon_sequence, (unsigned long long)(pressed - beacon_at));
+      error = otCoapMessageAppendUriQueryOption(message, stamp);
+      if(error)
+      {
+          goto exit;
+      }
+  }
+
+  error = otCoapMessageSetPayloadMarker(message);
+  if(error)
+  {
+      goto exit;
+  }
+
+  // the base station reads the answer from the ninth byte
+  payload[8] = answer;
+  if(secure)
+  {
+      // session id and sequence, then the answer, the stamp is authenticated
+      // along with the header
+      sequence++;
+      memcpy(&sealed[0], &session, 4);
+      memcpy(&sealed[4], &sequence, 4);
+      memcpy(&sealed[8], payload, sizeof(payload) - 1);
+      memcpy(aad, sealed, 8);
+      aad[8] = (uint8_t)strlen(stamp);
+      memcpy(&aad[9], stamp, aad[8]);
+      seal(sequence, aad, stamp[0] ? 9u + aad[8] : 8u, &sealed[8], sizeof(payload) - 1,
+           &sealed[8 + sizeof(payload) - 1]);
+      error = otMessageAppend(message, sealed, sizeof(sealed));
+  }
+  else
+  {
+      error = otMessageAppend(message, payload, sizeof(payload) - 1);
+  }
+  if(error)
+  {
+      goto exit;
+  }
+
+  memset(&info, 0, sizeof(info));
+  info.mPeerPort = OT_DEFAULT_COAP_PORT;
+  error = otThreadGetLeaderRloc(sInstance, &info.mPeerAddr);
+  if(error)
+  {
+      goto exit;
+  }
+
+  request->used       = true;
+  request->sent       = now_ms();
+  request->pressed    = (uint32_t)(pressed / 1000u);
+  request->pressed_us = pressed;
+  request->answer     = answer;
+
+  error = otCoapSendRequestWithParameters(sInstance, message, &info, response_handler, request, &tx_parameters);
+  if(error)
+  {
+      request->used = false;
+  }
+
+exit:
+  if(error)
+  {
+      if(message != NULL)
+      {
+          otMessageFree(message);
+      }
+
+      if(error == OT_ERROR_NO_BUFS)
+      {
+          printf("sim remote nobufs\n");
+      }
+      else
+      {
+          fprintf(stderr, "sim remote post: %s\n", otThreadErrorToString(error));
+      }
+  }
+}
+
+static void response_handler(void *context, otMessage *message, const otMessageInfo *info, otError result)
+{
+  request_t *request  = context;
+  uint32_t  rtt       = now_ms() - request->sent;
+  uint32_t  latency   = now_ms() - request->pressed;
+  uint32_t  retx      = 0;
+  uint8_t   status[4];
+
+  (void)info;
+
+  request->used = false;
+
+  if(result != OT_ERROR_NONE)
+  {
+      printf("sim remote lost %lu\n", (unsigned long)rtt);
+      return;
+  }
+
+  // the session isn't cached, bring it back and send the answer again
+  if(secure && otCoapMessageGetCode(message) == OT_COAP_CODE_UNAUTHORIZED)
+  {
+      if(secure_state == SECURE_READY)
+      {
+          secure_state = SECURE_RESUMING;
+          send_resume();
+      }
+      wait_for_session(request->answer, request->pressed_us);
+      return;
+  }
+
+  // a late answer to an earlier copy can't be told apart, count it as the
+  // retransmission that was already out
+  while(retx < tx_parameters.mMaxRetransmit
+        && rtt >= tx_parameters.mAckTimeout * ((1u << (retx + 1)) - 1u))
+  {
+      retx++;
+  }
+
+  // status, question and our id
+  if(otMessageRead(message, otMessageGetOffset(message), status, sizeof(status)) == sizeof(status))
+  {
+      my_id = (uint16_t)(status[2] | (status[3] << 8));
+  }
+
+  printf("sim remote ack %lu %lu %lu\n", (unsigned long)rtt, (unsigned long)retx, (unsigned long)latency);
+}
+
+// the base station's time beacon, only the sequence number is needed
+static void beacon_handler(void *context, otMessage *message, const otMessageInfo *info)
+{
+  uint8_t sequence;
+
+  (void)context;
+  (void)info;
+
+  if(otMessageRead(message, otMessageGetOffset(message), &sequence, sizeof(sequence)) != sizeof(sequence))
+  {
+      return;
+  }
+
+  beacon_sequence = sequence;
+  beacon_at       = now_us();
+  beacon_heard    = true;
+}
+
+// question u8, choices u8, ack spread u16, answer slot u16, little-endian, text
+static void question_handler(void *context, otMessage *message, const otMessageInfo *info)
+{
+  uint8_t   header[6];
+  uint16_t  spread;
+  bool      multicast = (info->mSockAddr.mFields.m8[0] == 0xff);
+
+  (void)context;
+
+  if(otMessageRead(message, otMessageGetOffset(message), header, sizeof(header)) != sizeof(header))
+  {
+      return;
+  }
+
+  if(!question_heard || header[0] != question)
+  {
+      question_heard = true;
+      question       = header[0];
+      question_at    = now_ms();
+      slot_ms        = (uint16_t)(header[4] | (header[5] << 8));
+      printf("sim remote question %u %s\n", question, multicast ? "multicast" : "unicast");
+  }
+
+  // a repeat means the ack was lost, send it again
+  spread               = (uint16_t)(header[2] | (header[3] << 8));
+  question_ack_due     = now_ms() + (spread ? (uint32_t)rand() % (spread + 1u) : 0u);
+  question_ack_pending = true;
+}
+
+static void send_question_ack(void)
+{
+  otError       error     = OT_ERROR_NONE;
+  otMessage     *message  = NULL;
+  otMessageInfo info;
+
+  message = otCoapNewMessage(sInstance, NULL);
+  if(message == NULL)
+  {
+      error = OT_ERROR_NO_BUFS;
+      goto exit;
+  }
+
+  otCoapMessageInit(message, OT_COAP_TYPE_NON_CONFIRMABLE, OT_COAP_CODE_POST);
+  otCoapMessageGenerateToken(message, OT_COAP_DEFAULT_TOKEN_LENGTH);
+
+  error = otCoapMessageAppendUriPathOptions(message, SIM_QUESTION_ACK_URI);
+  if(error)
+  {
+      goto exit;
+  }
+
+  error = otCoapMessageSetPayloadMarker(message);
+  if(error)
+  {
+      goto exit;
+  }
+
+  error = otMessageAppend(message, &question, sizeof(question));
+  if(error)
+  {
+      goto exit;
+  }
+
+  memset(&info, 0, sizeof(info));
+  info.mPeerPort = OT_DEFAULT_COAP_PORT;
+  error = otThreadGetLeaderRloc(sInstance, &info.mPeerAddr);
+  if(error)
+  {
+      goto exit;
+  }
+
+  error = otCoapSendRequest(sInstance, message, &info, NULL, NULL);
+
+exit:
+  if(error)
+  {
+      if(message != NULL)
+      {
+          otMessageFree(message);
+      }
+      fprintf(stderr, "sim remote question ack: %s\n", otThreadErrorToString(error));
+  }
+}
+
+static void secure_connect(void)
+{
+  otSockAddr  address;
+  otError     error;
+
+  memset(&address, 0, sizeof(address));
+  address.mPort = OT_DEFAULT_COAP_SECURE_PORT;
+  error = otThreadGetLeaderRloc(sInstance, &address.mAddress);
+  if(error == OT_ERROR_NONE)
+  {
+      error = otCoapSecureConnect(sInstance, &address, connect_handler, NULL);
+  }
+
+  if(attempts++ == 0)
+  {
+      handshake_started = now_ms();
+  }
+  connect_at   = now_ms();
+  secure_state = SECURE_CONNECTING;
+
+  if(error)
+  {
+      // the timeout in the loop tries again
+      fprintf(stderr, "sim remote secure connect: %s\n", otThreadErrorToString(error));
+  }
+}
+
+static void connect_handler(bool connected, void *context)
+{
+  otError   error     = OT_ERROR_NONE;
+  otMessage *message  = NULL;
+
+  (void)context;
+
+  if(!connected)
+  {
+      // closed before a session came back, the loop tries again
+      if(secure_state == SECURE_CONNECTING)
+      {
+          secure_state = SECURE_NONE;
+          connect_at   = now_ms() + RETRY_MS + (uint32_t)rand() % RETRY_MS;
+      }
+      return;
+  }
+
+  message = otCoapNewMessage(sInstance, NULL);
+  if(message == NULL)
+  {
+      error = OT_ERROR_NO_BUFS;
+      goto exit;
+  }
+
+  otCoapMessageInit(message, OT_COAP_TYPE_CONFIRMABLE, OT_COAP_CODE_POST);
+  otCoapMessageGenerateToken(message, OT_COAP_DEFAULT_TOKEN_LENGTH);
+
+  error = otCoapMessageAppendUriPathOptions(message, SIM_SESSION_URI);
+  if(error)
+  {
+      goto exit;
+  }
+
+  error = otCoapSecureSendRequest(sInstance, message, session_handler, NULL);
+
+exit:
+  if(error)
+  {
+      if(message != NULL)
+      {
+          otMessageFree(message);
+      }
+      fprintf(stderr, "sim remote session: %s\n", otThreadErrorToString(error));
+      otCoapSecureDisconnect(sInstance);
+  }
+}
+
+// session id u32, key, ticket
+static void session_handler(void *context, otMessage *message, const otMessageInfo *info, otError result)
+{
+  uint8_t   payload[4 + KEY_SIZE + TICKET_SIZE];
+  char      waiting = waiting_answer;
+
+  (void)context;
+  (void)info;
+
+  if(result != OT_ERROR_NONE || otCoapMessageGetCode(message) != OT_COAP_CODE_CREATED
+     || otMessageRead(message, otMessageGetOffset(message), payload, sizeof(payload)) != sizeof(payload))
+  {
+      otCoapSecureDisconnect(sInstance);
+      return;
+  }
+
+  memcpy(&session, &payload[0], 4);
+  memcpy(session_key, &payload[4], KEY_SIZE);
+  memcpy(ticket, &payload[4 + KEY_SIZE], TICKET_SIZE);
+  sequence     = 0;
+  secure_state = SECURE_READY;
+
+  // free the endpoint for the next remote
+  otCoapSecureDisconnect(sInstance);
+
+  printf("sim remote handshake %lu %lu\n", (unsigned long)(now_ms() - handshake_started), (unsigned long)attempts);
+  attempts = 0;
+
+  if(waiting != 0)
+  {
+      waiting_answer = 0;
+      post_answer(waiting, waiting_pressed);
+  }
+}
+
+// ticket, sequence u32, tag over both
+static void send_resume(void)
+{
+  otError       error     = OT_ERROR_NONE;
+  otMessage     *message  = NULL;
+  otMessageInfo info;
+  uint8_t       payload[TICKET_SIZE + 4 + TAG_SIZE];
+
+  message = otCoapNewMessage(sInstance, NULL);
+  if(message == NULL)
+  {
+      error = OT_ERROR_NO_BUFS;
+      goto exit;
+  }
+
+  otCoapMessageInit(message, OT_COAP_TYPE_CONFIRMABLE, OT_COAP_CODE_POST);
+  otCoapMessageGenerateToken(message, OT_COAP_DEFAULT_TOKEN_LENGTH);
+
+  error = otCoapMessageAppendUriPathOptions(message, SIM_RESUME_URI);
+  if(error)
+  {
+      goto exit;
+  }
+
+  error = otCoapMessageSetPayloadMarker(message);
+  if(error)
+  {
+      goto exit;
+  }
+
+  sequence++;
+  memcpy(payload, ticket, TICKET_SIZE);
+  memcpy(&payload[TICKET_SIZE], &sequence, 4);
+  seal(sequence, payload, TICKET_SIZE + 4, NULL, 0, &payload[TICKET_SIZE + 4]);
+
+  error = otMessageAppend(message, payload, sizeof(payload));
+  if(error)
+  {
+      goto exit;
+  }
+
+  memset(&info, 0, sizeof(info));
+  info.mPeerPort = OT_DEFAULT_COAP_PORT;
+  error = otThreadGetLeaderRloc(sInstance, &info.mPeerAddr);
+  if(error)
+  {
+      goto exit;
+  }
+
+  resume_sent = now_ms();
+  error = otCoapSendRequestWithParameters(sInstance, message, &info, resume_handler, NULL, &tx_parameters);
+
+exit:
+  if(error)
+  {
+      if(message != NULL)
+      {
+          otMessageFree(message);
+      }
+      fprintf(stderr, "sim remote resume: %s\n", otThreadErrorToString(error));
+      secure_state = SECURE_READY;
+  }
+}
+
+static void resume_handler(void *context, otMessage *message, const otMessageInfo *info, otError result)
+{
+  char waiting = waiting_answer;
+
+  (void)context;
+  (void)info;
+
+  if(result != OT_ERROR_NONE)
+  {
+      // lost, the next answer tries again
+      secure_state = SECURE_READY;
+  }
+  else if(otCoapMessageGetCode(message) == OT_COAP_CODE_CHANGED)
+  {
+      secure_state = SECURE_READY;
+      printf("sim remote resumed %lu\n", (unsigned long)(now_ms() - resume_sent));
+  }
+  else
+  {
+      // the ticket is no good, start over
+      secure_state = SECURE_NONE;
+      connect_at   = now_ms();
+      return;
+  }
+
+  if(waiting != 0)
+  {
+      waiting_answer = 0;
+      post_answer(waiting, waiting_pressed);
+  }
+}
+
+// one answer waits for the session, a later one replaces it but keeps the
+// time of the first press
+static void wait_for_session(char answer, uint64_t pressed)
+{
+  if(waiting_answer == 0)
+  {
+      waiting_pressed = pressed;
+  }
+  waiting_answer = answer;
+}
+
+// AES-128-CCM under the session key, nonce session id and sequence number, in
+// place, little-endian like the host
+static void seal(uint32_t number, const uint8_t *aad, size_t aad_length, uint8_t *data, size_t length, uint8_t *tag)
+{
+  uint8_t nonce[NONCE_SIZE] = {0};
+
+  memcpy(&nonce[0], &session, 4);
+  memcpy(&nonce[4], &number, 4);
+
+  mbedtls_ccm_setkey(&ccm, MBEDTLS_CIPHER_ID_AES, session_key, KEY_SIZE * 8);
+  mbedtls_ccm_encrypt_and_tag(&ccm, length, nonce, NONCE_SIZE, aad, aad_length, data, data, tag, TAG_SIZE);
+}
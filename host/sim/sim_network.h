@@ -0,0 +1,63 @@
+/***************************************************************************//**
+ * @file
+ * @brief Network Credentials Shared by the Simulation Nodes
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#ifndef SIM_NETWORK_H_
+#define SIM_NETWORK_H_
+
+/*
+ * Fixed credentials for simulation runs that skip commissioning: the base
+ * station commits them as its active dataset and the remotes attach with
+ * them directly.
+ */
+
+#define SIM_NETWORK_KEY         { 0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, \
+                                  0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff }
+#define SIM_EXTENDED_PANID      { 0xc1, 0x1c, 0xc1, 0x1c, 0x00, 0x00, 0x00, 0x01 }
+#define SIM_MESH_LOCAL_PREFIX   { 0xfd, 0x00, 0x0c, 0x11, 0xc0, 0x00, 0x00, 0x00 }
+#define SIM_PANID               0xc11cu
+#define SIM_CHANNEL             15u
+
+#define SIM_ANSWER_URI          "question/answer"
+#define SIM_TIME_URI            "time"                // ANSWER_TIME_URI
+#define SIM_QUESTION_URI        "question"            // QUESTION_PUBLISH_URI
+#define SIM_QUESTION_ACK_URI    "question/ack"        // QUESTION_PUBLISH_ACK_URI
+#define SIM_SESSION_URI         "session"             // COAP_SECURE_SESSION_URI
+#define SIM_RESUME_URI          "session/resume"      // COAP_SECURE_RESUME_URI
+#define SIM_SEALED_URI          "question/sealed"     // COAP_SECURE_ANSWER_URI
+#define SIM_PSK                 "OpenClickerPSK"      // COAP_SECURE_PSK
+#define SIM_PSK_IDENTITY        "clicker"             // COAP_SECURE_PSK_IDENTITY
+
+#endif /* SIM_NETWORK_H_ */
@@ -0,0 +1,361 @@
+#!/usr/bin/env python3
+#
+# Copyright 2022 Silicon Laboratories Inc. www.silabs.com
+# SPDX-License-Identifier: Zlib
+#
+# Classroom scale runs on the OpenThread simulation platform: one
+# base_station_sim node and N remote_sim nodes, which answer a number of
+# questions in a given burst pattern. Reports, per swarm size, the answers
+# acknowledged per second, the ACK round trip percentiles, retransmissions,
+# losses and how close the base station came to running out of message
+# buffers. Also how long the question descriptor took to reach the remotes,
+# and how many only got it from a unicast repair.
+#
+#   swarm.py --base build/base_station_sim --remote build/remote_sim
+#   swarm.py --base ... --remote ... --nodes 300 --pattern uniform --window 5000
+#   swarm.py --base ... --remote ... --nodes 20 --join
+#   swarm.py --base ... --remote ... --nodes 150 --slots    # against the same without --slots
+#   swarm.py --base ... --remote ... --nodes 150 --secure --flush
+#
+# Patterns, all within --window ms of the question:
+#
+#   storm     everyone answers at the same moment
+#   uniform   answers spread evenly over the window
+#   reaction  log-normal reaction times, most answers early, a long tail
+#
+# --changes makes each remote change its mind that many times later in the
+# window. --slots has the base station hand out answer slots by remote id,
+# see question_publish.h, the latency from the press then includes the wait
+# for the slot. A warm-up question, not counted, goes first either way so
+# that every remote has its id.
+#
+# --secure seals the answers under sessions from a DTLS handshake, see
+# coap_secure.h. The warm-up question then waits for every remote to have a
+# session, and the report adds the handshakes and resumes, the session cache
+# hit rate, the handshake time as the remotes saw it, queueing for the DTLS
+# endpoint included, and the RAM per cached session. A base station built
+# with PROF_ENABLE also reports the mean ns to open a sealed answer. --flush
+# empties the session cache before every question, so that every remote has
+# to resume.
+#
+# The nodes run in real time, in a scratch directory each so that no settings
+# carry over between runs.
+
+import argparse
+import os
+import random
+import selectors
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+ANSWERS     = 'ABCD'
+WAKE_PERIOD = 0.1       # s, keeps the base station sleeptimers on time
+FAST_WAKE   = 0.005     # s, every node while a question goes out, for the ack delays and repair pacing
+SLOT_WINDOW = 2000      # ms, QUESTION_PUBLISH_SLOT_WINDOW_MS
+
+
+class Node:
+    def __init__(self, args, cwd):
+        self.proc = subprocess.Popen(args, cwd=cwd, stdin=subprocess.PIPE, stdout=subprocess.PIPE,
+                                     stderr=subprocess.DEVNULL, bufsize=0)
+        self.partial = b''
+        self.attached = False
+
+    def send(self, data):
+        try:
+            self.proc.stdin.write(data)
+        except (BrokenPipeError, OSError):
+            pass
+
+    def close(self):
+        self.send(b'q')
+        try:
+            self.proc.wait(timeout=2)
+        except subprocess.TimeoutExpired:
+            self.proc.kill()
+            self.proc.wait()
+
+
+class Swarm:
+    def __init__(self, opts, count):
+        self.opts = opts
+        self.dir = tempfile.mkdtemp(prefix='swarm')
+        self.selector = selectors.DefaultSelector()
+        self.last_wake = 0.0
+        self.fast_until = 0.0
+        self.events = []
+        self.reached = {}
+        self.handshakes = []
+        self.resumes = 0
+
+        base_args = [opts.base] + ([] if opts.join else ['-d']) + ['1']
+        self.base = self.add(Node(base_args, self.dir))
+        self.base_ready = False
+        self.base_report = None
+
+        self.remotes = []
+        self.start = time.monotonic()
+        self.wait_for(lambda: self.base_ready, opts.settle)
+
+        remote_args = [opts.remote, '-a', str(opts.ack_timeout), '-m', str(opts.max_retransmit)]
+        if opts.join:
+            remote_args += ['-k', opts.pskd]
+        if opts.secure:
+            remote_args += ['-s']
+        for node_id in range(2, count + 2):
+            self.remotes.append(self.add(Node(remote_args + [str(node_id)], self.dir)))
+
+        if opts.join:
+            self.base.send(b'j')
+        self.base.send(b's' if opts.slots else b'f')
+
+    def add(self, node):
+        self.selector.register(node.proc.stdout, selectors.EVENT_READ, node)
+        return node
+
+    def close(self):
+        for node in self.remotes + [self.base]:
+            node.close()
+        shutil.rmtree(self.dir, ignore_errors=True)
+
+    def attached(self):
+        return sum(1 for node in self.remotes if node.attached)
+
+    def poll(self, timeout):
+        now = time.monotonic()
+        period = FAST_WAKE if now < self.fast_until else WAKE_PERIOD
+        if now - self.last_wake >= period:
+            for node in [self.base] + (self.remotes if period == FAST_WAKE else []):
+                node.send(b'.')
+            self.last_wake = now
+
+        for key, _ in self.selector.select(min(timeout, period)):
+            node = key.data
+            data = os.read(key.fileobj.fileno(), 65536)
+            if not data:
+                self.selector.unregister(key.fileobj)
+                continue
+            lines = (node.partial + data).split(b'\n')
+            node.partial = lines.pop()
+            for line in lines:
+                self.line(node, line.decode(errors='replace').strip(), time.monotonic())
+
+    def line(self, node, line, when):
+        if node is self.base:
+            if 'coap ready' in line:
+                self.base_ready = True
+            elif line.startswith('sim base '):
+                self.base_report = parse_pairs(line[len('sim base '):])
+            return
+
+        if not line.startswith('sim remote '):
+            return
+        fields = line.split()[2:]
+        if fields[0] == 'attached':
+            node.attached = True
+        elif fields[0] == 'question':
+            self.reached.setdefault(node, (when, fields[2]))
+        elif fields[0] == 'handshake':
+            self.handshakes.append(int(fields[1]))
+        elif fields[0] == 'resumed':
+            self.resumes += 1
+        else:
+            self.events.append((when, fields))
+
+    def wait_for(self, done, timeout):
+        deadline = time.monotonic() + timeout
+        while not done() and time.monotonic() < deadline:
+            self.poll(deadline - time.monotonic())
+        return done()
+
+    def question(self):
+        opts = self.opts
+        schedule = []
+        for node in self.remotes:
+            if not node.attached:
+                continue
+            for _ in range(1 + opts.changes):
+                schedule.append((answer_time(opts.pattern, opts.window), node, random.choice(ANSWERS)))
+        schedule.sort(key=lambda entry: entry[0])
+
+        self.events = []
+        self.reached = {}
+        if opts.flush:
+            self.base.send(b'x')
+        self.base.send(b'n')
+        start = time.monotonic()
+        fast = opts.publish_window + (opts.window + SLOT_WINDOW if opts.slots else 0)
+        self.fast_until = start + fast / 1000.0
+
+        for offset, node, answer in schedule:
+            while time.monotonic() < start + offset / 1000.0:
+                self.poll(start + offset / 1000.0 - time.monotonic())
+            node.send(answer.encode())
+
+        # every request ends in one event, wait out the last retransmission
+        drain = opts.ack_timeout * (2 ** (opts.max_retransmit + 1) - 1) / 1000.0 + 1.0
+        self.wait_for(lambda: len(self.events) >= len(schedule), drain)
+        self.wait_for(lambda: time.monotonic() >= self.fast_until, fast / 1000.0)
+
+        return start, len(schedule), self.events, self.reached
+
+    def report(self):
+        self.base_report = None
+        self.base.send(b'r')
+        self.wait_for(lambda: self.base_report is not None, 5)
+        return self.base_report or {}
+
+
+def parse_pairs(text):
+    words = text.split()
+    return dict(zip(words[0::2], words[1::2]))
+
+
+def answer_time(pattern, window):
+    if pattern == 'storm':
+        return 0.0
+    if pattern == 'uniform':
+        return random.uniform(0, window)
+    # median at a fifth of the window
+    return min(window, random.lognormvariate(0, 0.6) * window / 5.0)
+
+
+def percentile(values, p):
+    if not values:
+        return 0
+    values = sorted(values)
+    return values[min(len(values) - 1, int(len(values) * p / 100.0))]
+
+
+def run(opts, count):
+    swarm = Swarm(opts, count)
+    totals = {'sent': 0, 'ack': 0, 'lost': 0, 'nobufs': 0, 'busy': 0, 'skipped': 0, 'retx': 0}
+    rtts = []
+    latencies = []
+    rates = []
+    reach = []
+    repaired = 0
+    missed = 0
+
+    try:
+        if not swarm.base_ready:
+            print('base station did not come up', file=sys.stderr)
+            return None
+
+        swarm.wait_for(lambda: swarm.attached() == count, opts.settle)
+
+        # registers the remotes, which learn their ids from the acks, and
+        # gets them their sessions one handshake at a time
+        swarm.question()
+        if opts.secure:
+            swarm.wait_for(lambda: len(swarm.handshakes) >= swarm.attached(), opts.settle)
+        swarm.wait_for(lambda: False, opts.interval / 1000.0)
+
+        for _ in range(opts.questions):
+            start, sent, events, reached = swarm.question()
+            totals['sent'] += sent
+
+            reach += [int((when - start) * 1000) for when, _ in reached.values()]
+            repaired += sum(1 for _, how in reached.values() if how == 'unicast')
+            missed += sum(1 for node in swarm.remotes if node.attached and node not in reached)
+
+            acked = [when for when, fields in events if fields[0] == 'ack']
+            if acked:
+                rates.append(len(acked) / max(max(acked) - start, 0.001))
+
+            for _, fields in events:
+                totals[fields[0]] = totals.get(fields[0], 0) + 1
+                if fields[0] == 'ack':
+                    rtts.append(int(fields[1]))
+                    totals['retx'] += int(fields[2])
+                    latencies.append(int(fields[3]))
+
+            # let the network settle before the next question
+            swarm.wait_for(lambda: False, opts.interval / 1000.0)
+
+        base = swarm.report()
+    finally:
+        swarm.close()
+
+    return {
+        'nodes':    count,
+        'attached': swarm.attached(),
+        'rate':     sum(rates) / len(rates) if rates else 0.0,
+        'p50':      percentile(rtts, 50),
+        'p95':      percentile(rtts, 95),
+        'p99':      percentile(rtts, 99),
+        'max':      max(rtts) if rtts else 0,
+        'lat50':    percentile(latencies, 50),
+        'lat99':    percentile(latencies, 99),
+        'reach50':  percentile(reach, 50),
+        'reach95':  percentile(reach, 95),
+        'reachmax': max(reach) if reach else 0,
+        'repaired': repaired,
+        'missed':   missed,
+        'hs50':     percentile(swarm.handshakes, 50),
+        'hsmax':    max(swarm.handshakes) if swarm.handshakes else 0,
+        'resumes':  swarm.resumes,
+        'base':     base,
+        **totals,
+    }
+
+
+def secure_columns(result):
+    base = result['base']
+    hits = int(base.get('hits', 0))
+    misses = int(base.get('misses', 0))
+    hit_rate = 100.0 * hits / (hits + misses) if hits + misses else 0.0
+    return ('  {:>10} {:>7} {:5.1f} '.format(base.get('handshakes', '?'), base.get('resumed', '?'), hit_rate)
+            + '{hs50:7} {hsmax:5}'.format(**result)
+            + '  {:>9} {:>8}'.format(base.get('session_bytes', '?'), base.get('secure_ns', '-')))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--base', required=True, help='base_station_sim binary')
+    parser.add_argument('--remote', required=True, help='remote_sim binary')
+    parser.add_argument('--nodes', default='50,150,300', help='swarm sizes, comma separated')
+    parser.add_argument('--pattern', default='storm', choices=['storm', 'uniform', 'reaction'])
+    parser.add_argument('--window', type=int, default=3000, help='ms over which a question is answered')
+    parser.add_argument('--changes', type=int, default=0, help='changes of mind per remote and question')
+    parser.add_argument('--questions', type=int, default=3)
+    parser.add_argument('--interval', type=int, default=5000, help='ms of quiet between questions')
+    parser.add_argument('--publish-window', type=int, default=1500,
+                        help='ms the question descriptor gets to reach every remote')
+    parser.add_argument('--ack-timeout', type=int, default=2000, help='CoAP ACK timeout in ms')
+    parser.add_argument('--max-retransmit', type=int, default=4)
+    parser.add_argument('--slots', action='store_true', help='answer slots by remote id')
+    parser.add_argument('--secure', action='store_true', help='sealed answers, see coap_secure.h')
+    parser.add_argument('--flush', action='store_true', help='empty the session cache before every question')
+    parser.add_argument('--join', action='store_true', help='commission the remotes instead of fixed credentials')
+    parser.add_argument('--pskd', default='J01NME')
+    parser.add_argument('--settle', type=float, default=120, help='s to wait for the network to come up')
+    parser.add_argument('--seed', type=int, default=1)
+    opts = parser.parse_args()
+
+    random.seed(opts.seed)
+
+    print('nodes attached  sent  acked  lost nobufs  busy   votes/s  rtt p50   p95   p99   max  retx  '
+          'lat p50   p99  base buf min/total exhausted  reach p50   p95   max repaired missed'
+          + ('  handshakes resumed  hit%  hs p50   max  B/session  open ns' if opts.secure else ''))
+    for count in (int(n) for n in opts.nodes.split(',')):
+        result = run(opts, count)
+        if result is None:
+            return 1
+        base = result['base']
+        print('{nodes:5} {attached:8} {sent:5} {ack:6} {lost:5} {nobufs:6} {busy:5} {rate:9.1f} '
+              '{p50:7} {p95:5} {p99:5} {max:5} {retx:5}  {lat50:7} {lat99:5}  '.format(**result)
+              + '{:>8}/{:<5} {:>9}  '.format(base.get('min_free', '?'), base.get('buffers', '?'),
+                                            base.get('exhausted', '?'))
+              + '{reach50:9} {reach95:5} {reachmax:5} {repaired:8} {missed:6}'.format(**result)
+              + (secure_columns(result) if opts.secure else ''))
+        sys.stdout.flush()
+
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
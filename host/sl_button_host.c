@@ -0,0 +1,56 @@
+/***************************************************************************//**
+ * @file
+ * @brief Host Stand-In for the Simple Button Instances
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#include <stddef.h>
+
+#include "sl_simple_button_instances.h"
+
+sl_button_t sl_button_btn0 = { .context = NULL, .state = SL_SIMPLE_BUTTON_RELEASED };
+sl_button_t sl_button_btn1 = { .context = NULL, .state = SL_SIMPLE_BUTTON_RELEASED };
+
+sl_button_state_t sl_button_get_state(const sl_button_t *handle)
+{
+  return handle->state;
+}
+
+void sl_button_host_set_state(sl_button_t *handle, sl_button_state_t state)
+{
+  if(handle->state != state)
+  {
+      handle->state = state;
+      sl_button_on_change(handle);
+  }
+}
@@ -0,0 +1,67 @@
+/***************************************************************************//**
+ * @file
+ * @brief Host Stand-In for the Simple LED Instances
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#include "sl_simple_led_instances.h"
+
+// the handles are const, the state lives next to them
+static sl_led_host_t  led0;
+static sl_led_host_t  led1;
+
+const sl_led_t sl_led_led0 = { .context = &led0 };
+const sl_led_t sl_led_led1 = { .context = &led1 };
+
+void sl_led_turn_on(const sl_led_t *led_handle)
+{
+  ((sl_led_host_t *)led_handle->context)->state = SL_LED_CURRENT_STATE_ON;
+}
+
+void sl_led_turn_off(const sl_led_t *led_handle)
+{
+  ((sl_led_host_t *)led_handle->context)->state = SL_LED_CURRENT_STATE_OFF;
+}
+
+void sl_led_toggle(const sl_led_t *led_handle)
+{
+  sl_led_host_t *led = led_handle->context;
+
+  led->state = (led->state == SL_LED_CURRENT_STATE_ON) ? SL_LED_CURRENT_STATE_OFF : SL_LED_CURRENT_STATE_ON;
+  led->toggles++;
+}
+
+sl_led_state_t sl_led_get_state(const sl_led_t *led_handle)
+{
+  return ((sl_led_host_t *)led_handle->context)->state;
+}
@@ -0,0 +1,220 @@
+/***************************************************************************//**
+ * @file
+ * @brief Host Stand-In for the Sleeptimer Service
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#include <stddef.h>
+#include <time.h>
+
+#include "sl_sleeptimer.h"
+
+static  sl_sleeptimer_timer_handle_t*   timers;
+static  bool                            virtual_clock;
+static  uint64_t                        virtual_ticks;
+
+uint64_t sl_sleeptimer_get_tick_count64(void)
+{
+  struct timespec ts;
+
+  if(virtual_clock)
+  {
+      return virtual_ticks;
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return (uint64_t)ts.tv_sec * SL_SLEEPTIMER_HOST_FREQUENCY
+         + ((uint64_t)ts.tv_nsec * SL_SLEEPTIMER_HOST_FREQUENCY) / 1000000000ull;
+}
+
+uint32_t sl_sleeptimer_get_tick_count(void)
+{
+  return (uint32_t)sl_sleeptimer_get_tick_count64();
+}
+
+uint32_t sl_sleeptimer_get_timer_frequency(void)
+{
+  return SL_SLEEPTIMER_HOST_FREQUENCY;
+}
+
+uint32_t sl_sleeptimer_tick_to_ms(uint32_t tick)
+{
+  return (uint32_t)(((uint64_t)tick * 1000u) / SL_SLEEPTIMER_HOST_FREQUENCY);
+}
+
+uint32_t sl_sleeptimer_ms_to_tick(uint16_t time_ms)
+{
+  return (uint32_t)(((uint64_t)time_ms * SL_SLEEPTIMER_HOST_FREQUENCY) / 1000u);
+}
+
+sl_status_t sl_sleeptimer_ms32_to_tick(uint32_t time_ms, uint32_t *tick)
+{
+  *tick = (uint32_t)(((uint64_t)time_ms * SL_SLEEPTIMER_HOST_FREQUENCY) / 1000u);
+
+  return SL_STATUS_OK;
+}
+
+static sl_status_t start(sl_sleeptimer_timer_handle_t *handle, uint32_t timeout_ms, uint32_t period_ms,
+                         sl_sleeptimer_timer_callback_t callback, void *callback_data)
+{
+  uint32_t ticks;
+
+  if(handle == NULL)
+  {
+      return SL_STATUS_NULL_POINTER;
+  }
+
+  if(handle->running)
+  {
+      return SL_STATUS_INVALID_STATE;
+  }
+
+  sl_sleeptimer_ms32_to_tick(timeout_ms, &ticks);
+
+  handle->callback      = callback;
+  handle->callback_data = callback_data;
+  handle->expiry        = sl_sleeptimer_get_tick_count64() + ticks;
+  sl_sleeptimer_ms32_to_tick(period_ms, &handle->period);
+  handle->running       = true;
+  handle->next          = timers;
+  timers                = handle;
+
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_sleeptimer_start_timer_ms(sl_sleeptimer_timer_handle_t *handle, uint32_t timeout_ms,
+                                         sl_sleeptimer_timer_callback_t callback, void *callback_data,
+                                         uint8_t priority, uint16_t option_flags)
+{
+  (void)priority;
+  (void)option_flags;
+
+  return start(handle, timeout_ms, 0, callback, callback_data);
+}
+
+sl_status_t sl_sleeptimer_start_periodic_timer_ms(sl_sleeptimer_timer_handle_t *handle, uint32_t timeout_ms,
+                                                  sl_sleeptimer_timer_callback_t callback, void *callback_data,
+                                                  uint8_t priority, uint16_t option_flags)
+{
+  (void)priority;
+  (void)option_flags;
+
+  return start(handle, timeout_ms, timeout_ms, callback, callback_data);
+}
+
+sl_status_t sl_sleeptimer_restart_timer_ms(sl_sleeptimer_timer_handle_t *handle, uint32_t timeout_ms,
+                                           sl_sleeptimer_timer_callback_t callback, void *callback_data,
+                                           uint8_t priority, uint16_t option_flags)
+{
+  (void)priority;
+  (void)option_flags;
+
+  sl_sleeptimer_stop_timer(handle);
+
+  return start(handle, timeout_ms, 0, callback, callback_data);
+}
+
+sl_status_t sl_sleeptimer_stop_timer(sl_sleeptimer_timer_handle_t *handle)
+{
+  sl_sleeptimer_timer_handle_t **link;
+
+  if(handle == NULL)
+  {
+      return SL_STATUS_NULL_POINTER;
+  }
+
+  for(link = &timers; *link != NULL; link = &(*link)->next)
+  {
+      if(*link == handle)
+      {
+          *link = handle->next;
+          break;
+      }
+  }
+
+  if(!handle->running)
+  {
+      return SL_STATUS_INVALID_STATE;
+  }
+
+  handle->running = false;
+
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_sleeptimer_is_timer_running(sl_sleeptimer_timer_handle_t *handle, bool *running)
+{
+  if(handle == NULL || running == NULL)
+  {
+      return SL_STATUS_NULL_POINTER;
+  }
+
+  *running = handle->running;
+
+  return SL_STATUS_OK;
+}
+
+void sl_sleeptimer_host_process(void)
+{
+  sl_sleeptimer_timer_handle_t  *timer;
+  uint64_t                      now = sl_sleeptimer_get_tick_count64();
+
+  // restart the scan after every callback, it may start or stop timers
+  for(timer = timers; timer != NULL; )
+  {
+      if(timer->running && timer->expiry <= now)
+      {
+          if(timer->period)
+          {
+              timer->expiry += timer->period;
+          }
+          else
+          {
+              sl_sleeptimer_stop_timer(timer);
+          }
+
+          timer->callback(timer, timer->callback_data);
+          timer = timers;
+          continue;
+      }
+
+      timer = timer->next;
+  }
+}
+
+void sl_sleeptimer_host_set_ticks(uint64_t ticks)
+{
+  virtual_clock = true;
+  virtual_ticks = ticks;
+}
@@ -0,0 +1,135 @@
+/***************************************************************************//**
+ * @file
+ * @brief Host Stand-in for the VCOM UART DMA
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#include <string.h>
+
+#include "uart_dma_host.h"
+
+static  const uint8_t*          in_flight;
+static  uint32_t                in_flight_length;
+static  uint64_t                in_flight_us;       // line time the transfer needs
+static  uint64_t                elapsed_us;
+static  bool                    busy;
+static  uint32_t                baud;
+static  FILE*                   sink;
+static  uart_dma_done_t         done_callback;
+static  uart_dma_host_stats_t   stats;
+
+static void complete(void)
+{
+  if(sink != NULL)
+  {
+      fwrite(in_flight, 1, in_flight_length, sink);
+  }
+
+  busy = false;
+  stats.completed++;
+  stats.bytes   += in_flight_length;
+  stats.line_us += in_flight_us;
+
+  if(done_callback != NULL)
+  {
+      done_callback(in_flight_length);
+  }
+}
+
+sl_status_t uart_dma_init(uart_dma_done_t on_done)
+{
+  done_callback = on_done;
+  busy          = false;
+
+  return SL_STATUS_OK;
+}
+
+sl_status_t uart_dma_start(const uint8_t *data, uint32_t length)
+{
+  if(busy)
+  {
+      stats.rejected++;
+      return SL_STATUS_BUSY;
+  }
+
+  in_flight         = data;
+  in_flight_length  = length;
+  in_flight_us      = baud ? ((uint64_t)length * 10u * 1000000u + baud - 1u) / baud : 0;
+  busy              = true;
+  stats.started++;
+
+  if(baud == 0)
+  {
+      complete();
+  }
+
+  return SL_STATUS_OK;
+}
+
+bool uart_dma_busy(void)
+{
+  return busy;
+}
+
+void uart_dma_host_set_sink(FILE *file)
+{
+  sink = file;
+}
+
+void uart_dma_host_set_baud(uint32_t rate)
+{
+  baud = rate;
+}
+
+void uart_dma_host_advance(uint32_t time_us)
+{
+  // an idle line saves nothing up
+  if(!busy)
+  {
+      elapsed_us = 0;
+      return;
+  }
+
+  elapsed_us += time_us;
+  if(elapsed_us >= in_flight_us)
+  {
+      // what is left over goes to the transfer the callback may start
+      elapsed_us -= in_flight_us;
+      complete();
+  }
+}
+
+void uart_dma_host_stats_get(uart_dma_host_stats_t *out)
+{
+  *out = stats;
+}
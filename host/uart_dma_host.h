@@ -0,0 +1,64 @@
+/***************************************************************************//**
+ * @file
+ * @brief Host Stand-in for the VCOM UART DMA
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#ifndef UART_DMA_HOST_H_
+#define UART_DMA_HOST_H_
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "uart_dma.h"
+
+typedef struct {
+  uint32_t  started;      // transfers handed to the "dma"
+  uint32_t  completed;    // completion callbacks fired
+  uint32_t  rejected;     // starts refused because a transfer was in flight
+  uint64_t  bytes;
+  uint64_t  line_us;      // time the line spent sending
+} uart_dma_host_stats_t;
+
+// where the bytes go once sent, NULL drops them
+void uart_dma_host_set_sink(FILE *sink);
+
+// 8N1 line rate, 0 completes each transfer right away (the default)
+void uart_dma_host_set_baud(uint32_t baud);
+
+// let time pass on the line, completes the transfer once all of it is out
+void uart_dma_host_advance(uint32_t time_us);
+
+void uart_dma_host_stats_get(uart_dma_host_stats_t *stats);
+
+#endif /* UART_DMA_HOST_H_ */
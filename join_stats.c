@@ -0,0 +1,345 @@
+/***************************************************************************//**
+ * @file
+ * @brief Commissioning Telemetry
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#include <string.h>
+
+#include "sl_sleeptimer.h"
+#include "printf.h"
+
+#include "join_stats.h"
+#include "coap_diag.h"
+#include "gui_event_queue.h"
+
+#define JOIN_STATS_EXPORT_VERSION   1u
+
+#define ARRAY_SIZE(a)               (sizeof(a) / sizeof((a)[0]))
+
+typedef struct {
+  otExtAddress  id;
+  bool          used;
+  bool          ended;            // counted, kept until its REMOVED comes in
+  uint8_t       reached;          // last OT_COMMISSIONER_JOINER_* event
+  uint32_t      at[OT_COMMISSIONER_JOINER_END + 1];   // ticks
+} session_t;
+
+static session_t *find_session(const otExtAddress *aJoinerId, bool create);
+static void close_session(session_t *session, bool joined);
+static void record(join_phase_t phase, uint32_t ms);
+static void post_summary(void);
+
+static  session_t     sessions[JOIN_STATS_MAX_SESSIONS];
+static  join_stats_t  stats;
+
+void join_stats_reset(void)
+{
+  memset(&stats, 0, sizeof(stats));
+}
+
+void join_stats_event(otCommissionerJoinerEvent aEvent, const otExtAddress *aJoinerId)
+{
+  session_t *session;
+  uint32_t  now = sl_sleeptimer_get_tick_count();
+
+  if(aJoinerId == NULL)
+  {
+      return;
+  }
+
+  switch(aEvent) {
+    case OT_COMMISSIONER_JOINER_START:
+      session = find_session(aJoinerId, false);
+      if(session == NULL)
+      {
+          session = find_session(aJoinerId, true);
+      }
+      else if(session->ended)
+      {
+          // the joiner is back after its last session was counted
+          memset(session->at, 0, sizeof(session->at));
+          session->ended = false;
+      }
+      else
+      {
+          // a new dtls session from the same joiner, the last one got lost
+          stats.restarted++;
+      }
+      session->reached                          = aEvent;
+      session->at[OT_COMMISSIONER_JOINER_START] = now;
+      break;
+
+    case OT_COMMISSIONER_JOINER_CONNECTED:
+    case OT_COMMISSIONER_JOINER_FINALIZE:
+      session = find_session(aJoinerId, false);
+      if(session != NULL && !session->ended)
+      {
+          session->reached      = aEvent;
+          session->at[aEvent]   = now;
+      }
+      break;
+
+    case OT_COMMISSIONER_JOINER_END:
+      session = find_session(aJoinerId, false);
+      if(session != NULL && !session->ended)
+      {
+          // the dtls session also ends on a failed handshake or a wrong pskd
+          session->at[aEvent] = now;
+          close_session(session, session->reached == OT_COMMISSIONER_JOINER_FINALIZE);
+      }
+      break;
+
+    case OT_COMMISSIONER_JOINER_REMOVED:
+      // also sent when the roster removes a joiner after its end, or when a
+      // finalized joiner's entry expires, those were counted at the end
+      session = find_session(aJoinerId, false);
+      if(session != NULL)
+      {
+          if(!session->ended)
+          {
+              close_session(session, false);
+          }
+          session->used = false;
+      }
+      else
+      {
+          // expired before the joiner ever showed up
+          stats.failed[JOIN_PHASE_TOTAL]++;
+          post_summary();
+      }
+      break;
+
+    default:
+      break;
+  }
+}
+
+const join_stats_t *join_stats_get(void)
+{
+  return &stats;
+}
+
+uint32_t join_stats_finished(void)
+{
+  uint32_t finished = stats.joined;
+
+  for(uint32_t i = 0; i < JOIN_PHASE_COUNT; i++)
+  {
+      finished += stats.failed[i];
+  }
+
+  return finished;
+}
+
+uint32_t join_stats_percentile(uint8_t p)
+{
+  uint32_t target = (stats.joined * p + 99u) / 100u;
+  uint32_t seen   = 0;
+
+  if(stats.joined == 0)
+  {
+      return 0;
+  }
+
+  // upper edge of the bucket holding the percentile, the max for the last one
+  for(uint32_t b = 0; b < JOIN_STATS_BUCKETS - 1u; b++)
+  {
+      seen += stats.buckets[JOIN_PHASE_TOTAL][b];
+      if(seen >= target)
+      {
+          return (1000u << b) < stats.max_ms[JOIN_PHASE_TOTAL] ? (1000u << b) : stats.max_ms[JOIN_PHASE_TOTAL];
+      }
+  }
+
+  return stats.max_ms[JOIN_PHASE_TOTAL];
+}
+
+const char *join_stats_event_name(otCommissionerJoinerEvent aEvent)
+{
+  static const char *const names[] = {"start", "connected", "finalize", "end", "removed"};
+
+  return ((size_t)aEvent < ARRAY_SIZE(names)) ? names[aEvent] : "unknown";
+}
+
+const char *join_stats_commissioner_state_name(otCommissionerState aState)
+{
+  static const char *const names[] = {"disabled", "petition", "active"};
+
+  return ((size_t)aState < ARRAY_SIZE(names)) ? names[aState] : "unknown";
+}
+
+size_t join_stats_export(uint8_t *buffer, size_t size)
+{
+  uint8_t *p = buffer;
+
+  if(size < JOIN_STATS_EXPORT_SIZE)
+  {
+      return 0;
+  }
+
+  *p++ = JOIN_STATS_EXPORT_VERSION;
+  *p++ = JOIN_STATS_BUCKETS;
+  p    = coap_diag_put_u32(p, stats.joined);
+  p    = coap_diag_put_u32(p, stats.restarted);
+
+  for(uint32_t i = 0; i < JOIN_PHASE_COUNT; i++)
+  {
+      p = coap_diag_put_u32(p, stats.failed[i]);
+      p = coap_diag_put_u32(p, stats.max_ms[i]);
+      for(uint32_t b = 0; b < JOIN_STATS_BUCKETS; b++)
+      {
+          p = coap_diag_put_u32(p, stats.buckets[i][b]);
+      }
+  }
+
+  return (size_t)(p - buffer);
+}
+
+static session_t *find_session(const otExtAddress *aJoinerId, bool create)
+{
+  session_t *slot = NULL;
+
+  for(uint32_t i = 0; i < JOIN_STATS_MAX_SESSIONS; i++)
+  {
+      if(sessions[i].used && memcmp(&sessions[i].id, aJoinerId, sizeof(otExtAddress)) == 0)
+      {
+          return &sessions[i];
+      }
+  }
+
+  if(!create)
+  {
+      return NULL;
+  }
+
+  // a free slot, else one that only waits for its REMOVED
+  for(uint32_t i = 0; i < JOIN_STATS_MAX_SESSIONS; i++)
+  {
+      if(!sessions[i].used)
+      {
+          slot = &sessions[i];
+          break;
+      }
+      if(sessions[i].ended)
+      {
+          slot = &sessions[i];
+      }
+  }
+
+  // table full, give up on the session that has been going longest
+  if(slot == NULL)
+  {
+      slot = &sessions[0];
+      for(uint32_t i = 1; i < JOIN_STATS_MAX_SESSIONS; i++)
+      {
+          if((int32_t)(sessions[i].at[OT_COMMISSIONER_JOINER_START] - slot->at[OT_COMMISSIONER_JOINER_START]) < 0)
+          {
+              slot = &sessions[i];
+          }
+      }
+      close_session(slot, false);
+  }
+
+  memset(slot, 0, sizeof(*slot));
+  slot->id   = *aJoinerId;
+  slot->used = true;
+
+  return slot;
+}
+
+static void close_session(session_t *session, bool joined)
+{
+  const uint32_t *at = session->at;
+
+  if(joined)
+  {
+      stats.joined++;
+
+      // a joiner may skip ahead, phases without both ends are left out
+      if(at[OT_COMMISSIONER_JOINER_CONNECTED])
+      {
+          record(JOIN_PHASE_HANDSHAKE, sl_sleeptimer_tick_to_ms(at[OT_COMMISSIONER_JOINER_CONNECTED] - at[OT_COMMISSIONER_JOINER_START]));
+      }
+      if(at[OT_COMMISSIONER_JOINER_CONNECTED] && at[OT_COMMISSIONER_JOINER_FINALIZE])
+      {
+          record(JOIN_PHASE_COMMISSION, sl_sleeptimer_tick_to_ms(at[OT_COMMISSIONER_JOINER_FINALIZE] - at[OT_COMMISSIONER_JOINER_CONNECTED]));
+      }
+      if(at[OT_COMMISSIONER_JOINER_FINALIZE])
+      {
+          record(JOIN_PHASE_FINALIZE, sl_sleeptimer_tick_to_ms(at[OT_COMMISSIONER_JOINER_END] - at[OT_COMMISSIONER_JOINER_FINALIZE]));
+      }
+      record(JOIN_PHASE_TOTAL, sl_sleeptimer_tick_to_ms(at[OT_COMMISSIONER_JOINER_END] - at[OT_COMMISSIONER_JOINER_START]));
+  }
+  else
+  {
+      switch(session->reached) {
+        case OT_COMMISSIONER_JOINER_START:      stats.failed[JOIN_PHASE_HANDSHAKE]++;   break;
+        case OT_COMMISSIONER_JOINER_CONNECTED:  stats.failed[JOIN_PHASE_COMMISSION]++;  break;
+        default:                                stats.failed[JOIN_PHASE_FINALIZE]++;    break;
+      }
+  }
+
+  session->ended = true;
+  post_summary();
+}
+
+static void record(join_phase_t phase, uint32_t ms)
+{
+  uint32_t bucket = 0;
+
+  while(bucket < JOIN_STATS_BUCKETS - 1u && ms >= (1000u << bucket))
+  {
+      bucket++;
+  }
+
+  stats.buckets[phase][bucket]++;
+  if(ms > stats.max_ms[phase])
+  {
+      stats.max_ms[phase] = ms;
+  }
+}
+
+// the status line under the network info
+static void post_summary(void)
+{
+  gui_event_t gui_event = {
+      .flag = GUI_EVENT_FLAG_JOIN,
+      .msg  = {0},
+  };
+
+  snprintf(gui_event.msg, GUI_EVENT_MSG_SIZE, "join: %u/%u p95 %us",
+           (uint16_t)stats.joined, (uint16_t)join_stats_finished(),
+           (uint16_t)((join_stats_percentile(95) + 999u) / 1000u));
+  gui_event_queue_add(&gui_event);
+}
@@ -0,0 +1,100 @@
+/***************************************************************************//**
+ * @file
+ * @brief Commissioning Telemetry Header
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#ifndef JOIN_STATS_H_
+#define JOIN_STATS_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include <openthread/commissioner.h>
+
+#include "base_station_config.h"
+
+/*
+ * Per-joiner session timing. Sessions are keyed by joiner id and hold the
+ * time of each commissioner event; when a session ends after finalize, its
+ * phase durations go into histograms, and when it ends before, is removed or
+ * is abandoned, it is counted as a failure at the last phase it reached. An
+ * ended session is kept until the joiner is removed, so the REMOVED that
+ * follows is not counted again; a REMOVED without a session is a joiner that
+ * never showed up. The table holds JOIN_STATS_MAX_SESSIONS sessions, the
+ * oldest is abandoned to make room.
+ */
+
+typedef enum {
+  JOIN_PHASE_HANDSHAKE,     // start to connected, dtls with the joiner
+  JOIN_PHASE_COMMISSION,    // connected to finalize
+  JOIN_PHASE_FINALIZE,      // finalize to end
+  JOIN_PHASE_TOTAL,         // start to end
+  JOIN_PHASE_COUNT
+} join_phase_t;
+
+#define JOIN_STATS_BUCKETS    8u    // bucket n holds [2^(n-1), 2^n) seconds, the last is open ended
+
+typedef struct {
+  uint32_t  joined;
+  uint32_t  restarted;                    // start again before the end, joiner retried
+  uint32_t  failed[JOIN_PHASE_COUNT];     // by the phase that did not complete, TOTAL for never started
+  uint32_t  max_ms[JOIN_PHASE_COUNT];
+  uint32_t  buckets[JOIN_PHASE_COUNT][JOIN_STATS_BUCKETS];
+} join_stats_t;
+
+void join_stats_reset(void);
+
+// commissioner joiner callback, aJoinerId may be NULL
+void join_stats_event(otCommissionerJoinerEvent aEvent, const otExtAddress *aJoinerId);
+
+const join_stats_t *join_stats_get(void);
+
+// sessions that completed or failed
+uint32_t join_stats_finished(void);
+
+// p-th percentile of the total join time in ms, from the histogram, so only
+// accurate to the bucket
+uint32_t join_stats_percentile(uint8_t p);
+
+// event and state names, "unknown" for values the table does not cover
+const char *join_stats_event_name(otCommissionerJoinerEvent aEvent);
+const char *join_stats_commissioner_state_name(otCommissionerState aState);
+
+// little-endian dump for diag/join, returns the length or 0 if size is short
+size_t join_stats_export(uint8_t *buffer, size_t size);
+
+#define JOIN_STATS_EXPORT_SIZE  (2 + 4 + 4 + JOIN_PHASE_COUNT * (4 + 4 + 4 * JOIN_STATS_BUCKETS))
+
+#endif /* JOIN_STATS_H_ */
@@ -0,0 +1,68 @@
+/***************************************************************************//**
+ * @file
+ * @brief Log Level Filtering
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#include "logging.h"
+
+uint8_t log_runtime_level[LOG_MODULE_COUNT] = {
+  [LOG_MODULE_BASE_STATION]   = LOG_RUNTIME_LEVEL,
+  [LOG_MODULE_COAP]           = LOG_RUNTIME_LEVEL,
+  [LOG_MODULE_GUI]            = LOG_RUNTIME_LEVEL,
+};
+
+const uint8_t log_compile_level[LOG_MODULE_COUNT] = {
+  [LOG_MODULE_BASE_STATION]   = LOG_LEVEL_BASE_STATION,
+  [LOG_MODULE_COAP]           = LOG_LEVEL_COAP,
+  [LOG_MODULE_GUI]            = LOG_LEVEL_GUI,
+};
+
+void log_set_level(log_module_t module, uint8_t level)
+{
+  if(level > LOG_LEVEL_DBG)
+  {
+      level = LOG_LEVEL_DBG;
+  }
+
+  if(module < LOG_MODULE_COUNT)
+  {
+      log_runtime_level[module] = level;
+      return;
+  }
+
+  for(uint32_t i = 0; i < LOG_MODULE_COUNT; i++)
+  {
+      log_runtime_level[i] = level;
+  }
+}
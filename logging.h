@@ -0,0 +1,120 @@
+/***************************************************************************//**
+ * @file
+ * @brief Log Level Filtering Header
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#ifndef LOGGING_H_
+#define LOGGING_H_
+
+#include <stdint.h>
+
+#include "base_station_config.h"
+#include "dlog.h"
+
+/*
+ * Leveled logging on top of DLOG(). Each source file names its module before
+ * including this header:
+ *
+ *   #define LOG_MODULE  GUI
+ *   #include "logging.h"
+ *
+ * Calls above the module's compile-time level (LOG_LEVEL_GUI, see
+ * base_station_config.h) are removed by the preprocessor together with their
+ * arguments. The remaining calls are also checked against a runtime level per
+ * module, which can be changed over CoAP (diag/log).
+ */
+
+#define LOG_LEVEL_NONE      0u
+#define LOG_LEVEL_ERR       1u
+#define LOG_LEVEL_WRN       2u
+#define LOG_LEVEL_INF       3u
+#define LOG_LEVEL_DBG       4u
+
+typedef enum {
+  LOG_MODULE_BASE_STATION,
+  LOG_MODULE_COAP,
+  LOG_MODULE_GUI,
+  LOG_MODULE_COUNT
+} log_module_t;
+
+// runtime levels, indexed by log_module_t
+extern uint8_t log_runtime_level[LOG_MODULE_COUNT];
+
+// compile-time levels, indexed by log_module_t
+extern const uint8_t log_compile_level[LOG_MODULE_COUNT];
+
+// set the runtime level of one module, or of all of them with LOG_MODULE_COUNT
+void log_set_level(log_module_t module, uint8_t level);
+
+#define LOG_CAT(a, b)               LOG_CAT_(a, b)
+#define LOG_CAT_(a, b)              a##b
+
+#if defined(LOG_MODULE)
+
+#define LOG_MODULE_ID               LOG_CAT(LOG_MODULE_, LOG_MODULE)
+#define LOG_MODULE_LEVEL            LOG_CAT(LOG_LEVEL_, LOG_MODULE)
+
+#define LOG_AT_(level, ...)         do {                                            \
+                                      if((level) <= log_runtime_level[LOG_MODULE_ID]) { \
+                                          DLOG(__VA_ARGS__);                        \
+                                      }                                             \
+                                    } while(0)
+
+#if LOG_MODULE_LEVEL >= LOG_LEVEL_ERR
+#define LOG_ERR(...)                LOG_AT_(LOG_LEVEL_ERR, __VA_ARGS__)
+#else
+#define LOG_ERR(...)                do { } while(0)
+#endif
+
+#if LOG_MODULE_LEVEL >= LOG_LEVEL_WRN
+#define LOG_WRN(...)                LOG_AT_(LOG_LEVEL_WRN, __VA_ARGS__)
+#else
+#define LOG_WRN(...)                do { } while(0)
+#endif
+
+#if LOG_MODULE_LEVEL >= LOG_LEVEL_INF
+#define LOG_INF(...)                LOG_AT_(LOG_LEVEL_INF, __VA_ARGS__)
+#else
+#define LOG_INF(...)                do { } while(0)
+#endif
+
+#if LOG_MODULE_LEVEL >= LOG_LEVEL_DBG
+#define LOG_DBG(...)                LOG_AT_(LOG_LEVEL_DBG, __VA_ARGS__)
+#else
+#define LOG_DBG(...)                do { } while(0)
+#endif
+
+#endif /* LOG_MODULE */
+
+#endif /* LOGGING_H_ */
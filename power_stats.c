@@ -0,0 +1,198 @@
+/***************************************************************************//**
+ * @file
+ * @brief Sleep and Wake-Up Instrumentation
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#include <string.h>
+
+#include "em_core.h"
+#include "sl_sleeptimer.h"
+
+#include "sl_component_catalog.h"
+#ifdef SL_CATALOG_POWER_MANAGER_PRESENT
+#include "sl_power_manager.h"
+#endif
+
+#define LOG_MODULE  BASE_STATION
+#include "logging.h"
+
+#include "base_station_config.h"
+#include "power_stats.h"
+
+static  uint32_t          window_start;     // ticks
+static  uint32_t          sleep_start;
+static  uint32_t          sleep_ticks;
+static  uint32_t          sleeps;
+static  bool              asleep;
+
+static  volatile uint32_t signal_tick;
+static  volatile bool     signalled;
+static  uint32_t          wakeups;
+static  uint32_t          latency_min;      // ticks
+static  uint32_t          latency_max;
+static  uint64_t          latency_sum;
+
+static  uint32_t          last_report;
+
+#ifdef SL_CATALOG_POWER_MANAGER_PRESENT
+static void on_em_transition(sl_power_manager_em_t from, sl_power_manager_em_t to);
+
+static  sl_power_manager_em_transition_event_handle_t     em_handle;
+static  const sl_power_manager_em_transition_event_info_t em_info = {
+    .event_mask = SL_POWER_MANAGER_EVENT_TRANSITION_LEAVING_EM0 | SL_POWER_MANAGER_EVENT_TRANSITION_ENTERING_EM0,
+    .on_event   = on_em_transition,
+};
+
+static void on_em_transition(sl_power_manager_em_t from, sl_power_manager_em_t to)
+{
+  uint32_t now = sl_sleeptimer_get_tick_count();
+
+  if(from == SL_POWER_MANAGER_EM0)
+  {
+      sleep_start = now;
+      asleep      = true;
+      sleeps++;
+  }
+  else if(to == SL_POWER_MANAGER_EM0 && asleep)
+  {
+      sleep_ticks += now - sleep_start;
+      asleep       = false;
+  }
+}
+#endif
+
+static uint32_t ticks_to_us(uint32_t ticks)
+{
+  return (uint32_t)(((uint64_t)ticks * 1000000u) / sl_sleeptimer_get_timer_frequency());
+}
+
+void power_stats_init(void)
+{
+  power_stats_reset();
+  last_report = sl_sleeptimer_get_tick_count();
+
+#ifdef SL_CATALOG_POWER_MANAGER_PRESENT
+  sl_power_manager_subscribe_em_transition_event(&em_handle, &em_info);
+#endif
+}
+
+void power_stats_reset(void)
+{
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+
+  window_start = sl_sleeptimer_get_tick_count();
+  sleep_ticks  = 0;
+  sleeps       = 0;
+  wakeups      = 0;
+  latency_min  = UINT32_MAX;
+  latency_max  = 0;
+  latency_sum  = 0;
+
+  CORE_EXIT_ATOMIC();
+}
+
+void power_stats_signal(void)
+{
+  // only the first signal of a batch counts, that is the one waiting longest
+  if(!signalled)
+  {
+      signal_tick = sl_sleeptimer_get_tick_count();
+      signalled   = true;
+  }
+}
+
+void power_stats_serviced(void)
+{
+  uint32_t latency;
+
+  if(!signalled)
+  {
+      return;
+  }
+
+  latency   = sl_sleeptimer_get_tick_count() - signal_tick;
+  signalled = false;
+
+  wakeups++;
+  latency_sum += latency;
+  latency_min  = (latency < latency_min) ? latency : latency_min;
+  latency_max  = (latency > latency_max) ? latency : latency_max;
+}
+
+void power_stats_get(power_stats_t *stats)
+{
+  uint32_t now, window, idle;
+
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+
+  now    = sl_sleeptimer_get_tick_count();
+  window = now - window_start;
+  idle   = sleep_ticks + (asleep ? now - sleep_start : 0);
+
+  stats->window_ms            = sl_sleeptimer_tick_to_ms(window);
+  stats->idle_permille        = window ? (uint16_t)(((uint64_t)idle * 1000u) / window) : 0;
+  stats->sleeps               = sleeps;
+  stats->wakeups              = wakeups;
+  stats->wake_latency_min_us  = wakeups ? ticks_to_us(latency_min) : 0;
+  stats->wake_latency_max_us  = ticks_to_us(latency_max);
+  stats->wake_latency_mean_us = wakeups ? ticks_to_us((uint32_t)(latency_sum / wakeups)) : 0;
+
+  CORE_EXIT_ATOMIC();
+}
+
+void power_stats_process(void)
+{
+  power_stats_t stats;
+
+  if(POWER_STATS_REPORT_MS == 0
+     || sl_sleeptimer_tick_to_ms(sl_sleeptimer_get_tick_count() - last_report) < POWER_STATS_REPORT_MS)
+  {
+      return;
+  }
+
+  last_report = sl_sleeptimer_get_tick_count();
+
+  power_stats_get(&stats);
+  // deferred like the other console output, two lines for the argument limit
+  LOG_INF("power: idle %u.%u%%, %lu sleeps\r\n",
+          stats.idle_permille / 10, stats.idle_permille % 10, (unsigned long)stats.sleeps);
+  LOG_INF("power: wake latency min/mean/max %lu/%lu/%lu us\r\n",
+          (unsigned long)stats.wake_latency_min_us,
+          (unsigned long)stats.wake_latency_mean_us,
+          (unsigned long)stats.wake_latency_max_us);
+
+  power_stats_reset();
+}
@@ -0,0 +1,67 @@
+/***************************************************************************//**
+ * @file
+ * @brief Sleep and Wake-Up Instrumentation Header
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#ifndef POWER_STATS_H_
+#define POWER_STATS_H_
+
+#include <stdint.h>
+
+typedef struct {
+  uint32_t  window_ms;              // time covered by the figures below
+  uint16_t  idle_permille;          // share of the window spent below EM0
+  uint32_t  sleeps;                 // number of times the core went to sleep
+  uint32_t  wakeups;                // signalled work items serviced
+  uint32_t  wake_latency_min_us;    // signal to main loop pickup
+  uint32_t  wake_latency_max_us;
+  uint32_t  wake_latency_mean_us;
+} power_stats_t;
+
+// init, subscribes to energy mode transitions
+void power_stats_init(void);
+
+// work was signalled, safe to call from interrupt context
+void power_stats_signal(void);
+
+// the main loop picked up signalled work
+void power_stats_serviced(void);
+
+// periodic report, called from the main loop
+void power_stats_process(void);
+
+void power_stats_get(power_stats_t *stats);
+void power_stats_reset(void);
+
+#endif /* POWER_STATS_H_ */
@@ -0,0 +1,218 @@
+/***************************************************************************//**
+ * @file
+ * @brief Main Loop Cycle Profiler
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#include "prof.h"
+
+#if PROF_ENABLE
+
+#include <stdbool.h>
+#include <string.h>
+
+#if defined(__arm__)
+#include "em_device.h"
+#else
+#include <time.h>
+#endif
+
+#include "openthread-system.h"
+
+#define LOG_MODULE  BASE_STATION
+#include "logging.h"
+
+#include "coap_diag_codec.h"
+
+#define PROF_EXPORT_VERSION   1u
+
+static  prof_stat_t     stats[PROF_STAGE_COUNT];
+static  volatile bool   dump_requested;
+static  uint32_t        dump_stage = PROF_STAGE_COUNT;   // next stage to dump, COUNT when idle
+
+static  const char*     stage_names[PROF_STAGE_COUNT] = {
+    "tasklets",
+    "drivers",
+    "gui",
+    "coap",
+    "secure",
+};
+
+void prof_init(void)
+{
+#if defined(__arm__)
+  // enable the DWT cycle counter
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT       = 0;
+  DWT->CTRL        |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+
+  prof_reset();
+}
+
+uint32_t prof_now(void)
+{
+#if defined(__arm__)
+  return DWT->CYCCNT;
+#else
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return (uint32_t)((uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec);
+#endif
+}
+
+uint32_t prof_frequency(void)
+{
+#if defined(__arm__)
+  return SystemCoreClock;
+#else
+  return 1000000000u;
+#endif
+}
+
+void prof_record(prof_stage_t stage, uint32_t elapsed)
+{
+  prof_stat_t *stat = &stats[stage];
+  uint32_t    bucket = elapsed ? 32u - (uint32_t)__builtin_clz(elapsed) : 0;
+
+  stat->count++;
+  stat->sum += elapsed;
+  stat->min  = (elapsed < stat->min) ? elapsed : stat->min;
+  stat->max  = (elapsed > stat->max) ? elapsed : stat->max;
+  stat->buckets[(bucket < PROF_BUCKETS) ? bucket : PROF_BUCKETS - 1]++;
+}
+
+void prof_reset(void)
+{
+  memset(stats, 0, sizeof(stats));
+
+  for(uint32_t i = 0; i < PROF_STAGE_COUNT; i++)
+  {
+      stats[i].min = UINT32_MAX;
+  }
+}
+
+const prof_stat_t* prof_get(prof_stage_t stage)
+{
+  return (stage < PROF_STAGE_COUNT) ? &stats[stage] : NULL;
+}
+
+void prof_request_dump(void)
+{
+  dump_requested = true;
+  otSysEventSignalPending();
+}
+
+void prof_process(void)
+{
+  prof_stat_t *stat;
+
+  if(dump_requested)
+  {
+      dump_requested = false;
+      dump_stage     = 0;
+
+      LOG_INF("prof: %lu units/s\r\n", (unsigned long)prof_frequency());
+  }
+
+  // a stage per pass once the last one is written out, the whole dump at
+  // once would overrun the deferred log ring
+  if(dump_stage >= PROF_STAGE_COUNT || dlog_pending())
+  {
+      return;
+  }
+
+  stat = &stats[dump_stage];
+
+  if(stat->count > 0)
+  {
+      LOG_INF("  %-8s n=%lu\r\n", stage_names[dump_stage], (unsigned long)stat->count);
+      LOG_INF("    min=%lu mean=%lu max=%lu\r\n", (unsigned long)stat->min,
+              (unsigned long)(stat->sum / stat->count), (unsigned long)stat->max);
+
+      // only the populated buckets, "2^n: count"
+      for(uint32_t b = 0; b < PROF_BUCKETS; b++)
+      {
+          if(stat->buckets[b])
+          {
+              LOG_INF("    <2^%-2lu %lu\r\n", (unsigned long)b, (unsigned long)stat->buckets[b]);
+          }
+      }
+  }
+
+  dump_stage++;
+}
+
+/*
+ * Little endian, one header followed by a record per stage:
+ *   header: version u8, stage count u8, bucket count u8, units per second u32
+ *   stage:  count u32, min u32, max u32, mean u32, buckets u16[bucket count]
+ * Bucket counts saturate at 0xFFFF.
+ */
+size_t prof_export(uint8_t *buffer, size_t size)
+{
+  uint8_t     *p = buffer;
+  prof_stat_t *stat;
+  size_t      needed = 7 + PROF_STAGE_COUNT * (16 + 2 * PROF_BUCKETS);
+
+  if(size < needed)
+  {
+      return 0;
+  }
+
+  *p++ = PROF_EXPORT_VERSION;
+  *p++ = PROF_STAGE_COUNT;
+  *p++ = PROF_BUCKETS;
+  p    = coap_diag_put_u32(p, prof_frequency());
+
+  for(uint32_t i = 0; i < PROF_STAGE_COUNT; i++)
+  {
+      stat = &stats[i];
+
+      p = coap_diag_put_u32(p, stat->count);
+      p = coap_diag_put_u32(p, stat->count ? stat->min : 0);
+      p = coap_diag_put_u32(p, stat->max);
+      p = coap_diag_put_u32(p, stat->count ? (uint32_t)(stat->sum / stat->count) : 0);
+
+      for(uint32_t b = 0; b < PROF_BUCKETS; b++)
+      {
+          p = coap_diag_put_u16(p, (stat->buckets[b] > 0xFFFF) ? 0xFFFF : (uint16_t)stat->buckets[b]);
+      }
+  }
+
+  return (size_t)(p - buffer);
+}
+
+#endif /* PROF_ENABLE */
@@ -0,0 +1,106 @@
+/***************************************************************************//**
+ * @file
+ * @brief Main Loop Cycle Profiler Header
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#ifndef PROF_H_
+#define PROF_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "base_station_config.h"
+
+/*
+ * Per-stage min/max/mean and log2 histograms of the time spent in the main
+ * loop stages. Times are DWT cycles on target and nanoseconds on the host.
+ * With PROF_ENABLE set to 0 the macros expand to nothing and prof.c is empty.
+ */
+
+typedef enum {
+  PROF_STAGE_TASKLETS,      // otTaskletsProcess
+  PROF_STAGE_DRIVERS,       // otSysProcessDrivers
+  PROF_STAGE_GUI,           // gui_update
+  PROF_STAGE_COAP,          // coap_server_handler, per request
+  PROF_STAGE_SECURE,        // coap_secure open and resume, per request
+  PROF_STAGE_COUNT,
+} prof_stage_t;
+
+#define PROF_BUCKETS    32u   // bucket n holds times in [2^(n-1), 2^n)
+
+typedef struct {
+  uint32_t  count;
+  uint32_t  min;
+  uint32_t  max;
+  uint64_t  sum;
+  uint32_t  buckets[PROF_BUCKETS];
+} prof_stat_t;
+
+#if PROF_ENABLE
+
+#define PROF_BEGIN(stage)   uint32_t prof_start_##stage = prof_now()
+#define PROF_END(stage)     prof_record(stage, prof_now() - prof_start_##stage)
+
+// init, starts the cycle counter
+void prof_init(void);
+
+// current time in profiler units
+uint32_t prof_now(void);
+
+// profiler units per second
+uint32_t prof_frequency(void);
+
+void prof_record(prof_stage_t stage, uint32_t elapsed);
+void prof_reset(void);
+const prof_stat_t* prof_get(prof_stage_t stage);
+
+// dump to the console from the main loop, safe to call from interrupt context
+void prof_request_dump(void);
+void prof_process(void);
+
+// binary export for the diag/prof resource, returns the number of bytes used
+size_t prof_export(uint8_t *buffer, size_t size);
+
+#else
+
+#define PROF_BEGIN(stage)
+#define PROF_END(stage)
+
+#define prof_init()
+#define prof_request_dump()
+#define prof_process()
+
+#endif /* PROF_ENABLE */
+
+#endif /* PROF_H_ */
@@ -0,0 +1,451 @@
+/***************************************************************************//**
+ * @file
+ * @brief Question Start Sent to the Remotes
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#include <string.h>
+
+#include <openthread/coap.h>
+#include <openthread/random_noncrypto.h>
+#include <openthread/thread.h>
+
+#include "openthread-system.h"
+#include "sl_sleeptimer.h"
+
+#define LOG_MODULE  COAP
+#include "logging.h"
+
+#include "question_publish.h"
+#include "tally.h"
+#include "answer_time.h"
+#include "vote_journal.h"
+#include "remote_registry.h"
+#include "buffer_pressure.h"
+#include "coap_diag.h"
+
+typedef enum {
+  PUBLISH_IDLE,
+  PUBLISH_COLLECT,          // ack window running
+  PUBLISH_REPAIR,           // unicasts going out
+} publish_state_t;
+
+static void timer_handler(sl_sleeptimer_timer_handle_t *handle, void *data);
+static void ack_handler(void *aContext, otMessage *aMessage, const otMessageInfo *aMessageInfo);
+static void start_handler(void *aContext, otMessage *aMessage, const otMessageInfo *aMessageInfo);
+static bool missing(uint16_t id);
+static uint16_t count_missing(void);
+static void start_round(void);
+static void repair_next(void);
+static void finish(void);
+static otError send_descriptor(const otIp6Address *aAddress, uint16_t aSpread);
+
+static  otInstance                    *sInstance;
+static  otCoapResource                ack_resource;
+static  otCoapResource                start_resource;
+static  volatile bool                 timer_due;
+static  sl_sleeptimer_timer_handle_t  timer;
+static  publish_state_t               state;
+static  uint8_t                       round;
+static  uint16_t                      cursor;         // next id to look at in a round
+static  uint16_t                      remaining;      // ids still to look at in a round
+static  uint32_t                      published_at;   // tick
+static  uint32_t                      acked[REMOTE_REGISTRY_WORDS];
+static  uint8_t                       descriptor[QUESTION_PUBLISH_HEADER_SIZE + QUESTION_PUBLISH_TEXT_MAX];
+static  uint16_t                      descriptor_length;
+static  uint16_t                      slot_window = QUESTION_PUBLISH_SLOT_WINDOW_MS;
+static  question_publish_stats_t      stats;
+
+void question_publish_init(otInstance *aInstance)
+{
+  sInstance = aInstance;
+  state     = PUBLISH_IDLE;
+  memset(&stats, 0, sizeof(stats));
+}
+
+otError question_publish_coap_init(otInstance *aInstance)
+{
+  ack_resource.mUriPath = QUESTION_PUBLISH_ACK_URI;
+  ack_resource.mHandler = &ack_handler;
+  ack_resource.mContext = aInstance;
+  otCoapAddResource(aInstance, &ack_resource);
+
+  start_resource.mUriPath = QUESTION_PUBLISH_START_URI;
+  start_resource.mHandler = &start_handler;
+  start_resource.mContext = aInstance;
+  otCoapAddResource(aInstance, &start_resource);
+
+  return OT_ERROR_NONE;
+}
+
+sl_status_t question_publish_start(uint8_t choices, const char *text)
+{
+  size_t        length = (text != NULL) ? strlen(text) : 0;
+  uint16_t      known  = remote_registry_count();
+  uint32_t      slot   = 0;
+  otIp6Address  all_nodes;
+  otError       error;
+
+  if(choices == 0 || choices > TALLY_CHOICE_COUNT)
+  {
+      return SL_STATUS_INVALID_PARAMETER;
+  }
+
+  if(length > QUESTION_PUBLISH_TEXT_MAX)
+  {
+      length = QUESTION_PUBLISH_TEXT_MAX;
+  }
+
+  // remotes only know their ids once they are in the registry
+  if(slot_window > 0 && known > 0)
+  {
+      slot = slot_window / known;
+      slot = (slot < QUESTION_PUBLISH_SLOT_MIN_MS) ? QUESTION_PUBLISH_SLOT_MIN_MS : slot;
+  }
+
+  tally_reset();
+  answer_time_new_question();
+#if VOTE_JOURNAL_ENABLE
+  vote_journal_new_question();
+#endif
+
+  descriptor[0]     = tally_question();
+  descriptor[1]     = choices;
+  descriptor[4]     = (uint8_t)slot;
+  descriptor[5]     = (uint8_t)(slot >> 8);
+  if(length > 0)
+  {
+      memcpy(&descriptor[QUESTION_PUBLISH_HEADER_SIZE], text, length);
+  }
+  descriptor_length = (uint16_t)(QUESTION_PUBLISH_HEADER_SIZE + length);
+
+  memset(acked, 0, sizeof(acked));
+  round             = 0;
+  published_at      = sl_sleeptimer_get_tick_count();
+  stats.published++;
+  stats.known       = known;
+  stats.slot_ms     = (uint16_t)slot;
+  stats.missing     = stats.known;
+  stats.coverage_ms = 0;
+
+  otIp6AddressFromString("ff03::1", &all_nodes);
+  error = send_descriptor(&all_nodes, QUESTION_PUBLISH_ACK_SPREAD_MS);
+  if(error)
+  {
+      // the repair rounds still reach the remotes we know
+      LOG_WRN("question publish: %s\r\n", otThreadErrorToString(error));
+  }
+
+  LOG_INF("question %u published, %u choices, %lu ms slots\r\n", descriptor[0], choices, (unsigned long)slot);
+
+  state     = PUBLISH_COLLECT;
+  timer_due = false;
+  sl_sleeptimer_restart_timer_ms(&timer, QUESTION_PUBLISH_ACK_WINDOW_MS, timer_handler, NULL, 0, 0);
+
+  return SL_STATUS_OK;
+}
+
+void question_publish_set_slot_window(uint16_t window_ms)
+{
+  slot_window = window_ms;
+}
+
+void question_publish_process(void)
+{
+  if(!timer_due)
+  {
+      return;
+  }
+  timer_due = false;
+
+  switch(state) {
+    case PUBLISH_COLLECT:
+      // the ack window of the multicast or of the last round is over
+      if(round >= QUESTION_PUBLISH_REPAIR_ROUNDS || count_missing() == 0)
+      {
+          finish();
+      }
+      else
+      {
+          start_round();
+      }
+      break;
+
+    case PUBLISH_REPAIR:
+      repair_next();
+      break;
+
+    default:
+      break;
+  }
+}
+
+const question_publish_stats_t *question_publish_get_stats(void)
+{
+  return &stats;
+}
+
+static void timer_handler(sl_sleeptimer_timer_handle_t *handle, void *data)
+{
+  (void)handle;
+  (void)data;
+
+  timer_due = true;
+  otSysEventSignalPending();
+}
+
+/*
+ * question/ack
+ *
+ * Non-confirmable POST of the question id from a remote that has the question.
+ * Acks for an earlier question are ignored, the remote gets a repair.
+ */
+static void ack_handler(void *aContext, otMessage *aMessage, const otMessageInfo *aMessageInfo)
+{
+  uint8_t   question;
+  uint16_t  id;
+
+  (void)aContext;
+
+  if(otCoapMessageGetCode(aMessage) != OT_COAP_CODE_POST
+     || otMessageRead(aMessage, otMessageGetOffset(aMessage), &question, sizeof(question)) != sizeof(question)
+     || question != tally_question() || stats.published == 0)
+  {
+      return;
+  }
+
+  // first contact gets an id like an answer does
+  if(remote_registry_add(&aMessageInfo->mPeerAddr.mFields.m8[8], tally_answered(), &id) != SL_STATUS_OK
+     || (acked[id / 32u] & (1ul << (id % 32u))))
+  {
+      return;
+  }
+
+  acked[id / 32u] |= 1ul << (id % 32u);
+  stats.acks++;
+
+  if(stats.coverage_ms == 0 && count_missing() == 0)
+  {
+      stats.coverage_ms = sl_sleeptimer_tick_to_ms(sl_sleeptimer_get_tick_count() - published_at);
+  }
+}
+
+/*
+ * question/start
+ *
+ * POST with the number of answer choices, u8, and the question text starts a
+ * question. 2.04 with the new question id, 4.00 for a bad number of choices,
+ * 4.03 unless coap_diag_peer_is_local(), it resets the running question.
+ */
+static void start_handler(void *aContext, otMessage *aMessage, const otMessageInfo *aMessageInfo)
+{
+  uint8_t   payload[1 + QUESTION_PUBLISH_TEXT_MAX + 1];
+  uint16_t  length;
+
+  if(otCoapMessageGetCode(aMessage) != OT_COAP_CODE_POST)
+  {
+      coap_diag_respond(aContext, aMessage, aMessageInfo, OT_COAP_CODE_METHOD_NOT_ALLOWED, NULL, 0);
+      return;
+  }
+
+  // a remote could otherwise wipe the answers to the running question
+  if(!coap_diag_peer_is_local(aContext, aMessageInfo))
+  {
+      coap_diag_respond(aContext, aMessage, aMessageInfo, OT_COAP_CODE_FORBIDDEN, NULL, 0);
+      return;
+  }
+
+  length          = otMessageRead(aMessage, otMessageGetOffset(aMessage), payload, sizeof(payload) - 1);
+  payload[length] = '\0';
+
+  if(length < 1 || question_publish_start(payload[0], (const char *)&payload[1]) != SL_STATUS_OK)
+  {
+      coap_diag_respond(aContext, aMessage, aMessageInfo, OT_COAP_CODE_BAD_REQUEST, NULL, 0);
+      return;
+  }
+
+  payload[0] = tally_question();
+  coap_diag_respond(aContext, aMessage, aMessageInfo, OT_COAP_CODE_CHANGED, payload, 1);
+}
+
+// known to the registry and hasn't acknowledged or answered
+static bool missing(uint16_t id)
+{
+  uint32_t bit = 1ul << (id % 32u);
+
+  return !(acked[id / 32u] & bit) && !(tally_answered()[id / 32u] & bit);
+}
+
+static uint16_t count_missing(void)
+{
+  uint16_t count = 0;
+
+  for(uint16_t id = 0; id < remote_registry_count(); id++)
+  {
+      count += missing(id) ? 1u : 0u;
+  }
+
+  return count;
+}
+
+// a round walks every id once from a random one, so that remotes at the end
+// of the table aren't always served last
+static void start_round(void)
+{
+  uint16_t known = remote_registry_count();
+
+  round++;
+  stats.repair_rounds++;
+  state     = PUBLISH_REPAIR;
+  cursor    = (uint16_t)(otRandomNonCryptoGetUint32() % known);
+  remaining = known;
+
+  repair_next();
+}
+
+static void repair_next(void)
+{
+  uint16_t  known   = remote_registry_count();
+  uint32_t  gap_ms;
+
+  if(buffer_pressure_level() >= BUFFER_PRESSURE_LEAN)
+  {
+      // answers first, look again after a gap
+      sl_sleeptimer_restart_timer_ms(&timer, QUESTION_PUBLISH_REPAIR_MS, timer_handler, NULL, 0, 0);
+      return;
+  }
+
+  while(remaining > 0)
+  {
+      uint16_t id = cursor;
+
+      cursor = (uint16_t)((cursor + 1u) % known);
+      remaining--;
+
+      if(missing(id))
+      {
+          const otMeshLocalPrefix *prefix = otThreadGetMeshLocalPrefix(sInstance);
+          otIp6Address            address;
+          otError                 error;
+
+          memcpy(&address.mFields.m8[0], prefix->m8, sizeof(prefix->m8));
+          memcpy(&address.mFields.m8[8], remote_registry_iid(id), REMOTE_REGISTRY_IID_SIZE);
+
+          error = send_descriptor(&address, 0);
+          if(error)
+          {
+              LOG_DBG("question repair %u: %s\r\n", id, otThreadErrorToString(error));
+          }
+          else
+          {
+              stats.repairs++;
+          }
+
+          // the next one after half to one and a half times the mean gap
+          gap_ms = QUESTION_PUBLISH_REPAIR_MS / 2u + otRandomNonCryptoGetUint32() % (QUESTION_PUBLISH_REPAIR_MS + 1u);
+          sl_sleeptimer_restart_timer_ms(&timer, gap_ms, timer_handler, NULL, 0, 0);
+          return;
+      }
+  }
+
+  // round done, give the last repairs time to be acknowledged
+  state = PUBLISH_COLLECT;
+  sl_sleeptimer_restart_timer_ms(&timer, QUESTION_PUBLISH_ACK_WINDOW_MS, timer_handler, NULL, 0, 0);
+}
+
+static void finish(void)
+{
+  state         = PUBLISH_IDLE;
+  stats.missing = count_missing();
+
+  LOG_INF("question %u: %u of %u known remotes missing, %lu ms to reach the rest\r\n",
+          tally_question(), stats.missing, remote_registry_count(), (unsigned long)stats.coverage_ms);
+}
+
+// non-confirmable PUT of the descriptor, to all nodes or to one remote
+static otError send_descriptor(const otIp6Address *aAddress, uint16_t aSpread)
+{
+  otError       error     = OT_ERROR_NONE;
+  otMessage     *message  = NULL;
+  otMessageInfo info;
+
+  message = otCoapNewMessage(sInstance, NULL);
+  if(message == NULL)
+  {
+      error = OT_ERROR_NO_BUFS;
+      goto exit;
+  }
+
+  otCoapMessageInit(message, OT_COAP_TYPE_NON_CONFIRMABLE, OT_COAP_CODE_PUT);
+  otCoapMessageGenerateToken(message, OT_COAP_DEFAULT_TOKEN_LENGTH);
+
+  error = otCoapMessageAppendUriPathOptions(message, QUESTION_PUBLISH_URI);
+  if(error)
+  {
+      goto exit;
+  }
+
+  error = otCoapMessageSetPayloadMarker(message);
+  if(error)
+  {
+      goto exit;
+  }
+
+  descriptor[2] = (uint8_t)aSpread;
+  descriptor[3] = (uint8_t)(aSpread >> 8);
+
+  error = otMessageAppend(message, descriptor, descriptor_length);
+  if(error)
+  {
+      goto exit;
+  }
+
+  memset(&info, 0, sizeof(info));
+  info.mPeerAddr = *aAddress;
+  info.mPeerPort = OT_DEFAULT_COAP_PORT;
+
+  error = otCoapSendRequest(sInstance, message, &info, NULL, NULL);
+
+exit:
+  if(error)
+  {
+      stats.send_errors++;
+
+      if(message != NULL)
+      {
+          otMessageFree(message);
+      }
+  }
+
+  return error;
+}
@@ -0,0 +1,122 @@
+/***************************************************************************//**
+ * @file
+ * @brief Question Start Sent to the Remotes
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#ifndef QUESTION_PUBLISH_H_
+#define QUESTION_PUBLISH_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <openthread/instance.h>
+
+#include "sl_status.h"
+#include "base_station_config.h"
+
+/*
+ * Starting a question resets the tally, marks the journal, restarts the answer
+ * clock and tells the remotes. The question descriptor goes out once as a
+ * non-confirmable PUT to QUESTION_PUBLISH_URI on the realm-local all nodes
+ * address:
+ *
+ *   question u8, choices u8, ack spread in ms u16, answer slot in ms u16, text
+ *
+ * all little-endian.
+ *
+ * Every remote acknowledges with a non-confirmable POST of the question id to
+ * QUESTION_PUBLISH_ACK_URI on the base station, after a random delay up to
+ * the ack spread so that the acks don't all arrive at once. An answer to the
+ * question counts as an acknowledgment too. Acks are kept as a bitmap over
+ * the remote ids of remote_registry.h.
+ *
+ * After QUESTION_PUBLISH_ACK_WINDOW_MS the remotes known to the registry that
+ * haven't acknowledged get the descriptor again by unicast, with an ack spread
+ * of 0, one every QUESTION_PUBLISH_REPAIR_MS on average, jittered by half
+ * either way, starting at a random id. Repairs wait while the message buffers
+ * are under pressure. Up to QUESTION_PUBLISH_REPAIR_ROUNDS rounds, each
+ * followed by another ack window, or until no one is missing. Remotes that
+ * never talked to the base station only get the multicast.
+ *
+ * Answer slots spread the burst of answers when a question opens. Every remote
+ * learns its registry id from the status acknowledgment of its answers, see
+ * coap_server.h. A remote that knows its id holds back an answer given before
+ * id times the answer slot after the descriptor arrived until then, later
+ * answers go straight out. The slot is the slot window divided among the
+ * remotes in the registry, at least QUESTION_PUBLISH_SLOT_MIN_MS, and 0 when
+ * slots are off, which leaves every remote free to answer at once. Remotes
+ * without an id yet, i.e. on their first answer, are free as well.
+ *
+ * POST QUESTION_PUBLISH_START_URI with choices u8 and the text starts a
+ * question from a dashboard or a gateway, the response carries the new
+ * question id.
+ */
+
+#define QUESTION_PUBLISH_URI        "question"            // on the remotes
+#define QUESTION_PUBLISH_ACK_URI    "question/ack"
+#define QUESTION_PUBLISH_START_URI  "question/start"
+
+#define QUESTION_PUBLISH_HEADER_SIZE  6u
+
+typedef struct {
+  uint32_t  published;
+  uint32_t  acks;             // new ones, duplicates aren't counted
+  uint32_t  repairs;          // unicasts sent
+  uint32_t  repair_rounds;
+  uint32_t  send_errors;
+  // of the last question
+  uint16_t  known;            // remotes in the registry when it was published
+  uint16_t  missing;          // of those, not acknowledged at the end
+  uint32_t  coverage_ms;      // until every known remote had it, 0 if never
+  uint16_t  slot_ms;          // answer slot it went out with
+} question_publish_stats_t;
+
+void question_publish_init(otInstance *aInstance);
+
+// registers the ack and start resources on the running coap server
+otError question_publish_coap_init(otInstance *aInstance);
+
+// new question with that many answer choices and an optional text
+sl_status_t question_publish_start(uint8_t choices, const char *text);
+
+// window the answer slots divide, QUESTION_PUBLISH_SLOT_WINDOW_MS at boot,
+// 0 turns the slots off, from the next question on
+void question_publish_set_slot_window(uint16_t window_ms);
+
+// called from the main loop
+void question_publish_process(void);
+
+const question_publish_stats_t *question_publish_get_stats(void);
+
+#endif /* QUESTION_PUBLISH_H_ */
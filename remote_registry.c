@@ -0,0 +1,330 @@
+/***************************************************************************//**
+ * @file
+ * @brief Dense Ids for the Remotes
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#include <string.h>
+
+#include "nvm3.h"
+#include "nvm3_default.h"
+
+#define LOG_MODULE  BASE_STATION
+#include "logging.h"
+
+#include "remote_registry.h"
+
+#define HASH_MASK   (REMOTE_REGISTRY_HASH_SIZE - 1u)
+#define EMPTY       0xFFFFu
+#define CHUNKS      ((TALLY_MAX_REMOTES + REMOTE_REGISTRY_CHUNK - 1u) / REMOTE_REGISTRY_CHUNK)
+
+#if (REMOTE_REGISTRY_HASH_SIZE & HASH_MASK) != 0
+#error "REMOTE_REGISTRY_HASH_SIZE must be a power of two"
+#endif
+
+#if REMOTE_REGISTRY_HASH_SIZE < TALLY_MAX_REMOTES + TALLY_MAX_REMOTES / 2u
+#error "REMOTE_REGISTRY_HASH_SIZE must be at least one and a half times TALLY_MAX_REMOTES"
+#endif
+
+#if CHUNKS > 32
+#error "REMOTE_REGISTRY_CHUNK too small for TALLY_MAX_REMOTES"
+#endif
+
+#if REMOTE_REGISTRY_CHUNK * REMOTE_REGISTRY_IID_SIZE > VOTE_JOURNAL_OBJECT_SIZE
+#error "REMOTE_REGISTRY_CHUNK too large for an NVM3 object"
+#endif
+
+static uint32_t hash(const uint8_t *iid);
+static uint16_t slot_of(const uint8_t *iid);
+static void slot_insert(uint16_t id);
+static void slot_remove(uint16_t id);
+
+static  uint8_t                   iids[TALLY_MAX_REMOTES][REMOTE_REGISTRY_IID_SIZE];
+static  uint16_t                  slots[REMOTE_REGISTRY_HASH_SIZE];
+static  uint16_t                  count;
+static  uint16_t                  reuse_next;     // where to look for an id to take over
+static  uint32_t                  dirty;          // chunks to write, one bit each
+static  remote_registry_stats_t   stats;
+
+sl_status_t remote_registry_init(void)
+{
+  memset(slots, 0xFF, sizeof(slots));
+  memset(&stats, 0, sizeof(stats));
+  count       = 0;
+  reuse_next  = 0;
+  dirty       = 0;
+
+  // chunks are filled in id order, the first short or missing one ends it
+  for(uint16_t chunk = 0; chunk < CHUNKS; chunk++)
+  {
+      uint16_t  first = (uint16_t)(chunk * REMOTE_REGISTRY_CHUNK);
+      uint16_t  room  = (uint16_t)(TALLY_MAX_REMOTES - first);
+      size_t    length;
+      uint32_t  type;
+      uint16_t  n;
+
+      if(room > REMOTE_REGISTRY_CHUNK)
+      {
+          room = REMOTE_REGISTRY_CHUNK;
+      }
+
+      if(nvm3_getObjectInfo(nvm3_defaultHandle, REMOTE_REGISTRY_NVM3_KEY + chunk, &type, &length) != ECODE_NVM3_OK
+         || type != NVM3_OBJECTTYPE_DATA || length == 0 || length % REMOTE_REGISTRY_IID_SIZE != 0
+         || length > (size_t)room * REMOTE_REGISTRY_IID_SIZE
+         || nvm3_readData(nvm3_defaultHandle, REMOTE_REGISTRY_NVM3_KEY + chunk, iids[first], length) != ECODE_NVM3_OK)
+      {
+          break;
+      }
+
+      n     = (uint16_t)(length / REMOTE_REGISTRY_IID_SIZE);
+      count = (uint16_t)(first + n);
+
+      if(n < room)
+      {
+          break;
+      }
+  }
+
+  for(uint16_t id = 0; id < count; id++)
+  {
+      slot_insert(id);
+  }
+  stats.loaded = count;
+
+  if(count > 0)
+  {
+      LOG_INF("registry: %u remotes\r\n", count);
+  }
+
+  return SL_STATUS_OK;
+}
+
+uint16_t remote_registry_find(const uint8_t *iid)
+{
+  uint16_t slot = slot_of(iid);
+
+  return slots[slot];
+}
+
+sl_status_t remote_registry_add(const uint8_t *iid, const uint32_t *keep, uint16_t *id)
+{
+  uint16_t slot = slot_of(iid);
+  uint16_t new_id;
+
+  if(slots[slot] != EMPTY)
+  {
+      *id = slots[slot];
+      return SL_STATUS_OK;
+  }
+
+  if(count < TALLY_MAX_REMOTES)
+  {
+      new_id = count++;
+      stats.added++;
+  }
+  else
+  {
+      // every id is taken, hand over the next one not in the keep set
+      uint16_t i;
+
+      for(i = 0; i < TALLY_MAX_REMOTES; i++)
+      {
+          new_id = reuse_next;
+          reuse_next = (uint16_t)((reuse_next + 1u) % TALLY_MAX_REMOTES);
+
+          if(keep == NULL || !(keep[new_id / 32u] & (1ul << (new_id % 32u))))
+          {
+              break;
+          }
+      }
+
+      if(i == TALLY_MAX_REMOTES)
+      {
+          stats.full++;
+          return SL_STATUS_FULL;
+      }
+
+      slot_remove(new_id);
+      stats.reused++;
+  }
+
+  memcpy(iids[new_id], iid, REMOTE_REGISTRY_IID_SIZE);
+  slot_insert(new_id);
+  dirty |= 1ul << (new_id / REMOTE_REGISTRY_CHUNK);
+  *id = new_id;
+
+  return SL_STATUS_OK;
+}
+
+const uint8_t *remote_registry_iid(uint16_t id)
+{
+  return (id < count) ? iids[id] : NULL;
+}
+
+uint16_t remote_registry_count(void)
+{
+  return count;
+}
+
+void remote_registry_clear(void)
+{
+  memset(slots, 0xFF, sizeof(slots));
+  count       = 0;
+  reuse_next  = 0;
+  dirty       = 0;
+
+  for(uint16_t chunk = 0; chunk < CHUNKS; chunk++)
+  {
+      // most keys don't exist, that's fine
+      nvm3_deleteObject(nvm3_defaultHandle, REMOTE_REGISTRY_NVM3_KEY + chunk);
+  }
+}
+
+void remote_registry_process(void)
+{
+  for(uint16_t chunk = 0; dirty != 0 && chunk < CHUNKS; chunk++)
+  {
+      uint16_t  first = (uint16_t)(chunk * REMOTE_REGISTRY_CHUNK);
+      uint16_t  n     = (uint16_t)(count - first);
+      Ecode_t   ecode;
+
+      if(!(dirty & (1ul << chunk)))
+      {
+          continue;
+      }
+
+      if(n > REMOTE_REGISTRY_CHUNK)
+      {
+          n = REMOTE_REGISTRY_CHUNK;
+      }
+
+      ecode = nvm3_writeData(nvm3_defaultHandle, REMOTE_REGISTRY_NVM3_KEY + chunk, iids[first],
+                             (size_t)n * REMOTE_REGISTRY_IID_SIZE);
+      if(ecode != ECODE_NVM3_OK)
+      {
+          // the next pass tries again
+          stats.write_errors++;
+          LOG_WRN("registry: write 0x%lx\r\n", (unsigned long)ecode);
+          return;
+      }
+
+      dirty &= ~(1ul << chunk);
+      stats.writes++;
+  }
+}
+
+const remote_registry_stats_t *remote_registry_get_stats(void)
+{
+  return &stats;
+}
+
+// the interface identifiers of some addresses are mostly zeros, mix them all in
+static uint32_t hash(const uint8_t *iid)
+{
+  uint64_t k;
+
+  memcpy(&k, iid, sizeof(k));
+  k ^= k >> 33;
+  k *= 0xFF51AFD7ED558CCDull;
+  k ^= k >> 33;
+
+  return (uint32_t)k & HASH_MASK;
+}
+
+// slot holding the remote, or the empty slot where it would go
+static uint16_t slot_of(const uint8_t *iid)
+{
+  uint16_t slot   = (uint16_t)hash(iid);
+  uint16_t probes = 1;
+
+  while(slots[slot] != EMPTY && memcmp(iids[slots[slot]], iid, REMOTE_REGISTRY_IID_SIZE) != 0)
+  {
+      slot = (uint16_t)((slot + 1u) & HASH_MASK);
+      probes++;
+  }
+
+  if(probes > stats.max_probes)
+  {
+      stats.max_probes = probes;
+  }
+
+  return slot;
+}
+
+static void slot_insert(uint16_t id)
+{
+  uint16_t slot = slot_of(iids[id]);
+
+  // a duplicate in what was loaded keeps the lower id
+  if(slots[slot] == EMPTY)
+  {
+      slots[slot] = id;
+  }
+}
+
+// linear probing has no tombstones, entries further down the run move up
+// into the hole if their home slot allows it
+static void slot_remove(uint16_t id)
+{
+  uint16_t hole = slot_of(iids[id]);
+  uint16_t next = hole;
+
+  if(slots[hole] != id)
+  {
+      return;
+  }
+
+  for(;;)
+  {
+      uint16_t home;
+
+      next = (uint16_t)((next + 1u) & HASH_MASK);
+      if(slots[next] == EMPTY)
+      {
+          break;
+      }
+
+      home = (uint16_t)hash(iids[slots[next]]);
+
+      // stays if its home is cyclically in (hole, next]
+      if((hole <= next) ? (hole < home && home <= next) : (hole < home || home <= next))
+      {
+          continue;
+      }
+
+      slots[hole] = slots[next];
+      hole        = next;
+  }
+
+  slots[hole] = EMPTY;
+}
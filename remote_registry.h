@@ -0,0 +1,105 @@
+/***************************************************************************//**
+ * @file
+ * @brief Dense Ids for the Remotes
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#ifndef REMOTE_REGISTRY_H_
+#define REMOTE_REGISTRY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "sl_status.h"
+#include "base_station_config.h"
+
+/*
+ * Dense ids for the remotes, 0 to TALLY_MAX_REMOTES - 1, so that per remote
+ * state lives in arrays indexed by id and sets of remotes in bitmaps. A remote
+ * gets its id the first time it talks to the base station and is known by the
+ * interface identifier, the lower half, of the address it talks from. Joiner
+ * ids can't be used for this, they are a hash of the EUI-64 and don't show up
+ * in the address. Lookup is an open addressing hash table of
+ * REMOTE_REGISTRY_HASH_SIZE slots, so a few probes at most.
+ *
+ * The table is kept in NVM3 from REMOTE_REGISTRY_NVM3_KEY, the interface
+ * identifiers of REMOTE_REGISTRY_CHUNK ids per object, and reloaded at boot,
+ * so a remote keeps its id across resets and the journaled answers still
+ * point at the right remote. New ids are written out from the main loop, a
+ * burst of first contacts costs one write per chunk.
+ *
+ * Once every id is taken, a new remote takes over the id of one that isn't
+ * in the keep set passed in, normally the remotes that answered the current
+ * question.
+ */
+
+#define REMOTE_REGISTRY_IID_SIZE  8u
+#define REMOTE_ID_NONE            0xFFFFu
+
+#define REMOTE_REGISTRY_WORDS     ((TALLY_MAX_REMOTES + 31u) / 32u)   // of an id bitmap
+
+typedef struct {
+  uint32_t  added;
+  uint32_t  reused;         // ids taken over from remotes gone quiet
+  uint32_t  full;           // no id to give out
+  uint32_t  writes;         // chunk objects written
+  uint32_t  write_errors;
+  uint16_t  loaded;         // ids read back at boot
+  uint16_t  max_probes;     // longest lookup so far
+} remote_registry_stats_t;
+
+// loads the stored ids, call before anything replays answers by id
+sl_status_t remote_registry_init(void);
+
+// id of a known remote, REMOTE_ID_NONE otherwise
+uint16_t remote_registry_find(const uint8_t *iid);
+
+// id of a remote, a new one on first contact, keep is a bitmap of the ids
+// that mustn't be taken over or NULL, SL_STATUS_FULL when there's none left
+sl_status_t remote_registry_add(const uint8_t *iid, const uint32_t *keep, uint16_t *id);
+
+// interface identifier of an id, NULL if it isn't assigned
+const uint8_t *remote_registry_iid(uint16_t id);
+
+// ids handed out, ids below are assigned
+uint16_t remote_registry_count(void);
+
+// forget every remote, in RAM and in NVM3
+void remote_registry_clear(void);
+
+// called from the main loop, writes out the changed chunks
+void remote_registry_process(void);
+
+const remote_registry_stats_t *remote_registry_get_stats(void);
+
+#endif /* REMOTE_REGISTRY_H_ */
@@ -0,0 +1,319 @@
+/***************************************************************************//**
+ * @file
+ * @brief Framed Binary Results Stream on the VCOM UART
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#include "base_station_config.h"
+
+#if RESULTS_STREAM_ENABLE
+
+#include <string.h>
+
+#include "sl_sleeptimer.h"
+#include "openthread-system.h"
+
+#include "results_stream.h"
+#include "uart_dma.h"
+#include "coap_diag_codec.h"
+
+#define RING_MASK         (RESULTS_STREAM_RING_SIZE - 1u)
+#define FRAME_MAX         (RESULTS_STREAM_HEADER_SIZE + RESULTS_STREAM_BODY_MAX + RESULTS_STREAM_CRC_SIZE)
+#define ENCODED_MAX       (FRAME_MAX + FRAME_MAX / 254u + 2u)     // code bytes and delimiter
+
+static bool emit(results_stream_type_t type, const uint8_t *body, size_t length, bool reserve);
+static void send_snapshot(uint32_t now);
+static void send_delta(uint32_t now);
+static void kick(void);
+static size_t cobs_encode(const uint8_t *in, size_t length, uint8_t *out);
+
+static  uint8_t                 ring[RESULTS_STREAM_RING_SIZE];
+static  uint32_t                head;             // main loop only
+static  volatile uint32_t       tail;             // advanced by the DMA completion
+static  uint8_t                 sequence;
+static  uint32_t                dropped_reported;
+static  results_stream_stats_t  stats;
+
+static  uint32_t                delta_ticks;
+static  uint32_t                snapshot_ticks;
+static  uint32_t                last_delta;
+static  uint32_t                last_snapshot;
+static  bool                    snapshot_due;
+static  uint8_t                 sent_question;
+static  uint32_t                sent_version;
+static  uint16_t                sent_counts[TALLY_CHOICE_COUNT];
+
+_Static_assert((RESULTS_STREAM_RING_SIZE & RING_MASK) == 0, "RESULTS_STREAM_RING_SIZE must be a power of two");
+_Static_assert(RESULTS_STREAM_RING_SIZE >= 2u * ENCODED_MAX + RESULTS_STREAM_RESERVE, "RESULTS_STREAM_RING_SIZE too small");
+
+static void transfer_done(uint32_t length)
+{
+  tail += length;
+
+  // more may be waiting
+  otSysEventSignalPending();
+}
+
+sl_status_t results_stream_init(void)
+{
+  head              = 0;
+  tail              = 0;
+  sequence          = 0;
+  dropped_reported  = 0;
+  snapshot_due      = true;
+  memset(&stats, 0, sizeof(stats));
+
+  sl_sleeptimer_ms32_to_tick(RESULTS_STREAM_DELTA_MS, &delta_ticks);
+  sl_sleeptimer_ms32_to_tick(RESULTS_STREAM_SNAPSHOT_MS, &snapshot_ticks);
+
+  return uart_dma_init(transfer_done);
+}
+
+void results_stream_vote(const uint8_t *iid, char answer, uint32_t time_us)
+{
+  uint8_t body[2 + TALLY_IID_SIZE + 4];
+
+  body[0] = tally_question();
+  body[1] = (uint8_t)answer;
+  memcpy(&body[2], iid, TALLY_IID_SIZE);
+  coap_diag_put_u32(&body[2 + TALLY_IID_SIZE], time_us);
+
+  emit(RESULTS_STREAM_VOTE, body, sizeof(body), true);
+  kick();
+}
+
+void results_stream_log(const char *text, size_t length)
+{
+  // the line ending is the frame delimiter's job
+  while(length > 0 && (text[length - 1] == '\n' || text[length - 1] == '\r'))
+  {
+      length--;
+  }
+
+  emit(RESULTS_STREAM_LOG, (const uint8_t *)text,
+       (length < RESULTS_STREAM_BODY_MAX) ? length : RESULTS_STREAM_BODY_MAX, true);
+  kick();
+}
+
+void results_stream_process(void)
+{
+  uint32_t now = sl_sleeptimer_get_tick_count();
+  uint8_t  body[4];
+
+  if(snapshot_due || sent_question != tally_question() || now - last_snapshot >= snapshot_ticks)
+  {
+      send_snapshot(now);
+  }
+  else if(sent_version != tally_version() && now - last_delta >= delta_ticks)
+  {
+      send_delta(now);
+  }
+
+  if(stats.dropped != dropped_reported)
+  {
+      memcpy(body, &stats.dropped, sizeof(body));
+      if(emit(RESULTS_STREAM_DROPPED, body, sizeof(body), false))
+      {
+          dropped_reported = stats.dropped;
+      }
+  }
+
+  kick();
+}
+
+void results_stream_get_stats(results_stream_stats_t *out)
+{
+  *out = stats;
+}
+
+static void send_snapshot(uint32_t now)
+{
+  uint8_t   body[9 + 2 * TALLY_CHOICE_COUNT];
+  uint16_t  counts[TALLY_CHOICE_COUNT];
+  uint32_t  version = tally_version();
+
+  coap_diag_put_u32(&body[0], version);
+  body[4] = tally_question();
+  coap_diag_put_u16(&body[5], tally_remotes());
+  coap_diag_put_u16(&body[7], tally_responded());
+  for(uint8_t c = 0; c < TALLY_CHOICE_COUNT; c++)
+  {
+      counts[c] = tally_count(c);
+      coap_diag_put_u16(&body[9 + 2 * c], counts[c]);
+  }
+
+  // tried again on the next pass if the ring is full
+  if(!emit(RESULTS_STREAM_SNAPSHOT, body, sizeof(body), false))
+  {
+      return;
+  }
+
+  snapshot_due    = false;
+  sent_question   = body[4];
+  sent_version    = version;
+  last_snapshot   = now;
+  last_delta      = now;
+  memcpy(sent_counts, counts, sizeof(sent_counts));
+}
+
+static void send_delta(uint32_t now)
+{
+  uint8_t   body[7 + 2 * TALLY_CHOICE_COUNT];
+  uint16_t  counts[TALLY_CHOICE_COUNT];
+  uint32_t  version = tally_version();
+
+  coap_diag_put_u32(&body[0], version);
+  body[4] = tally_question();
+  coap_diag_put_u16(&body[5], tally_responded());
+  for(uint8_t c = 0; c < TALLY_CHOICE_COUNT; c++)
+  {
+      counts[c] = tally_count(c);
+      coap_diag_put_u16(&body[7 + 2 * c], (uint16_t)(counts[c] - sent_counts[c]));
+  }
+
+  // a lost delta folds into the next one
+  if(!emit(RESULTS_STREAM_DELTA, body, sizeof(body), false))
+  {
+      return;
+  }
+
+  sent_version  = version;
+  last_delta    = now;
+  memcpy(sent_counts, counts, sizeof(sent_counts));
+}
+
+// encode a frame into the ring, all or nothing
+static bool emit(results_stream_type_t type, const uint8_t *body, size_t length, bool reserve)
+{
+  uint8_t   frame[FRAME_MAX];
+  uint8_t   encoded[ENCODED_MAX];
+  size_t    size;
+  uint32_t  used;
+  uint32_t  start;
+  uint32_t  first;
+  uint16_t  crc;
+
+  frame[0] = (uint8_t)type;
+  frame[1] = sequence++;
+  coap_diag_put_u32(&frame[2], sl_sleeptimer_get_tick_count());
+  memcpy(&frame[RESULTS_STREAM_HEADER_SIZE], body, length);
+  length += RESULTS_STREAM_HEADER_SIZE;
+
+  crc = coap_diag_crc16(0xFFFFu, frame, length);
+  coap_diag_put_u16(&frame[length], crc);
+  length += RESULTS_STREAM_CRC_SIZE;
+
+  size = cobs_encode(frame, length, encoded);
+  used = head - tail;
+
+  if(used + size + (reserve ? RESULTS_STREAM_RESERVE : 0u) > RESULTS_STREAM_RING_SIZE)
+  {
+      // the sequence gap tells the reader
+      stats.dropped++;
+      return false;
+  }
+
+  start = head & RING_MASK;
+  first = RESULTS_STREAM_RING_SIZE - start;
+  if(first > size)
+  {
+      first = (uint32_t)size;
+  }
+  memcpy(&ring[start], encoded, first);
+  memcpy(&ring[0], &encoded[first], size - first);
+  head += (uint32_t)size;
+
+  stats.frames++;
+  stats.bytes += (uint32_t)size;
+  if(used + size > stats.ring_peak)
+  {
+      stats.ring_peak = used + (uint32_t)size;
+  }
+
+  return true;
+}
+
+// hand the oldest contiguous run of the ring to the DMA
+static void kick(void)
+{
+  uint32_t start;
+  uint32_t length;
+
+  if(uart_dma_busy() || head == tail)
+  {
+      return;
+  }
+
+  start   = tail & RING_MASK;
+  length  = head - tail;
+  if(length > RESULTS_STREAM_RING_SIZE - start)
+  {
+      length = RESULTS_STREAM_RING_SIZE - start;
+  }
+
+  if(uart_dma_start(&ring[start], length) == SL_STATUS_OK)
+  {
+      stats.transfers++;
+  }
+}
+
+// consistent overhead byte stuffing, no zero byte but the delimiter at the end
+static size_t cobs_encode(const uint8_t *in, size_t length, uint8_t *out)
+{
+  size_t  code_at = 0;
+  size_t  o       = 1;
+  uint8_t code    = 1;
+
+  for(size_t i = 0; i < length; i++)
+  {
+      if(in[i] != 0)
+      {
+          out[o++] = in[i];
+          code++;
+      }
+
+      if(in[i] == 0 || code == 0xFFu)
+      {
+          out[code_at] = code;
+          code_at      = o++;
+          code         = 1;
+      }
+  }
+
+  out[code_at]  = code;
+  out[o++]      = 0;
+
+  return o;
+}
+
+#endif /* RESULTS_STREAM_ENABLE */
@@ -0,0 +1,110 @@
+/***************************************************************************//**
+ * @file
+ * @brief Framed Binary Results Stream on the VCOM UART
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#ifndef RESULTS_STREAM_H_
+#define RESULTS_STREAM_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "sl_status.h"
+#include "base_station_config.h"
+#include "tally.h"
+
+/*
+ * Live results for the classroom PC. With RESULTS_STREAM_ENABLE the VCOM UART
+ * carries COBS encoded frames, each terminated by a zero byte, instead of
+ * console text. Frames are encoded into an outbound ring by the producers and
+ * clocked out by DMA (uart_dma.h), so nothing here waits for the UART. Every
+ * frame is, before encoding, little endian:
+ *
+ *   type u8, sequence u8, tick u32, body, crc u16 (CRC-16/CCITT-FALSE)
+ *
+ *   vote:      question u8, answer u8, iid u8[8], time u32 in us since the
+ *              question started, TALLY_NO_TIME if unknown
+ *   delta:     tally version u32, question u8, responded u16,
+ *              count change i16[TALLY_CHOICE_COUNT] since the previous delta
+ *              or snapshot
+ *   snapshot:  tally version u32, question u8, remotes u16, responded u16,
+ *              counts u16[TALLY_CHOICE_COUNT]
+ *   log:       console text, no line ending
+ *   dropped:   frames dropped so far u32
+ *
+ * Votes are sent as they are counted. Deltas are coalesced to at most one per
+ * RESULTS_STREAM_DELTA_MS, and a snapshot goes out on every new question and
+ * every RESULTS_STREAM_SNAPSHOT_MS, so a reader that joins late or loses
+ * frames is back in step with the next one. When the ring is short, votes are
+ * dropped first: they never take the last RESULTS_STREAM_RESERVE bytes.
+ * host/results_decode.py reads the stream.
+ *
+ * All producers run in the main loop, the DMA completion only frees space.
+ */
+
+typedef enum {
+  RESULTS_STREAM_VOTE     = 1,
+  RESULTS_STREAM_DELTA    = 2,
+  RESULTS_STREAM_SNAPSHOT = 3,
+  RESULTS_STREAM_LOG      = 4,
+  RESULTS_STREAM_DROPPED  = 5,
+} results_stream_type_t;
+
+#define RESULTS_STREAM_HEADER_SIZE  6u      // type, sequence, tick
+#define RESULTS_STREAM_CRC_SIZE     2u
+#define RESULTS_STREAM_BODY_MAX     DLOG_TEXT_SIZE
+#define RESULTS_STREAM_RESERVE      64u     // ring bytes votes leave for the tally frames
+
+typedef struct {
+  uint32_t  frames;           // encoded into the ring
+  uint32_t  dropped;          // no room in the ring
+  uint32_t  bytes;            // encoded bytes, delimiters included
+  uint32_t  transfers;        // DMA transfers started
+  uint32_t  ring_peak;        // most bytes waiting at once
+} results_stream_stats_t;
+
+sl_status_t results_stream_init(void);
+
+// a counted answer and its time, see answer_time.h, main loop context
+void results_stream_vote(const uint8_t *iid, char answer, uint32_t time_us);
+
+// a line of console text, main loop context
+void results_stream_log(const char *text, size_t length);
+
+// emits the tally frames that are due and keeps the UART busy
+void results_stream_process(void);
+
+void results_stream_get_stats(results_stream_stats_t *stats);
+
+#endif /* RESULTS_STREAM_H_ */
@@ -97,7 +97,7 @@ sl_status_t ring_buffer_reset( ring_buffer_handle_t* handle )
 // add
 sl_status_t ring_buffer_add( ring_buffer_handle_t* handle, void* data)
 {
-  uint32_t* src, dst;
+  void *src, *dst;
 
   CHECK_NULL(handle);
   CHECK_NULL(data);
@@ -119,7 +119,7 @@ sl_status_t ring_buffer_add( ring_buffer_handle_t* handle, void* data)
 // get
 sl_status_t ring_buffer_get( ring_buffer_handle_t* handle, void* data)
 {
-  uint32_t* src, dst;
+  void *src, *dst;
 
   CHECK_NULL(handle);
   CHECK_NULL(data);
@@ -39,7 +39,7 @@
 #include "sl_status.h"
 
 typedef struct {
-  const uint32_t*   buffer;     // pointer to the buffer
+  void* const*      buffer;     // table of pointers to the entries
         uint32_t    head;       // index the producer writes to
         uint32_t    tail;       // index the consumer reads from
   const uint32_t    size;       // size of datatype
@@ -0,0 +1,559 @@
+/***************************************************************************//**
+ * @file
+ * @brief Commissioning Roster
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#include <string.h>
+
+#include <openthread-core-config.h>
+#include <openthread/coap.h>
+#include <openthread/commissioner.h>
+
+#include "openthread-system.h"
+#include "sl_sleeptimer.h"
+#include "printf.h"
+
+#define LOG_MODULE  BASE_STATION
+#include "logging.h"
+
+#include "roster.h"
+#include "coap_diag.h"
+#include "gui_event_queue.h"
+
+#if defined(OPENTHREAD_CONFIG_COMMISSIONER_MAX_JOINER_ENTRIES) \
+    && ROSTER_BATCH_SIZE > OPENTHREAD_CONFIG_COMMISSIONER_MAX_JOINER_ENTRIES
+#error "ROSTER_BATCH_SIZE exceeds the commissioner joiner table"
+#endif
+
+#define PSKD_MIN_LENGTH   6u
+#define PSKD_MAX_LENGTH   32u
+
+typedef struct {
+  otExtAddress  eui64;
+  char          pskd[PSKD_MAX_LENGTH + 1];
+  uint8_t       state;
+  uint8_t       attempts;
+  uint32_t      added_at;       // sleeptimer ticks
+  uint32_t      join_ms;
+} roster_entry_t;
+
+static void timer_handler(sl_sleeptimer_timer_handle_t *handle, void *data);
+static void coap_handler(void *aContext, otMessage *aMessage, const otMessageInfo *aMessageInfo);
+static void start_run(void);
+static void finish_run(void);
+static void gui_log(const char *msg);
+
+static  otInstance                    *sInstance;
+static  roster_entry_t                entries[ROSTER_MAX_DEVICES];
+static  uint16_t                      entry_count;
+
+static  volatile bool                 start_requested;
+static  bool                          running;
+static  bool                          has_run;
+static  uint32_t                      run_started_at;
+static  uint32_t                      last_added_at;
+static  uint32_t                      last_done_at;
+static  sl_sleeptimer_timer_handle_t  pace_timer;
+
+static  otCoapResource                roster_resource;
+static  char*                         roster_uri_path = "roster";
+
+#define ROSTER_ENTRY_(eui, pskd)      { (eui), (pskd) },
+
+static const struct {
+  uint64_t    eui64;
+  const char  *pskd;
+} roster_list[] = {
+  ROSTER_LIST(ROSTER_ENTRY_)
+  { 0, NULL }
+};
+
+void roster_init(otInstance *aInstance)
+{
+  sInstance = aInstance;
+  roster_clear();
+
+  for(uint32_t i = 0; roster_list[i].pskd != NULL; i++)
+  {
+      otExtAddress eui64;
+
+      for(uint32_t b = 0; b < sizeof(eui64.m8); b++)
+      {
+          eui64.m8[b] = (uint8_t)(roster_list[i].eui64 >> (56 - 8 * b));
+      }
+      if(roster_add(&eui64, roster_list[i].pskd) != SL_STATUS_OK)
+      {
+          LOG_WRN("roster entry %u rejected\r\n", i);
+      }
+  }
+}
+
+sl_status_t roster_add(const otExtAddress *eui64, const char *pskd)
+{
+  size_t length = strlen(pskd);
+
+  if(length < PSKD_MIN_LENGTH || length > PSKD_MAX_LENGTH)
+  {
+      return SL_STATUS_INVALID_PARAMETER;
+  }
+
+  for(uint32_t i = 0; i < entry_count; i++)
+  {
+      if(memcmp(&entries[i].eui64, eui64, sizeof(*eui64)) == 0)
+      {
+          return SL_STATUS_INVALID_PARAMETER;
+      }
+  }
+
+  if(entry_count == ROSTER_MAX_DEVICES)
+  {
+      return SL_STATUS_FULL;
+  }
+
+  memset(&entries[entry_count], 0, sizeof(entries[entry_count]));
+  entries[entry_count].eui64 = *eui64;
+  memcpy(entries[entry_count].pskd, pskd, length + 1);
+  entries[entry_count].state = ROSTER_STATE_PENDING;
+  entry_count++;
+
+  return SL_STATUS_OK;
+}
+
+void roster_clear(void)
+{
+  if(running)
+  {
+      sl_sleeptimer_stop_timer(&pace_timer);
+      running = false;
+  }
+
+  // the commissioner would still let them in with their pskd
+  for(uint32_t i = 0; i < entry_count; i++)
+  {
+      if(entries[i].state >= ROSTER_STATE_ADDED && entries[i].state <= ROSTER_STATE_FINALIZE)
+      {
+          entries[i].state = ROSTER_STATE_FAILED;
+          otCommissionerRemoveJoiner(sInstance, &entries[i].eui64);
+      }
+  }
+  entry_count = 0;
+}
+
+uint16_t roster_size(void)
+{
+  return entry_count;
+}
+
+void roster_request_start(void)
+{
+  start_requested = true;
+  otSysEventSignalPending();
+}
+
+/**************************************************************************//**
+ * Roster Process
+ *
+ * Fills the batch, one joiner per ROSTER_ADD_INTERVAL_MS, and closes the run
+ * once every entry has joined or failed.
+ *****************************************************************************/
+void roster_process(void)
+{
+  uint32_t  now = sl_sleeptimer_get_tick_count();
+  uint16_t  active = 0;
+  uint16_t  pending = 0;
+  otError   error;
+
+  if(start_requested)
+  {
+      start_requested = false;
+      start_run();
+  }
+
+  if(!running)
+  {
+      return;
+  }
+
+  for(uint32_t i = 0; i < entry_count; i++)
+  {
+      active  += (entries[i].state >= ROSTER_STATE_ADDED && entries[i].state <= ROSTER_STATE_FINALIZE);
+      pending += (entries[i].state == ROSTER_STATE_PENDING);
+  }
+
+  if(active == 0 && pending == 0)
+  {
+      finish_run();
+      return;
+  }
+
+  if(pending == 0 || active >= ROSTER_BATCH_SIZE
+     || otCommissionerGetState(sInstance) != OT_COMMISSIONER_STATE_ACTIVE
+     || sl_sleeptimer_tick_to_ms(now - last_added_at) < ROSTER_ADD_INTERVAL_MS)
+  {
+      return;
+  }
+
+  for(uint32_t i = 0; i < entry_count; i++)
+  {
+      if(entries[i].state != ROSTER_STATE_PENDING)
+      {
+          continue;
+      }
+
+      error = otCommissionerAddJoiner(sInstance, &entries[i].eui64, entries[i].pskd, ROSTER_JOINER_TIMEOUT_S);
+      if(error == OT_ERROR_NO_BUFS)
+      {
+          // joiner table full, try again on the next tick
+          break;
+      }
+      if(error)
+      {
+          LOG_WRN("roster add joiner %u: %s\r\n", i, otThreadErrorToString(error));
+          entries[i].state = ROSTER_STATE_FAILED;
+          break;
+      }
+
+      entries[i].state    = ROSTER_STATE_ADDED;
+      entries[i].added_at = now;
+      entries[i].attempts++;
+      last_added_at       = now;
+      break;
+  }
+}
+
+/**************************************************************************//**
+ * Roster Joiner Event
+ *
+ * Entries are found by the EUI-64 the commissioner matched, wildcard joiners
+ * are not tracked.
+ *****************************************************************************/
+void roster_joiner_event(otCommissionerJoinerEvent aEvent, const otJoinerInfo *aJoinerInfo)
+{
+  roster_entry_t  *entry = NULL;
+  uint32_t        now    = sl_sleeptimer_get_tick_count();
+  roster_stats_t  stats;
+  char            msg[GUI_EVENT_MSG_SIZE];
+
+  if(aJoinerInfo == NULL || aJoinerInfo->mType != OT_JOINER_INFO_TYPE_EUI64)
+  {
+      return;
+  }
+
+  for(uint32_t i = 0; i < entry_count; i++)
+  {
+      if(memcmp(&entries[i].eui64, &aJoinerInfo->mSharedId.mEui64, sizeof(otExtAddress)) == 0)
+      {
+          entry = &entries[i];
+          break;
+      }
+  }
+
+  if(entry == NULL || entry->state == ROSTER_STATE_JOINED || entry->state == ROSTER_STATE_FAILED)
+  {
+      return;
+  }
+
+  switch(aEvent) {
+    case OT_COMMISSIONER_JOINER_START:
+      entry->state = ROSTER_STATE_STARTED;
+      break;
+
+    case OT_COMMISSIONER_JOINER_CONNECTED:
+      entry->state = ROSTER_STATE_CONNECTED;
+      break;
+
+    case OT_COMMISSIONER_JOINER_FINALIZE:
+      entry->state = ROSTER_STATE_FINALIZE;
+      break;
+
+    case OT_COMMISSIONER_JOINER_END:
+      last_done_at = now;
+
+      // the dtls session also ends on a failed handshake or a wrong pskd,
+      // that remote goes back in the queue
+      if(entry->state != ROSTER_STATE_FINALIZE)
+      {
+          entry->state = (entry->attempts < ROSTER_MAX_ATTEMPTS) ? ROSTER_STATE_PENDING : ROSTER_STATE_FAILED;
+          otCommissionerRemoveJoiner(sInstance, &entry->eui64);
+          break;
+      }
+
+      entry->state   = ROSTER_STATE_JOINED;
+      entry->join_ms = sl_sleeptimer_tick_to_ms(now - entry->added_at);
+
+      // free the slot for the next one rather than waiting for the stack
+      otCommissionerRemoveJoiner(sInstance, &entry->eui64);
+
+      roster_get_stats(&stats);
+      snprintf(msg, sizeof(msg), "[roster] %u/%u", stats.joined, stats.total);
+      gui_log(msg);
+      break;
+
+    case OT_COMMISSIONER_JOINER_REMOVED:
+      // expired without finishing
+      entry->state = (entry->attempts < ROSTER_MAX_ATTEMPTS) ? ROSTER_STATE_PENDING : ROSTER_STATE_FAILED;
+      last_done_at = now;
+      break;
+
+    default:
+      break;
+  }
+
+  otSysEventSignalPending();
+}
+
+void roster_get_stats(roster_stats_t *stats)
+{
+  static uint32_t times[ROSTER_MAX_DEVICES];
+
+  memset(stats, 0, sizeof(*stats));
+  stats->total = entry_count;
+
+  for(uint32_t i = 0; i < entry_count; i++)
+  {
+      switch(entries[i].state) {
+        case ROSTER_STATE_PENDING:  stats->pending++; break;
+        case ROSTER_STATE_FAILED:   stats->failed++;  break;
+        case ROSTER_STATE_JOINED:
+        {
+            // insertion sort, the roster is small
+            uint32_t j = stats->joined++;
+            while(j > 0 && times[j - 1] > entries[i].join_ms)
+            {
+                times[j] = times[j - 1];
+                j--;
+            }
+            times[j] = entries[i].join_ms;
+            break;
+        }
+        default:                    stats->active++;  break;
+      }
+  }
+
+  if(stats->joined > 0)
+  {
+      stats->median_ms = times[(stats->joined - 1) / 2];
+      stats->p95_ms    = times[(stats->joined * 95 + 99) / 100 - 1];
+  }
+
+  if(has_run)
+  {
+      stats->elapsed_ms = sl_sleeptimer_tick_to_ms((running ? sl_sleeptimer_get_tick_count() : last_done_at) - run_started_at);
+  }
+
+  if(stats->elapsed_ms > 0)
+  {
+      stats->per_minute_x10 = (uint32_t)(((uint64_t)stats->joined * 600000u) / stats->elapsed_ms);
+  }
+}
+
+otError roster_coap_init(otInstance *aInstance)
+{
+  roster_resource.mUriPath = roster_uri_path;
+  roster_resource.mHandler = &coap_handler;
+  roster_resource.mContext = aInstance;
+
+  otCoapAddResource(aInstance, &roster_resource);
+
+  return OT_ERROR_NONE;
+}
+
+static void start_run(void)
+{
+  otError error;
+
+  if(entry_count == 0)
+  {
+      // no roster, anyone with the shared pskd may join
+      error = otCommissionerAddJoiner(sInstance, NULL, COMMISSIONER_JOINER_PSKD, COMMISSIONER_JOINER_TIMEOUT);
+      if(error)
+      {
+          LOG_WRN("start_joiner: %s\r\n", otThreadErrorToString(error));
+      }
+      gui_log("[joiner] start");
+      return;
+  }
+
+  if(running)
+  {
+      return;
+  }
+
+  // joined remotes stay joined, everything else gets a fresh run
+  for(uint32_t i = 0; i < entry_count; i++)
+  {
+      if(entries[i].state != ROSTER_STATE_JOINED)
+      {
+          entries[i].state    = ROSTER_STATE_PENDING;
+          entries[i].attempts = 0;
+      }
+  }
+
+  running        = true;
+  has_run        = true;
+  run_started_at = sl_sleeptimer_get_tick_count();
+  last_added_at  = run_started_at - sl_sleeptimer_ms_to_tick(ROSTER_ADD_INTERVAL_MS);
+  last_done_at   = run_started_at;
+
+  // wakes the main loop to pace the batch
+  sl_sleeptimer_start_periodic_timer_ms(&pace_timer, ROSTER_ADD_INTERVAL_MS, timer_handler, NULL, 0, 0);
+
+  LOG_INF("roster run: %u remotes\r\n", entry_count);
+  gui_log("[roster] start");
+}
+
+static void finish_run(void)
+{
+  roster_stats_t  stats;
+  char            msg[GUI_EVENT_MSG_SIZE];
+
+  running = false;
+  sl_sleeptimer_stop_timer(&pace_timer);
+
+  roster_get_stats(&stats);
+  LOG_INF("roster done: %u joined, %u failed in %lu ms\r\n",
+          stats.joined, stats.failed, (unsigned long)stats.elapsed_ms);
+  LOG_INF("roster: %lu.%lu/min, join time median %lu ms, p95 %lu ms\r\n",
+          (unsigned long)(stats.per_minute_x10 / 10), (unsigned long)(stats.per_minute_x10 % 10),
+          (unsigned long)stats.median_ms, (unsigned long)stats.p95_ms);
+
+  snprintf(msg, sizeof(msg), "[roster] %u/%u %u.%u/min", stats.joined, stats.total,
+           (unsigned)(stats.per_minute_x10 / 10), (unsigned)(stats.per_minute_x10 % 10));
+  gui_log(msg);
+}
+
+static void timer_handler(sl_sleeptimer_timer_handle_t *handle, void *data)
+{
+  (void)handle;
+  (void)data;
+
+  otSysEventSignalPending();
+}
+
+static void gui_log(const char *msg)
+{
+  gui_event_t gui_event = {
+      .flag = GUI_EVENT_FLAG_LOG,
+      .msg  = {0},
+  };
+
+  snprintf(gui_event.msg, GUI_EVENT_MSG_SIZE, "%s", msg);
+  gui_event_queue_add(&gui_event);
+}
+
+/**************************************************************************//**
+ * roster
+ *
+ * POST appends entries, each an 8 byte EUI-64, a length byte and the PSKd,
+ * and answers with the number of entries added. GET returns the
+ * roster_get_stats() counters followed by EUI-64, state and join time per
+ * entry, little-endian. DELETE clears the roster. POST and DELETE are
+ * refused with 4.03 unless coap_diag_peer_is_local(), the plain CoAP server
+ * takes requests from any node on the mesh.
+ *****************************************************************************/
+static void coap_handler(void *aContext, otMessage *aMessage, const otMessageInfo *aMessageInfo)
+{
+  static uint8_t  payload[26 + ROSTER_MAX_DEVICES * 13];
+  uint16_t        offset  = otMessageGetOffset(aMessage);
+  uint16_t        end     = otMessageGetLength(aMessage);
+  uint8_t         *p      = payload;
+  uint8_t         added   = 0;
+  roster_stats_t  stats;
+  otCoapCode      code    = otCoapMessageGetCode(aMessage);
+
+  // anyone else could let their own joiners in or wipe the roster
+  if((code == OT_COAP_CODE_POST || code == OT_COAP_CODE_DELETE)
+     && !coap_diag_peer_is_local(aContext, aMessageInfo))
+  {
+      coap_diag_respond(aContext, aMessage, aMessageInfo, OT_COAP_CODE_FORBIDDEN, NULL, 0);
+      return;
+  }
+
+  switch(code) {
+    case OT_COAP_CODE_POST:
+      while(offset + sizeof(otExtAddress) + 1u <= end)
+      {
+          otExtAddress  eui64;
+          char          pskd[PSKD_MAX_LENGTH + 1];
+          uint8_t       length;
+
+          otMessageRead(aMessage, offset, &eui64, sizeof(eui64));
+          otMessageRead(aMessage, offset + sizeof(eui64), &length, 1);
+          offset += sizeof(eui64) + 1u;
+
+          if(length > PSKD_MAX_LENGTH || offset + length > end)
+          {
+              break;
+          }
+          otMessageRead(aMessage, offset, pskd, length);
+          pskd[length] = '\0';
+          offset += length;
+
+          added += (roster_add(&eui64, pskd) == SL_STATUS_OK);
+      }
+      coap_diag_respond(aContext, aMessage, aMessageInfo,
+                        (offset == end) ? OT_COAP_CODE_CHANGED : OT_COAP_CODE_BAD_REQUEST, &added, 1);
+      break;
+
+    case OT_COAP_CODE_GET:
+      roster_get_stats(&stats);
+      p = coap_diag_put_u16(p, stats.total);
+      p = coap_diag_put_u16(p, stats.pending);
+      p = coap_diag_put_u16(p, stats.active);
+      p = coap_diag_put_u16(p, stats.joined);
+      p = coap_diag_put_u16(p, stats.failed);
+      p = coap_diag_put_u32(p, stats.elapsed_ms);
+      p = coap_diag_put_u32(p, stats.median_ms);
+      p = coap_diag_put_u32(p, stats.p95_ms);
+      p = coap_diag_put_u32(p, stats.per_minute_x10);
+      for(uint32_t i = 0; i < entry_count; i++)
+      {
+          memcpy(p, &entries[i].eui64, sizeof(otExtAddress));
+          p += sizeof(otExtAddress);
+          *p++ = entries[i].state;
+          p = coap_diag_put_u32(p, entries[i].join_ms);
+      }
+      coap_diag_respond(aContext, aMessage, aMessageInfo, OT_COAP_CODE_CONTENT, payload, (uint16_t)(p - payload));
+      break;
+
+    case OT_COAP_CODE_DELETE:
+      roster_clear();
+      coap_diag_respond(aContext, aMessage, aMessageInfo, OT_COAP_CODE_DELETED, NULL, 0);
+      break;
+
+    default:
+      coap_diag_respond(aContext, aMessage, aMessageInfo, OT_COAP_CODE_METHOD_NOT_ALLOWED, NULL, 0);
+      break;
+  }
+}
@@ -0,0 +1,106 @@
+/***************************************************************************//**
+ * @file
+ * @brief Commissioning Roster Header
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#ifndef ROSTER_H_
+#define ROSTER_H_
+
+#include <stdint.h>
+
+#include <openthread/commissioner.h>
+
+#include "sl_status.h"
+#include "base_station_config.h"
+
+/*
+ * Roster driven commissioning. The roster lists the EUI-64 and PSKd of every
+ * remote, from ROSTER_LIST at boot or posted to the roster resource. Starting
+ * a run adds them as explicit joiners, at most ROSTER_BATCH_SIZE at a time
+ * and ROSTER_ADD_INTERVAL_MS apart, refilling the batch as remotes finish.
+ * Remotes whose entry expires, or whose session ends before finalize, are
+ * retried up to ROSTER_MAX_ATTEMPTS times.
+ * With an empty roster, a run is the old wildcard joiner with the shared
+ * COMMISSIONER_JOINER_PSKD.
+ */
+
+typedef enum {
+  ROSTER_STATE_PENDING,     // waiting for a slot in the batch
+  ROSTER_STATE_ADDED,       // joiner entry added, nothing heard yet
+  ROSTER_STATE_STARTED,     // dtls session started
+  ROSTER_STATE_CONNECTED,
+  ROSTER_STATE_FINALIZE,
+  ROSTER_STATE_JOINED,
+  ROSTER_STATE_FAILED,
+  ROSTER_STATE_COUNT
+} roster_state_t;
+
+typedef struct {
+  uint16_t  total;
+  uint16_t  pending;
+  uint16_t  active;         // added to the commissioner and not finished
+  uint16_t  joined;
+  uint16_t  failed;
+  uint32_t  elapsed_ms;     // first joiner added to the last one finished
+  uint32_t  median_ms;      // join time, joiner added to joined
+  uint32_t  p95_ms;
+  uint32_t  per_minute_x10; // joined devices per minute, times ten
+} roster_stats_t;
+
+void roster_init(otInstance *aInstance);
+
+// pskd is copied, SL_STATUS_FULL past ROSTER_MAX_DEVICES,
+// SL_STATUS_INVALID_PARAMETER for a bad pskd length or a duplicate EUI-64
+sl_status_t roster_add(const otExtAddress *eui64, const char *pskd);
+
+// drop every entry and remove their joiners from the commissioner, stops a run
+void roster_clear(void);
+
+uint16_t roster_size(void);
+
+// start commissioning, safe from interrupt context
+void roster_request_start(void);
+
+// paces the run, called from the main loop
+void roster_process(void);
+
+// joiner events from the commissioner callback
+void roster_joiner_event(otCommissionerJoinerEvent aEvent, const otJoinerInfo *aJoinerInfo);
+
+void roster_get_stats(roster_stats_t *stats);
+
+// registers the roster resource on the running coap server
+otError roster_coap_init(otInstance *aInstance);
+
+#endif /* ROSTER_H_ */
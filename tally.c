@@ -0,0 +1,315 @@
+/***************************************************************************//**
+ * @file
+ * @brief Answer Tally
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#include <string.h>
+
+#include "tally.h"
+
+#define NO_CHOICE   0xFF
+#define LOG_MASK    (TALLY_CHANGE_LOG - 1u)
+
+#if (TALLY_CHANGE_LOG & LOG_MASK) != 0
+#error "TALLY_CHANGE_LOG must be a power of two"
+#endif
+
+#if TALLY_COUNTERS > 8
+#error "the change log keeps the changed counters in a byte"
+#endif
+
+static void rank_insert(uint8_t choice, uint16_t id);
+static void rank_remove(uint8_t choice, uint16_t id);
+static void changed(uint32_t counters);
+
+static  uint16_t    counts[TALLY_CHOICE_COUNT];
+// per remote id, the current choice and when it was made
+static  uint8_t     choices[TALLY_MAX_REMOTES];
+static  uint32_t    times[TALLY_MAX_REMOTES];
+static  uint32_t    answered[REMOTE_REGISTRY_WORDS];
+static  uint16_t    responded;
+// per choice the ids of the fastest, earliest first
+static  uint16_t    ranks[TALLY_CHOICE_COUNT][TALLY_TOP_K];
+static  uint8_t     ranked[TALLY_CHOICE_COUNT];
+static  uint16_t    joined;
+static  uint32_t    version;
+// counters changed by each of the last versions, at version & LOG_MASK
+static  uint8_t     change_log[TALLY_CHANGE_LOG];
+static  uint8_t     question;
+
+static int8_t choice_from_answer(char answer)
+{
+  if(answer >= 'a' && answer <= 'z')
+  {
+      answer = (char)(answer - 'a' + 'A');
+  }
+
+  if(answer < 'A' || answer >= (char)('A' + TALLY_CHOICE_COUNT))
+  {
+      return -1;
+  }
+
+  return (int8_t)(answer - 'A');
+}
+
+void tally_reset(void)
+{
+  memset(counts, 0, sizeof(counts));
+  memset(choices, NO_CHOICE, sizeof(choices));
+  memset(answered, 0, sizeof(answered));
+  memset(ranked, 0, sizeof(ranked));
+  responded = 0;
+  question++;
+  changed(TALLY_CHANGED_ALL);
+}
+
+sl_status_t tally_record(uint16_t id, char answer)
+{
+  return tally_record_at(id, answer, TALLY_NO_TIME);
+}
+
+sl_status_t tally_record_at(uint16_t id, char answer, uint32_t time_us)
+{
+  int8_t    choice = choice_from_answer(answer);
+  uint32_t  counters;
+
+  if(choice < 0 || id >= TALLY_MAX_REMOTES)
+  {
+      return SL_STATUS_INVALID_PARAMETER;
+  }
+
+  if(choices[id] == (uint8_t)choice)
+  {
+      return SL_STATUS_OK;
+  }
+
+  if(choices[id] != NO_CHOICE)
+  {
+      counts[choices[id]]--;
+      rank_remove(choices[id], id);
+      counters = 1ul << choices[id];
+  }
+  else
+  {
+      answered[id / 32u] |= 1ul << (id % 32u);
+      responded++;
+      counters = (1ul << TALLY_COUNTER_RESPONDED) | (1ul << TALLY_COUNTER_REMOTES);
+  }
+
+  // a remote changing its mind ranks from when it did
+  choices[id] = (uint8_t)choice;
+  times[id]   = time_us;
+  counts[choice]++;
+  rank_insert((uint8_t)choice, id);
+  changed(counters | (1ul << choice));
+
+  return SL_STATUS_OK;
+}
+
+void tally_remote_joined(void)
+{
+  joined++;
+  changed(1ul << TALLY_COUNTER_REMOTES);
+}
+
+uint16_t tally_count(uint8_t choice)
+{
+  return (choice < TALLY_CHOICE_COUNT) ? counts[choice] : 0;
+}
+
+uint16_t tally_responded(void)
+{
+  return responded;
+}
+
+uint16_t tally_remotes(void)
+{
+  // remotes from before a reboot only show up once they answer
+  return (joined > responded) ? joined : responded;
+}
+
+uint8_t tally_question(void)
+{
+  return question;
+}
+
+uint32_t tally_version(void)
+{
+  return version;
+}
+
+uint16_t tally_counter(uint8_t counter)
+{
+  switch(counter) {
+    case TALLY_COUNTER_RESPONDED:
+      return tally_responded();
+
+    case TALLY_COUNTER_REMOTES:
+      return tally_remotes();
+
+    default:
+      return tally_count(counter);
+  }
+}
+
+uint32_t tally_changed_since(uint32_t since)
+{
+  uint32_t counters = 0;
+
+  // a version from the future is from before a reboot
+  if(since > version || version - since > TALLY_CHANGE_LOG)
+  {
+      return TALLY_CHANGED_ALL;
+  }
+
+  for(uint32_t v = since + 1u; v != version + 1u; v++)
+  {
+      counters |= change_log[v & LOG_MASK];
+  }
+
+  return counters;
+}
+
+uint8_t tally_fastest(uint8_t choice, tally_rank_t *out, uint8_t max)
+{
+  uint8_t n = 0;
+
+  if(choice >= TALLY_CHOICE_COUNT)
+  {
+      return 0;
+  }
+
+  for(; n < ranked[choice] && n < max; n++)
+  {
+      out[n].id   = ranks[choice][n];
+      out[n].time = times[ranks[choice][n]];
+  }
+
+  return n;
+}
+
+const uint32_t *tally_answered(void)
+{
+  return answered;
+}
+
+static void changed(uint32_t counters)
+{
+  version++;
+  change_log[version & LOG_MASK] = (uint8_t)counters;
+}
+
+/*
+ * The ranking of a choice holds its TALLY_TOP_K fastest remotes in time order,
+ * ties in arrival order. Adding a remote is an insertion into a short sorted
+ * array. Only a remote leaving a full ranking, by changing its answer, costs a
+ * walk over the ones that answered for the one that moves up.
+ */
+static void rank_insert(uint8_t choice, uint16_t id)
+{
+  uint16_t  *rank = ranks[choice];
+  uint32_t  time  = times[id];
+  uint8_t   pos   = ranked[choice];
+
+  while(pos > 0 && times[rank[pos - 1]] > time)
+  {
+      pos--;
+  }
+
+  if(pos >= TALLY_TOP_K)
+  {
+      return;
+  }
+
+  if(ranked[choice] < TALLY_TOP_K)
+  {
+      ranked[choice]++;
+  }
+  memmove(&rank[pos + 1], &rank[pos], (size_t)(ranked[choice] - 1 - pos) * sizeof(rank[0]));
+  rank[pos] = id;
+}
+
+static void rank_remove(uint8_t choice, uint16_t id)
+{
+  uint16_t  *rank = ranks[choice];
+  uint8_t   pos;
+  int32_t   next  = -1;
+
+  for(pos = 0; pos < ranked[choice] && rank[pos] != id; pos++);
+
+  if(pos == ranked[choice])
+  {
+      return;
+  }
+
+  memmove(&rank[pos], &rank[pos + 1], (size_t)(ranked[choice] - 1 - pos) * sizeof(rank[0]));
+  ranked[choice]--;
+
+  if(counts[choice] <= ranked[choice])
+  {
+      return;
+  }
+
+  // the fastest remote on the choice that isn't ranked yet, ties go to the
+  // lower id as arrival order isn't kept
+  for(uint16_t w = 0; w < REMOTE_REGISTRY_WORDS; w++)
+  {
+      for(uint32_t bits = answered[w]; bits != 0; bits &= bits - 1u)
+      {
+          uint16_t  i       = (uint16_t)(w * 32u + (uint32_t)__builtin_ctz(bits));
+          bool      listed  = false;
+
+          if(i == id || choices[i] != choice
+             || (next >= 0 && times[i] >= times[next]))
+          {
+              continue;
+          }
+
+          for(uint8_t r = 0; r < ranked[choice]; r++)
+          {
+              listed = listed || (rank[r] == i);
+          }
+
+          if(!listed)
+          {
+              next = i;
+          }
+      }
+  }
+
+  if(next >= 0)
+  {
+      rank[ranked[choice]++] = (uint16_t)next;
+  }
+}
@@ -0,0 +1,100 @@
+/***************************************************************************//**
+ * @file
+ * @brief Answer Tally Header
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#ifndef TALLY_H_
+#define TALLY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "sl_status.h"
+#include "base_station_config.h"
+#include "remote_registry.h"
+
+// init, also starts a new question
+void tally_reset(void);
+
+#define TALLY_IID_SIZE  REMOTE_REGISTRY_IID_SIZE
+
+#define TALLY_NO_TIME   0xFFFFFFFFu     // ranks after every timed answer
+
+typedef struct {
+  uint16_t  id;
+  uint32_t  time;
+} tally_rank_t;
+
+// count the answer of a remote, by its id from remote_registry.h, a remote
+// changing its mind moves its vote
+sl_status_t tally_record(uint16_t id, char answer);
+
+// same, with the time of the answer in us since the question started, which
+// ranks it among the fastest on its choice
+sl_status_t tally_record_at(uint16_t id, char answer, uint32_t time_us);
+
+// up to max of the TALLY_TOP_K fastest remotes on a choice, earliest first,
+// returns how many
+uint8_t tally_fastest(uint8_t choice, tally_rank_t *ranks, uint8_t max);
+
+// the ids that answered the current question, REMOTE_REGISTRY_WORDS words
+// with id n at bit n % 32 of word n / 32
+const uint32_t *tally_answered(void);
+
+// a remote finished commissioning
+void tally_remote_joined(void);
+
+uint16_t tally_count(uint8_t choice);
+uint16_t tally_responded(void);
+uint16_t tally_remotes(void);
+
+// bumped by tally_reset, tells the remotes which question they answered
+uint8_t tally_question(void);
+
+// bumped on every change, cheap way for readers to see if anything moved
+uint32_t tally_version(void);
+
+// counters, the answer choices first, for readers that want the changes only
+#define TALLY_COUNTER_RESPONDED   TALLY_CHOICE_COUNT
+#define TALLY_COUNTER_REMOTES     (TALLY_CHOICE_COUNT + 1u)
+#define TALLY_COUNTERS            (TALLY_CHOICE_COUNT + 2u)
+#define TALLY_CHANGED_ALL         ((1ul << TALLY_COUNTERS) - 1ul)
+
+uint16_t tally_counter(uint8_t counter);
+
+// the counters changed after a version, a bit per counter, TALLY_CHANGED_ALL
+// when the last TALLY_CHANGE_LOG versions don't reach back that far
+uint32_t tally_changed_since(uint32_t since);
+
+#endif /* TALLY_H_ */
@@ -0,0 +1,252 @@
+/***************************************************************************//**
+ * @file
+ * @brief Mesh Topology Snapshot
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#include <string.h>
+
+#include <openthread/thread_ftd.h>
+#include <openthread/platform/radio.h>
+
+#include "openthread-system.h"
+#include "sl_sleeptimer.h"
+
+#define LOG_MODULE  BASE_STATION
+#include "logging.h"
+
+#include "topology.h"
+#include "coap_diag.h"
+
+#define TOPOLOGY_EXPORT_VERSION   1u
+
+static void timer_handler(sl_sleeptimer_timer_handle_t *handle, void *data);
+static void take_snapshot(void);
+static uint8_t link_margin(int8_t rssi);
+
+static  otInstance                    *sInstance;
+static  volatile bool                 update_requested;
+static  sl_sleeptimer_timer_handle_t  refresh_timer;
+static  topology_t                    snapshot;
+
+void topology_init(otInstance *aInstance)
+{
+  sInstance = aInstance;
+
+#if TOPOLOGY_REFRESH_MS
+  sl_sleeptimer_start_periodic_timer_ms(&refresh_timer, TOPOLOGY_REFRESH_MS, timer_handler, NULL, 0, 0);
+#else
+  (void)refresh_timer;
+  (void)timer_handler;
+#endif
+}
+
+void topology_request_update(void)
+{
+  update_requested = true;
+  otSysEventSignalPending();
+}
+
+void topology_process(void)
+{
+  if(!update_requested)
+  {
+      return;
+  }
+  update_requested = false;
+
+  take_snapshot();
+}
+
+const topology_t *topology_get(void)
+{
+  return &snapshot;
+}
+
+size_t topology_export(uint8_t *buffer, size_t size)
+{
+  uint8_t *p = buffer;
+
+  if(size < TOPOLOGY_EXPORT_SIZE)
+  {
+      return 0;
+  }
+
+  *p++ = TOPOLOGY_EXPORT_VERSION;
+  *p++ = snapshot.router_count;
+  *p++ = snapshot.child_count;
+  *p++ = snapshot.max_remote_hops;
+  *p++ = (uint8_t)(sl_sleeptimer_tick_to_ms(sl_sleeptimer_get_tick_count() - snapshot.taken_at) / 1000u);
+
+  for(uint32_t i = 0; i < snapshot.router_count; i++)
+  {
+      const topology_router_t *router = &snapshot.routers[i];
+
+      p    = coap_diag_put_u16(p, router->rloc16);
+      *p++ = router->next_hop;
+      *p++ = router->path_cost;
+      *p++ = router->lq_in;
+      *p++ = router->lq_out;
+      *p++ = router->link_margin;
+      p    = coap_diag_put_u16(p, router->frame_error_rate);
+  }
+
+  for(uint32_t i = 0; i < snapshot.child_count; i++)
+  {
+      const topology_child_t *child = &snapshot.children[i];
+
+      p    = coap_diag_put_u16(p, child->rloc16);
+      *p++ = child->link_margin;
+      *p++ = child->lq_in;
+      p    = coap_diag_put_u16(p, child->frame_error_rate);
+      p    = coap_diag_put_u16(p, child->message_error_rate);
+      *p++ = child->rx_on_when_idle;
+  }
+
+  return (size_t)(p - buffer);
+}
+
+static void timer_handler(sl_sleeptimer_timer_handle_t *handle, void *data)
+{
+  (void)handle;
+  (void)data;
+
+  topology_request_update();
+}
+
+static void take_snapshot(void)
+{
+  otRouterInfo            router_info;
+  otChildInfo             child_info;
+  otNeighborInfo          neighbor_info;
+  otNeighborInfoIterator  iterator    = OT_NEIGHBOR_INFO_ITERATOR_INIT;
+  uint16_t                own_rloc16  = otThreadGetRloc16(sInstance);
+  uint8_t                 previous    = snapshot.max_remote_hops;
+  uint8_t                 max_cost    = 0;
+
+  snapshot.router_count = 0;
+  snapshot.child_count  = 0;
+
+  for(uint16_t id = 0; id <= otThreadGetMaxRouterId(sInstance) && snapshot.router_count < TOPOLOGY_MAX_ROUTERS; id++)
+  {
+      topology_router_t *router = &snapshot.routers[snapshot.router_count];
+
+      if(otThreadGetRouterInfo(sInstance, id, &router_info) != OT_ERROR_NONE
+         || !router_info.mAllocated || router_info.mRloc16 == own_rloc16)
+      {
+          continue;
+      }
+
+      router->rloc16            = router_info.mRloc16;
+      router->next_hop          = router_info.mNextHop;
+      router->path_cost         = router_info.mPathCost;
+      router->lq_in             = router_info.mLinkQualityIn;
+      router->lq_out            = router_info.mLinkQualityOut;
+      router->link_margin       = TOPOLOGY_NO_MARGIN;
+      router->frame_error_rate  = 0;
+      snapshot.router_count++;
+
+      if(router_info.mPathCost > max_cost)
+      {
+          max_cost = router_info.mPathCost;
+      }
+  }
+
+  for(uint16_t index = 0; index < otThreadGetMaxAllowedChildren(sInstance) && snapshot.child_count < TOPOLOGY_MAX_CHILDREN; index++)
+  {
+      topology_child_t *child = &snapshot.children[snapshot.child_count];
+
+      if(otThreadGetChildInfoByIndex(sInstance, index, &child_info) != OT_ERROR_NONE)
+      {
+          continue;
+      }
+
+      child->rloc16             = child_info.mRloc16;
+      child->link_margin        = link_margin(child_info.mAverageRssi);
+      child->lq_in              = child_info.mLinkQualityIn;
+      child->frame_error_rate   = child_info.mFrameErrorRate;
+      child->message_error_rate = child_info.mMessageErrorRate;
+      child->rx_on_when_idle    = child_info.mRxOnWhenIdle;
+      snapshot.child_count++;
+  }
+
+  // link figures for the routers in radio range
+  while(otThreadGetNextNeighborInfo(sInstance, &iterator, &neighbor_info) == OT_ERROR_NONE)
+  {
+      if(neighbor_info.mIsChild)
+      {
+          continue;
+      }
+
+      for(uint32_t i = 0; i < snapshot.router_count; i++)
+      {
+          if(snapshot.routers[i].rloc16 == neighbor_info.mRloc16)
+          {
+              snapshot.routers[i].link_margin      = link_margin(neighbor_info.mAverageRssi);
+              snapshot.routers[i].frame_error_rate = neighbor_info.mFrameErrorRate;
+              break;
+          }
+      }
+  }
+
+  // the farthest router plus the hop to its child, or our own children
+  if(snapshot.router_count > 0)
+  {
+      snapshot.max_remote_hops = (max_cost < UINT8_MAX) ? max_cost + 1u : UINT8_MAX;
+  }
+  else
+  {
+      snapshot.max_remote_hops = (snapshot.child_count > 0) ? 1u : 0u;
+  }
+
+  snapshot.taken_at = sl_sleeptimer_get_tick_count();
+
+  if(snapshot.max_remote_hops != previous)
+  {
+      LOG_INF("topology: %u routers, %u children, slowest remote %u hops\r\n",
+              snapshot.router_count, snapshot.child_count, snapshot.max_remote_hops);
+  }
+}
+
+static uint8_t link_margin(int8_t rssi)
+{
+  int16_t margin = (int16_t)rssi - otPlatRadioGetReceiveSensitivity(sInstance);
+
+  // 127 is what the radio reports without a measurement
+  if(rssi == 127 || margin < 0)
+  {
+      return 0;
+  }
+
+  return (margin > 0xFE) ? 0xFE : (uint8_t)margin;
+}
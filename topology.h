@@ -0,0 +1,103 @@
+/***************************************************************************//**
+ * @file
+ * @brief Mesh Topology Snapshot Header
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#ifndef TOPOLOGY_H_
+#define TOPOLOGY_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <openthread/instance.h>
+
+#include "base_station_config.h"
+
+/*
+ * Snapshot of the mesh as seen from the leader: the router table, the child
+ * table and, for direct neighbors, link margin and frame error rate. A new
+ * snapshot is taken from the main loop when the stack reports a topology
+ * change and every TOPOLOGY_REFRESH_MS.
+ *
+ * The hop estimate for a router is its route cost, which matches the hop
+ * count over good links (cost 1 per hop) and grows with poor ones. A remote
+ * is assumed to be a child, one more hop behind its parent.
+ */
+
+#define TOPOLOGY_NO_MARGIN    0xFFu   // not a direct neighbor
+
+typedef struct {
+  uint16_t  rloc16;
+  uint8_t   next_hop;         // router id
+  uint8_t   path_cost;
+  uint8_t   lq_in;
+  uint8_t   lq_out;
+  uint8_t   link_margin;      // dB, TOPOLOGY_NO_MARGIN if not a neighbor
+  uint16_t  frame_error_rate; // 0xFFFF is 100%
+} topology_router_t;
+
+typedef struct {
+  uint16_t  rloc16;
+  uint8_t   link_margin;
+  uint8_t   lq_in;
+  uint16_t  frame_error_rate;
+  uint16_t  message_error_rate;
+  uint8_t   rx_on_when_idle;
+} topology_child_t;
+
+typedef struct {
+  uint32_t            taken_at;       // sleeptimer ticks
+  uint8_t             router_count;
+  uint8_t             child_count;
+  uint8_t             max_remote_hops;
+  topology_router_t   routers[TOPOLOGY_MAX_ROUTERS];
+  topology_child_t    children[TOPOLOGY_MAX_CHILDREN];
+} topology_t;
+
+void topology_init(otInstance *aInstance);
+
+// take a new snapshot on the next main loop pass, safe from any context
+void topology_request_update(void);
+
+// called from the main loop
+void topology_process(void);
+
+const topology_t *topology_get(void);
+
+// little-endian dump for diag/topo, returns the length or 0 if size is short
+size_t topology_export(uint8_t *buffer, size_t size);
+
+#define TOPOLOGY_EXPORT_SIZE  (5 + 9 * TOPOLOGY_MAX_ROUTERS + 9 * TOPOLOGY_MAX_CHILDREN)
+
+#endif /* TOPOLOGY_H_ */
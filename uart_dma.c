@@ -0,0 +1,151 @@
+/***************************************************************************//**
+ * @file
+ * @brief DMA Transmit on the VCOM UART
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+/*
+ * Feeds the VCOM USART from memory with DMADRV, the same way display_flush.c
+ * feeds the memory LCD, so the results stream never waits on the UART. Only
+ * transmit is touched, the iostream driver keeps the USART set up.
+ */
+
+#include "base_station_config.h"
+
+#if RESULTS_STREAM_ENABLE
+
+#include <stddef.h>
+
+#include "em_device.h"
+#include "em_usart.h"
+#include "dmadrv.h"
+
+#include "sl_component_catalog.h"
+#ifdef SL_CATALOG_POWER_MANAGER_PRESENT
+#include "sl_power_manager.h"
+#endif
+
+#include "sl_iostream_usart_vcom_config.h"
+
+#include "uart_dma.h"
+
+#ifndef UART_DMA_SIGNAL
+#define UART_DMA_SIGNAL           dmadrvPeripheralSignal_USART0_TXBL
+#endif
+
+static  unsigned int            dma_channel;
+static  volatile bool           busy;
+static  volatile uint32_t       in_flight;
+static  uart_dma_done_t         done_callback;
+
+static bool dma_complete(unsigned int channel, unsigned int sequenceNo, void *userParam)
+{
+  (void)channel;
+  (void)sequenceNo;
+  (void)userParam;
+
+  // don't let the core sleep below EM1 before the last byte has left
+  while(!(SL_IOSTREAM_USART_VCOM_PERIPHERAL->STATUS & USART_STATUS_TXC));
+
+#ifdef SL_CATALOG_POWER_MANAGER_PRESENT
+  sl_power_manager_remove_em_requirement(SL_POWER_MANAGER_EM1);
+#endif
+
+  busy = false;
+
+  if(done_callback != NULL)
+  {
+      done_callback(in_flight);
+  }
+
+  return true;
+}
+
+sl_status_t uart_dma_init(uart_dma_done_t on_done)
+{
+  Ecode_t ecode;
+
+  done_callback = on_done;
+  busy          = false;
+
+  // the radio stack or the display may have brought DMADRV up already
+  ecode = DMADRV_Init();
+  if(ecode != ECODE_EMDRV_DMADRV_OK && ecode != ECODE_EMDRV_DMADRV_ALREADY_INITIALIZED)
+  {
+      return SL_STATUS_FAIL;
+  }
+
+  if(DMADRV_AllocateChannel(&dma_channel, NULL) != ECODE_EMDRV_DMADRV_OK)
+  {
+      return SL_STATUS_NO_MORE_RESOURCE;
+  }
+
+  return SL_STATUS_OK;
+}
+
+sl_status_t uart_dma_start(const uint8_t *data, uint32_t length)
+{
+  if(busy)
+  {
+      return SL_STATUS_BUSY;
+  }
+
+  busy      = true;
+  in_flight = length;
+
+#ifdef SL_CATALOG_POWER_MANAGER_PRESENT
+  // DMA and USART stop below EM1
+  sl_power_manager_add_em_requirement(SL_POWER_MANAGER_EM1);
+#endif
+
+  if(DMADRV_MemoryPeripheral(dma_channel, UART_DMA_SIGNAL,
+                             (void *)&SL_IOSTREAM_USART_VCOM_PERIPHERAL->TXDATA, (void *)data, true,
+                             length, dmadrvDataSize1,
+                             dma_complete, NULL) != ECODE_EMDRV_DMADRV_OK)
+  {
+#ifdef SL_CATALOG_POWER_MANAGER_PRESENT
+      sl_power_manager_remove_em_requirement(SL_POWER_MANAGER_EM1);
+#endif
+      busy = false;
+      return SL_STATUS_FAIL;
+  }
+
+  return SL_STATUS_OK;
+}
+
+bool uart_dma_busy(void)
+{
+  return busy;
+}
+
+#endif /* RESULTS_STREAM_ENABLE */
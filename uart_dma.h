@@ -0,0 +1,58 @@
+/***************************************************************************//**
+ * @file
+ * @brief DMA Transmit on the VCOM UART
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#ifndef UART_DMA_H_
+#define UART_DMA_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "sl_status.h"
+
+// called from interrupt context once length bytes of a transfer are out
+typedef void (*uart_dma_done_t)(uint32_t length);
+
+// init, the VCOM USART itself is brought up by the iostream driver
+sl_status_t uart_dma_init(uart_dma_done_t on_done);
+
+// start clocking data out, which has to stay put until the callback,
+// returns SL_STATUS_BUSY while the previous transfer is still in flight
+sl_status_t uart_dma_start(const uint8_t *data, uint32_t length);
+
+// true while a transfer is in flight
+bool uart_dma_busy(void);
+
+#endif /* UART_DMA_H_ */
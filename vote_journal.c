@@ -0,0 +1,350 @@
+/***************************************************************************//**
+ * @file
+ * @brief Persistent Vote Journal
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#include <string.h>
+
+#include "nvm3.h"
+#include "nvm3_default.h"
+
+#include "openthread-system.h"
+#include "sl_sleeptimer.h"
+
+#define LOG_MODULE  BASE_STATION
+#include "logging.h"
+
+#include "vote_journal.h"
+#include "tally.h"
+#include "coap_diag_codec.h"
+
+#define RING_MASK           (VOTE_JOURNAL_RAM_RECORDS - 1u)
+#define QUESTION_MARKER     '\0'    // answer of a new question record
+
+#if (VOTE_JOURNAL_RAM_RECORDS & RING_MASK) != 0
+#error "VOTE_JOURNAL_RAM_RECORDS must be a power of two"
+#endif
+
+#if VOTE_JOURNAL_RAM_RECORDS < VOTE_JOURNAL_BATCH_RECORDS
+#error "VOTE_JOURNAL_RAM_RECORDS must hold a whole batch"
+#endif
+
+typedef struct {
+  uint16_t  id;
+  char      answer;
+} journal_record_t;
+
+typedef struct {
+  uint32_t  sequence;
+  uint16_t  key;                    // offset from VOTE_JOURNAL_NVM3_KEY
+} batch_ref_t;
+
+static void flush_timer_handler(sl_sleeptimer_timer_handle_t *handle, void *data);
+static void push(uint16_t id, char answer);
+static sl_status_t commit_batch(void);
+static bool batch_valid(const uint8_t *batch, size_t length);
+static bool replay(const uint8_t *batch);
+
+static  journal_record_t              ring[VOTE_JOURNAL_RAM_RECORDS];
+static  uint32_t                      head;
+static  uint32_t                      tail;
+static  uint32_t                      sequence;
+static  bool                          flush_due;
+static  sl_sleeptimer_timer_handle_t  flush_timer;
+static  uint8_t                       object[VOTE_JOURNAL_HEADER_SIZE + VOTE_JOURNAL_BATCH_RECORDS * VOTE_JOURNAL_RECORD_SIZE];
+static  vote_journal_stats_t          stats;
+
+sl_status_t vote_journal_init(void)
+{
+  static batch_ref_t  batches[VOTE_JOURNAL_MAX_BATCHES];
+  uint32_t            count   = 0;
+  uint32_t            start   = sl_sleeptimer_get_tick_count();
+  bool                marker  = false;
+
+  head      = 0;
+  tail      = 0;
+  sequence  = 0;
+  memset(&stats, 0, sizeof(stats));
+
+  // collect the valid batches, insertion sorted by sequence number
+  for(uint16_t key = 0; key < VOTE_JOURNAL_MAX_BATCHES; key++)
+  {
+      size_t    length;
+      uint32_t  type;
+      uint32_t  batch_sequence;
+      uint32_t  i;
+
+      if(nvm3_getObjectInfo(nvm3_defaultHandle, VOTE_JOURNAL_NVM3_KEY + key, &type, &length) != ECODE_NVM3_OK)
+      {
+          continue;
+      }
+
+      if(type != NVM3_OBJECTTYPE_DATA || length < VOTE_JOURNAL_HEADER_SIZE || length > sizeof(object)
+         || nvm3_readData(nvm3_defaultHandle, VOTE_JOURNAL_NVM3_KEY + key, object, length) != ECODE_NVM3_OK
+         || !batch_valid(object, length))
+      {
+          stats.invalid_batches++;
+          continue;
+      }
+
+      memcpy(&batch_sequence, object, sizeof(batch_sequence));
+
+      for(i = count; i > 0 && batches[i - 1].sequence > batch_sequence; i--)
+      {
+          batches[i] = batches[i - 1];
+      }
+      batches[i].sequence = batch_sequence;
+      batches[i].key      = key;
+      count++;
+  }
+
+  // read again rather than keep every batch in RAM
+  for(uint32_t i = 0; i < count; i++)
+  {
+      if(nvm3_readData(nvm3_defaultHandle, VOTE_JOURNAL_NVM3_KEY + batches[i].key, object, sizeof(object)) == ECODE_NVM3_OK)
+      {
+          marker = replay(object) || marker;
+      }
+
+      sequence = batches[i].sequence + 1u;
+  }
+
+  stats.rebuild_ms = sl_sleeptimer_tick_to_ms(sl_sleeptimer_get_tick_count() - start);
+
+  // sequence numbers start at 0 on empty flash, a question whose marker is
+  // not in the ring and that doesn't reach back to 0 has lost its start
+  stats.truncated = count > 0 && batches[0].sequence != 0 && !marker;
+
+  if(stats.rebuilt_batches > 0 || stats.invalid_batches > 0)
+  {
+      LOG_INF("journal: %lu answers from %u batches in %lu ms, %u invalid\r\n",
+              (unsigned long)stats.rebuilt, stats.rebuilt_batches,
+              (unsigned long)stats.rebuild_ms, stats.invalid_batches);
+  }
+
+  if(stats.truncated)
+  {
+      LOG_WRN("journal: question longer than %u batches, oldest answers lost\r\n",
+              VOTE_JOURNAL_MAX_BATCHES);
+  }
+
+  return SL_STATUS_OK;
+}
+
+void vote_journal_append(uint16_t id, char answer)
+{
+  push(id, answer);
+}
+
+void vote_journal_new_question(void)
+{
+  push(REMOTE_ID_NONE, QUESTION_MARKER);
+}
+
+void vote_journal_process(void)
+{
+  uint32_t pending = head - tail;
+
+  if(pending >= VOTE_JOURNAL_BATCH_RECORDS || (pending > 0 && flush_due))
+  {
+      commit_batch();
+      return;
+  }
+
+  // nothing to write, let NVM3 tidy up while the loop is idle rather than in
+  // the middle of a burst
+  if(pending == 0 && nvm3_repackNeeded(nvm3_defaultHandle))
+  {
+      nvm3_repack(nvm3_defaultHandle);
+  }
+}
+
+void vote_journal_flush(void)
+{
+  while(head != tail && commit_batch() == SL_STATUS_OK)
+  {
+  }
+}
+
+const vote_journal_stats_t *vote_journal_get_stats(void)
+{
+  return &stats;
+}
+
+static void flush_timer_handler(sl_sleeptimer_timer_handle_t *handle, void *data)
+{
+  (void)handle;
+  (void)data;
+
+  flush_due = true;
+  otSysEventSignalPending();
+}
+
+static void push(uint16_t id, char answer)
+{
+  journal_record_t *record;
+
+  stats.appended++;
+
+  if(head - tail >= VOTE_JOURNAL_RAM_RECORDS)
+  {
+      stats.dropped++;
+      return;
+  }
+
+  // the first record of a batch bounds how long the batch may wait
+  if(head == tail)
+  {
+      flush_due = false;
+      sl_sleeptimer_start_timer_ms(&flush_timer, VOTE_JOURNAL_FLUSH_MS, flush_timer_handler, NULL, 0, 0);
+  }
+
+  record = &ring[head & RING_MASK];
+  record->id     = id;
+  record->answer = answer;
+  head++;
+
+  if(head - tail >= VOTE_JOURNAL_BATCH_RECORDS)
+  {
+      otSysEventSignalPending();
+  }
+}
+
+static sl_status_t commit_batch(void)
+{
+  uint32_t  count = head - tail;
+  uint8_t   *p    = object + VOTE_JOURNAL_HEADER_SIZE;
+  uint16_t  crc;
+  uint16_t  count16;
+  Ecode_t   ecode;
+
+  if(count > VOTE_JOURNAL_BATCH_RECORDS)
+  {
+      count = VOTE_JOURNAL_BATCH_RECORDS;
+  }
+
+  for(uint32_t i = 0; i < count; i++)
+  {
+      const journal_record_t *record = &ring[(tail + i) & RING_MASK];
+
+      memcpy(p, &record->id, sizeof(record->id));
+      p[2] = (uint8_t)record->answer;
+      p += VOTE_JOURNAL_RECORD_SIZE;
+  }
+
+  count16 = (uint16_t)count;
+  memcpy(object, &sequence, sizeof(sequence));
+  memcpy(object + 4, &count16, sizeof(count16));
+
+  crc = coap_diag_crc16(0xFFFFu, object, 6u);
+  crc = coap_diag_crc16(crc, object + VOTE_JOURNAL_HEADER_SIZE, (uint32_t)(p - object) - VOTE_JOURNAL_HEADER_SIZE);
+  memcpy(object + 6, &crc, sizeof(crc));
+
+  ecode = nvm3_writeData(nvm3_defaultHandle, VOTE_JOURNAL_NVM3_KEY + (sequence % VOTE_JOURNAL_MAX_BATCHES),
+                         object, (size_t)(p - object));
+  if(ecode != ECODE_NVM3_OK)
+  {
+      // keep the records, the next pass tries again
+      stats.write_errors++;
+      LOG_WRN("journal: write 0x%lx\r\n", (unsigned long)ecode);
+      return SL_STATUS_FAIL;
+  }
+
+  tail                += count;
+  sequence++;
+  stats.committed     += count;
+  stats.batches++;
+  stats.bytes_written += (uint32_t)(p - object);
+
+  if(head == tail)
+  {
+      flush_due = false;
+      sl_sleeptimer_stop_timer(&flush_timer);
+  }
+  else
+  {
+      // what is left is younger than the flush timeout
+      flush_due = false;
+      sl_sleeptimer_start_timer_ms(&flush_timer, VOTE_JOURNAL_FLUSH_MS, flush_timer_handler, NULL, 0, 0);
+  }
+
+  return SL_STATUS_OK;
+}
+
+static bool batch_valid(const uint8_t *batch, size_t length)
+{
+  uint16_t count;
+  uint16_t crc;
+
+  memcpy(&count, batch + 4, sizeof(count));
+  memcpy(&crc, batch + 6, sizeof(crc));
+
+  return count <= VOTE_JOURNAL_BATCH_RECORDS
+         && length == VOTE_JOURNAL_HEADER_SIZE + (size_t)count * VOTE_JOURNAL_RECORD_SIZE
+         && crc == coap_diag_crc16(coap_diag_crc16(0xFFFFu, batch, 6u), batch + VOTE_JOURNAL_HEADER_SIZE, (uint32_t)count * VOTE_JOURNAL_RECORD_SIZE);
+}
+
+// returns whether the batch starts a new question
+static bool replay(const uint8_t *batch)
+{
+  uint16_t        count;
+  bool            marker = false;
+  const uint8_t   *record = batch + VOTE_JOURNAL_HEADER_SIZE;
+
+  memcpy(&count, batch + 4, sizeof(count));
+
+  for(uint16_t i = 0; i < count; i++, record += VOTE_JOURNAL_RECORD_SIZE)
+  {
+      uint16_t id;
+
+      memcpy(&id, record, sizeof(id));
+
+      if((char)record[2] == QUESTION_MARKER)
+      {
+          tally_reset();
+          stats.rebuilt_question = 0;
+          marker = true;
+      }
+      else
+      {
+          tally_record(id, (char)record[2]);
+          stats.rebuilt_question++;
+      }
+  }
+
+  stats.rebuilt += count;
+  stats.rebuilt_batches++;
+
+  return marker;
+}
@@ -0,0 +1,96 @@
+/***************************************************************************//**
+ * @file
+ * @brief Persistent Vote Journal Header
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#ifndef VOTE_JOURNAL_H_
+#define VOTE_JOURNAL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "sl_status.h"
+#include "base_station_config.h"
+#include "tally.h"
+
+/*
+ * Append-only journal of the counted answers in NVM3, so that a reset in the
+ * middle of a question doesn't lose the tally. Answers are buffered in RAM by
+ * the answer handler and written out from the main loop in batches of
+ * VOTE_JOURNAL_BATCH_RECORDS, one NVM3 object each, or after
+ * VOTE_JOURNAL_FLUSH_MS when fewer arrive. Every batch carries a sequence
+ * number and a CRC. Batches go round VOTE_JOURNAL_MAX_BATCHES keys starting
+ * at VOTE_JOURNAL_NVM3_KEY, so a question keeps at most
+ * VOTE_JOURNAL_MAX_BATCHES * VOTE_JOURNAL_BATCH_RECORDS answers. At boot the
+ * valid batches are replayed into the tally in sequence order. Records carry
+ * the remote id, which remote_registry.c keeps stable across resets.
+ */
+
+#define VOTE_JOURNAL_HEADER_SIZE    8u      // sequence, count, crc
+#define VOTE_JOURNAL_RECORD_SIZE    3u      // remote id, answer
+#define VOTE_JOURNAL_BATCH_RECORDS  ((VOTE_JOURNAL_OBJECT_SIZE - VOTE_JOURNAL_HEADER_SIZE) / VOTE_JOURNAL_RECORD_SIZE)
+
+typedef struct {
+  uint32_t  appended;         // answers handed to the journal
+  uint32_t  committed;        // answers written to flash
+  uint32_t  dropped;          // RAM buffer full, counted but not persisted
+  uint32_t  batches;
+  uint32_t  bytes_written;    // object payload bytes handed to NVM3
+  uint32_t  write_errors;
+  uint32_t  rebuilt;          // records replayed at boot
+  uint32_t  rebuilt_question; // answers replayed after the last question marker
+  uint16_t  rebuilt_batches;
+  uint16_t  invalid_batches;  // bad crc or length, skipped
+  bool      truncated;        // the question outgrew the keys, its oldest answers are gone
+  uint32_t  rebuild_ms;
+} vote_journal_stats_t;
+
+// replays the journal into the tally, call after tally_reset
+sl_status_t vote_journal_init(void);
+
+// buffer an answer that was counted, never touches flash
+void vote_journal_append(uint16_t id, char answer);
+
+// a new question starts, the replay resets the tally here
+void vote_journal_new_question(void);
+
+// called from the main loop, writes at most one batch per call
+void vote_journal_process(void);
+
+// write out whatever is buffered now
+void vote_journal_flush(void);
+
+const vote_journal_stats_t *vote_journal_get_stats(void);
+
+#endif /* VOTE_JOURNAL_H_ */